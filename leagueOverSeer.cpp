@@ -17,17 +17,65 @@ League Overseer
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+// BZFlag's configure script tells us whether libcurl was found
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <iomanip>
 #include <json/json.h>
+#include <limits>
+#include <list>
+#include <map>
 #include <math.h>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <cstring>
+#include <stdint.h>
+#include <system_error>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
+
+#ifdef HAVE_LIBCURL
+#include <curl/curl.h>
+#endif
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
 
 #include "bzfsAPI.h"
 #include "plugin_utils.h"
@@ -45,6 +93,9 @@ const double FM_MIN_RATIO = 2.0/7.0;
 const double OFFI_MIN_TIME = 300.0;
 const double IDLE_FORGIVENESS = 0.9;
 
+// The number of player slots bzfs can hand out
+const int MAX_PLAYER_SLOTS = 256;
+
 // Log failed assertions at debug level 0 since this will work for non-member functions and it is important enough.
 #define ASSERT(x) { if (!(x)) { bz_debugMessagef(0, "ERROR :: League Overseer :: Failed assertion '%s' at %s:%d", #x, __FILE__, __LINE__); }}
 
@@ -102,34 +153,39 @@ static std::string intToString (int number)
     return string.str();
 }
 
-// Return whether or not a specified player ID exists or not
-static bool isValidPlayerID (int playerID)
+// Return whether or not a team is one that players can play a match on
+static bool isPlayingTeam (bz_eTeamType team)
 {
-    // Use another smart pointer so we don't forget about freeing up memory
-    std::unique_ptr<bz_BasePlayerRecord> playerData(bz_getPlayerByIndex(playerID));
-
-    // If the pointer doesn't exist, that means the playerID does not exist
-    return (playerData) ? true : false;
+    return (team >= eRogueTeam && team <= ePurpleTeam);
 }
 
-// Split a string by a delimeter and return a vector of elements
-static std::vector<std::string> split (const char *str, char c = ' ')
+// Get the team a team flag belongs to from its abbreviation (e.g. "R*"); eNoTeam for any other flag
+static bz_eTeamType getFlagTeam (const char *flagType)
 {
-    std::vector<std::string> result;
+    if (flagType == NULL || flagType[0] == '\0' || flagType[1] != '*')
+    {
+        return eNoTeam;
+    }
 
-    do
+    switch (flagType[0])
     {
-        const char *begin = str;
+        case 'R': return eRedTeam;
+        case 'G': return eGreenTeam;
+        case 'B': return eBlueTeam;
+        case 'P': return ePurpleTeam;
 
-        while(*str != c && *str)
-        {
-            str++;
-        }
+        default: return eNoTeam;
+    }
+}
 
-        result.push_back(std::string(begin, str));
-    } while (0 != *str++);
+// Return whether or not a specified player ID exists or not
+static bool isValidPlayerID (int playerID)
+{
+    // Use another smart pointer so we don't forget about freeing up memory
+    std::unique_ptr<bz_BasePlayerRecord> playerData(bz_getPlayerByIndex(playerID));
 
-    return result;
+    // If the pointer doesn't exist, that means the playerID does not exist
+    return (playerData) ? true : false;
 }
 
 // Convert a string representation of a boolean to a boolean
@@ -138,1118 +194,7031 @@ static bool toBool (std::string str)
     return !str.empty() && (strcasecmp(str.c_str (), "true") == 0 || atoi(str.c_str ()) != 0);
 }
 
-class LeagueOverseer : public bz_Plugin, public bz_CustomSlashCommandHandler, public bz_BaseURLHandler
+// BZIDs are numeric, which lets us store them as integers instead of strings
+static bool parseBZID (const std::string &bzID, uint32_t &value)
 {
-public:
-    virtual const char* Name ()
-    {
-        static std::string pluginBuild = "";
+    char *end = NULL;
 
-        if (!pluginBuild.size())
-        {
-            std::ostringstream pluginBuildStream;
+    if (bzID.empty() || !isdigit(bzID[0]))
+    {
+        return false;
+    }
 
-            pluginBuildStream << "League Overseer " << MAJOR << "." << MINOR << "." << REV << " (" << BUILD << ")";
-            pluginBuild = pluginBuildStream.str();
-        }
+    unsigned long parsed = strtoul(bzID.c_str(), &end, 10);
 
-        return pluginBuild.c_str();
+    if (*end != '\0' || parsed > UINT32_MAX)
+    {
+        return false;
     }
-    virtual void Init (const char* config);
-    virtual void Event (bz_EventData *eventData);
-    virtual void Cleanup (void);
 
-    virtual bool SlashCommand (int playerID, bz_ApiString, bz_ApiString, bz_APIStringList*);
+    value = (uint32_t)parsed;
+    return true;
+}
 
-    virtual void URLDone (const char* URL, const void* data, unsigned int size, bool complete);
-    virtual void URLTimeout (const char* URL, int errorCode);
-    virtual void URLError (const char* URL, int errorCode, const char *errorString);
+// bzfs sends a motto in a fixed field of 128 bytes, terminator included
+static const size_t MOTTO_LENGTH = 127;
 
-    // We will be storing information about the players who participated in a match so we will
-    // be storing that information inside a struct
-    struct MatchParticipant
+// Turn a team name into a motto bzfs can send: control characters are dropped and a name that's too long is cut
+// short without splitting a UTF-8 character
+static std::string encodeMotto (const std::string &teamName)
+{
+    std::string motto;
+    motto.reserve(std::min(teamName.size(), MOTTO_LENGTH));
+
+    for (size_t i = 0; i < teamName.size();)
     {
-        // Basic player info
-        int slotID;
-        std::string bzID;
-        std::string callsign;
-        std::string ipAddress;
+        unsigned char c = teamName[i];
 
-        std::string teamName;
-        bz_eTeamType teamColor;
+        if (c < 0x20 || c == 0x7F)
+        {
+            i++;
+            continue;
+        }
 
-        bool hasSpawned; // Set to true if the player has ever spawned in the match
+        size_t length = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+        length = std::min(length, teamName.size() - i);
 
-        double startTime;     // The time the player started playing their last session
-        double lastDeathTime; // The time the player last died
-        double totalPlayTime; // The total amount of time a player has played in a match in seconds
-        double totalIdleTime; // An estimated amount of idle time a player has had during the match
+        if (motto.size() + length > MOTTO_LENGTH)
+        {
+            break;
+        }
 
-        // The amount of seconds a player has played on each respective team
-        std::map<bz_eTeamType, double> playTimeByTeam;
+        motto.append(teamName, i, length);
+        i += length;
+    }
 
-        MatchParticipant() :
-            slotID(-1),
-            startTime(-1),
-            hasSpawned(false),
-            totalIdleTime(0),
-            totalPlayTime(0)
-        {}
+    return motto;
+}
 
-        MatchParticipant(bz_BasePlayerRecord *pr)
-        {
-            MatchParticipant();
+// Write a file by writing to a temporary file first and renaming it over the destination so
+// anything reading the file will either see the old contents or the new contents, never half
+static bool writeFileAtomically (const std::string &path, const std::string &contents)
+{
+    std::string tempPath = path + ".tmp";
 
-            slotID    = pr->playerID;
-            bzID      = pr->bzID;
-            callsign  = pr->callsign;
-            ipAddress = pr->ipAddress;
-            teamColor = pr->team;
-        }
+    {
+        std::ofstream outfile(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
 
-        double estimatedPlayTime ()
+        if (!outfile)
         {
-            return (totalPlayTime - (totalIdleTime * IDLE_FORGIVENESS));
+            return false;
         }
 
-        bz_eTeamType getLoyalty (bz_eTeamType team1, bz_eTeamType team2)
-        {
-            if (playTimeByTeam[team1] >= playTimeByTeam[team2])
-            {
-                return team1;
-            }
-
-            return team2;
-        }
+        outfile.write(contents.data(), contents.size());
+        outfile.close();
 
-        bool isEligible (bool isOfficial, double matchDuration)
+        if (outfile.fail())
         {
-            return (
-                (isOfficial  && estimatedPlayTime() >= OFFI_MIN_TIME) ||  // It's an official match and they played at least the minimum time
-                (!isOfficial && estimatedPlayTime() >= (matchDuration * FM_MIN_RATIO))  // It's a fun match and they played at least the minimum time
-            );
+            std::remove(tempPath.c_str());
+            return false;
         }
+    }
 
-        void updatePlayingTime (bz_eTeamType team)
-        {
-            if (!hasSpawned)
-            {
-                return;
-            }
+#ifdef _WIN32
+    // Windows refuses to rename over an existing file
+    std::remove(path.c_str());
+#endif
 
-            double sessionPlaytime = bz_getCurrentTime() - startTime;
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
 
-            totalPlayTime += sessionPlaytime;
-            playTimeByTeam[team] += sessionPlaytime;
-            startTime = -1;
-        }
-    };
+    return true;
+}
 
-    // Simply out of preference, we will be storing all the information regarding a match inside
-    // of a struct where the struct will be NULL if it is current a fun match
-    struct CurrentMatch
+// Append fixed size values and length prefixed strings to a buffer for our binary files. Values are
+// written in the host's byte order since the files never leave the machine that wrote them.
+class BinaryWriter
+{
+public:
+    template<typename T>
+    void write (const T &value)
     {
-        bool        playersRecorded,    // Whether or not the players participating in the match have been recorded or not
-                    isOfficialMatch,    // Whether or not the match is official; when set to false it'll be a fun match
-                    canceled;           // Whether or not the official match was canceled
+        buffer.append((const char*)&value, sizeof(T));
+    }
 
-        std::string cancelationReason,  // If the match was canceled, store the reason as to why it was canceled
-                    teamOneName,        // We'll be doing our best to store the team names of who's playing so store the names for
-                    teamTwoName;        //     each team respectively. This will be blank if it's a fun match
+    void writeString (const std::string &value)
+    {
+        uint16_t length = (uint16_t)std::min(value.size(), (size_t)UINT16_MAX);
 
-        double      duration,           // The length of the match in seconds. Used when reporting a match to the server
-                    matchRollCall;      // The amount of seconds that need to pass in a match before the first roll call
+        write(length);
+        buffer.append(value.data(), length);
+    }
 
-        // We keep the number of points scored in the case where all the members of a team leave and their team
-        // score get reset to 0
-        int         teamOnePoints,
-                    teamTwoPoints;
+    std::string buffer;
+};
 
-        time_t      matchStart,         // The timestamp of when a match was started in order to calculate the timer
-                    matchPaused;        // If the match is paused, it will be stored here in order to update matchStart appropriately for the timer
+// Read back what a BinaryWriter wrote. Every read is bounds checked; once a read fails, the reader
+// stays failed so a truncated or corrupted file can be detected with a single check at the end
+class BinaryReader
+{
+public:
+    BinaryReader (const std::string &_buffer) :
+        buffer(_buffer),
+        position(0),
+        failed(false)
+    {}
+
+    template<typename T>
+    T read ()
+    {
+        T value = T();
 
-        std::map<std::string, MatchParticipant> matchRoster;
+        if (failed || position + sizeof(T) > buffer.size())
+        {
+            failed = true;
+            return value;
+        }
 
-        // Set the default values for this struct
-        CurrentMatch () :
-            playersRecorded(false),
-            isOfficialMatch(true),
-            canceled(false),
-            cancelationReason(""),
-            teamOneName("Team-A"),
-            teamTwoName("Team-B"),
-            duration(-1.0f),
-            matchRollCall(90.0),
-            teamOnePoints(0),
-            teamTwoPoints(0),
-            matchStart(time(NULL)),
-            matchPaused(time(NULL)),
-            matchRoster()
-        {}
-    };
+        memcpy(&value, buffer.data() + position, sizeof(T));
+        position += sizeof(T);
 
-    virtual void buildPlayerStrings (bz_eTeamType team, std::string &bzidString, std::string &ipString);
-    virtual bz_ApiString buildReplayName (bz_Time &standardTime);
-    virtual int getMatchProgress ();
-    virtual std::string getMatchTime ();
-    virtual void loadConfig (const char *cmdLine);
-    virtual void requestTeamName (bz_eTeamType team);
-    virtual void requestTeamName (std::string callsign, std::string bzID);
-    virtual void updateTeamNames (void);
+        return value;
+    }
 
-    // All the variables that will be used in the plugin
-    bool         ROTATION_LEAGUE,  // Whether or not we are watching a league that uses different maps
-                 MATCH_INFO_SENT,  // Whether or not the information returned by a URL job pertains to a match report
-                 DISABLE_REPORT,   // Whether or not to disable automatic match reports if a server is not used as an official match server
-                 DISABLE_MOTTO,    // Whether or not to set a player's motto to their team name
-                 RECORDING;        // Whether or not we are recording a match
+    std::string readString ()
+    {
+        uint16_t length = read<uint16_t>();
 
-    int          DEBUG_LEVEL,      // The DEBUG level the server owner wants the plugin to use for its messages
-                 VERBOSE_LEVEL;    // This is the spamming/ridiculous level of debug that the plugin uses
+        if (failed || position + length > buffer.size())
+        {
+            failed = true;
+            return "";
+        }
 
-    std::string  MATCH_REPORT_URL, // The URL the plugin will use to report matches. This should be the URL the PHP counterpart of this plugin
-                 TEAM_NAME_URL,
-                 MAP_NAME,         // The name of the map that is currently be played if it's a rotation league (i.e. OpenLeague uses multiple maps)
-                 MAPCHANGE_PATH;   // The path to the file that contains the name of current map being played
+        std::string value = buffer.substr(position, length);
+        position += length;
 
-    bz_eTeamType TEAM_ONE,         // Because we're serving more than just GU league, we need to support different colors therefore, call the teams
-                 TEAM_TWO;         //     ONE and TWO
+        return value;
+    }
 
-    // This is the only pointer of the struct for the official match that we will be using. If this
-    // variable is set to NULL, that means that there is currently no official match occurring.
-    std::unique_ptr<CurrentMatch> currentMatch;
+    bool good () const
+    {
+        return !failed;
+    }
 
-    // We will be using a map to handle the team name mottos in the format of
-    // <BZID, Team Name>
-    std::map<std::string, std::string> teamMottos;
+private:
+    const std::string &buffer;
+    size_t position;
+    bool failed;
 };
 
-BZ_PLUGIN(LeagueOverseer)
-
-void LeagueOverseer::Init (const char* commandLine)
+// Append to the end of a file, creating it if it doesn't exist
+static bool appendFile (const std::string &path, const std::string &contents)
 {
-    // Register our events with Register()
-    Register(bz_eGameEndEvent);
-    Register(bz_eGameResumeEvent);
-    Register(bz_eGameStartEvent);
-    Register(bz_eGetAutoTeamEvent);
-    Register(bz_eGetPlayerMotto);
-    Register(bz_ePlayerDieEvent);
-    Register(bz_ePlayerJoinEvent);
-    Register(bz_ePlayerPartEvent);
-    Register(bz_ePlayerSpawnEvent);
-    Register(bz_eTeamScoreChanged);
-    Register(bz_eTickEvent);
+    FILE *outfile = fopen(path.c_str(), "ab");
 
-    // Register our custom slash commands
-    bz_registerCustomSlashCommand("cancel", this);
-    bz_registerCustomSlashCommand("finish", this);
-    bz_registerCustomSlashCommand("fm", this);
-    bz_registerCustomSlashCommand("offi", this);
-    bz_registerCustomSlashCommand("official", this);
-    bz_registerCustomSlashCommand("spawn", this);
-    bz_registerCustomSlashCommand("pause", this);
-    bz_registerCustomSlashCommand("resume", this);
+    if (!outfile)
+    {
+        return false;
+    }
 
-    bz_registerCustomSlashCommand("gameover", this);
-    bz_registerCustomSlashCommand("countdown", this);
+    bool written = fwrite(contents.data(), 1, contents.size(), outfile) == contents.size();
 
-    // Set some default values
-    currentMatch = NULL;
+    return (fclose(outfile) == 0) && written;
+}
 
-    // Load the configuration data when the plugin is loaded
-    loadConfig(commandLine);
+// Get the size and the 64-bit FNV-1a hash of the contents of a file. Returns false if the file could not be read
+static bool hashFile (const std::string &path, uint64_t &size, uint64_t &hash)
+{
+    FILE *infile = fopen(path.c_str(), "rb");
 
-    // Check to see if the plugin is for a rotational league
-    if (MAPCHANGE_PATH != "" && ROTATION_LEAGUE)
+    if (!infile)
     {
-        // Open the mapchange.out file to see what map is being used
-        std::ifstream infile;
-        infile.open(MAPCHANGE_PATH.c_str());
-        getline(infile, MAP_NAME);
-        infile.close();
-
-        bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Current map being played: %s", MAP_NAME.c_str());
+        return false;
     }
 
-    // Assign our two team colors to eNoTeam simply so we have something to check for
-    // when we are trying to find the two colors the map is using
-    TEAM_ONE = eNoTeam;
-    TEAM_TWO = eNoTeam;
+    char buffer[65536];
+    size_t count;
 
-    // Loop through all the team colors
-    for (bz_eTeamType t = eRedTeam; t <= ePurpleTeam; t = (bz_eTeamType) (t + 1))
+    size = 0;
+    hash = 14695981039346656037ULL;
+
+    while ((count = fread(buffer, 1, sizeof(buffer), infile)) > 0)
     {
-        // If the current team's player limit is more than 0, that means that we found a
-        // team color that the map is using
-        if (bz_getTeamPlayerLimit(t) > 0)
+        for (size_t i = 0; i < count; i++)
         {
-            // If team one is eNoTeam, then that means this is just the first team with player limit
-            // that we have found. If it's not eNoTeam, that means we've found the second team
-            if (TEAM_ONE == eNoTeam)
-            {
-                TEAM_ONE = t;
-            }
-            else if (TEAM_TWO == eNoTeam)
-            {
-                TEAM_TWO = t;
-                break; // After we've found the second team, there's no need to continue so break out of here
-            }
+            hash ^= (uint8_t)buffer[i];
+            hash *= 1099511628211ULL;
         }
-    }
 
-    // Make sure both teams were found, if they weren't then notify in the logs
-    ASSERT(TEAM_ONE != eNoTeam && TEAM_TWO != eNoTeam);
+        size += count;
+    }
 
-    updateTeamNames();
+    bool failed = ferror(infile) != 0;
+    fclose(infile);
 
-    if (bz_getTimeLimit() == 0.0)
-    {
-        bz_debugMessage(DEBUG_LEVEL, "WARNING :: League Overseer :: No time limit is specified with '-time'. Default value used: 1800 seconds.");
-        bz_setTimeLimit(1800);
-    }
+    return !failed;
 }
 
-void LeagueOverseer::Cleanup (void)
+// Join a directory and a file name, whether or not the directory ends with a slash
+static std::string joinPath (const std::string &directory, const std::string &fileName)
 {
-    Flush(); // Clean up all the events
+    return (directory.empty() || directory[directory.size() - 1] == '/') ? directory + fileName : directory + "/" + fileName;
+}
 
-    // Clean up our custom slash commands
-    bz_removeCustomSlashCommand("cancel");
-    bz_removeCustomSlashCommand("finish");
-    bz_removeCustomSlashCommand("fm");
-    bz_removeCustomSlashCommand("offi");
-    bz_removeCustomSlashCommand("official");
-    bz_removeCustomSlashCommand("spawn");
-    bz_removeCustomSlashCommand("pause");
-    bz_removeCustomSlashCommand("resume");
+// Read an entire file into a string. Returns false if the file could not be opened
+static bool readFile (const std::string &path, std::string &contents)
+{
+    std::ifstream infile(path.c_str(), std::ios::in | std::ios::binary);
 
-    bz_removeCustomSlashCommand("gameover");
-    bz_removeCustomSlashCommand("countdown");
+    if (!infile)
+    {
+        return false;
+    }
+
+    std::ostringstream stream;
+    stream << infile.rdbuf();
+    contents = stream.str();
+
+    return true;
 }
 
-void LeagueOverseer::Event (bz_EventData *eventData)
+// Get the last modification time of a file, or 0 if it doesn't exist
+static time_t getModificationTime (const std::string &path)
 {
-    switch (eventData->eventType)
+    struct stat fileInfo;
+
+    if (stat(path.c_str(), &fileInfo) != 0)
     {
-        case bz_eGameEndEvent: // This event is called each time a game ends
-        {
-            bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: A match has ended.");
+        return 0;
+    }
 
-            // Get the current standard UTC time
-            bz_Time standardTime;
-            bz_getUTCtime(&standardTime);
+    return fileInfo.st_mtime;
+}
 
-            std::unique_ptr<bz_APIIntList> playerList(bz_getPlayerIndexList());
+// Watch a single file for changes without ever blocking. On Linux, inotify watches the directory the
+// file lives in so that files replaced with a rename are noticed too; everywhere else we fall back to
+// comparing the file's modification time at most once a second.
+class FileWatcher
+{
+public:
+    FileWatcher () :
+        inotifyFD(-1),
+        lastModified(0),
+        lastChecked(0)
+    {}
 
-            for (unsigned int i = 0; i < playerList->size(); i++)
-            {
-                std::unique_ptr<bz_BasePlayerRecord> playerRecord(bz_getPlayerByIndex(playerList->get(i)));
+    ~FileWatcher ()
+    {
+        stop();
+    }
 
-                if (playerRecord && bz_getPlayerTeam(playerList->get(i)) != eObservers) // If player is not an observer
-                {
-                    std::string bzid = playerRecord->bzID;
+    void watch (const std::string &_path)
+    {
+        stop();
 
-                    MatchParticipant &player = currentMatch->matchRoster[bzid];
+        path = _path;
+        lastModified = getModificationTime(path);
 
-                    player.updatePlayingTime(playerRecord->team);
-                }
-            }
+        if (path.empty())
+        {
+            return;
+        }
 
-            std::string recordingFileName = buildReplayName(standardTime);
+#ifdef __linux__
+        size_t separator = path.find_last_of('/');
+        std::string directory = (separator == std::string::npos) ? "." : path.substr(0, std::max((size_t)1, separator));
 
-            // Only save the recording buffer if we actually started recording when the match started
-            if (RECORDING)
-            {
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Recording was in progress during the match.");
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Replay file will be named: %s", recordingFileName.c_str());
+        fileName = (separator == std::string::npos) ? path : path.substr(separator + 1);
+        inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
 
-                // Save the recording buffer and stop recording
-                bz_saveRecBuf(recordingFileName.c_str(), 0);
-                bz_stopRecBuf();
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Replay file has been saved and recording has stopped.");
+        if (inotifyFD >= 0 && inotify_add_watch(inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+        {
+            ::close(inotifyFD);
+            inotifyFD = -1;
+        }
+#endif
+    }
 
-                // We're no longer recording, so set the boolean and announce to players that the file has been saved
-                RECORDING = false;
-                bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Match saved as: %s", recordingFileName.c_str());
-            }
+    void stop ()
+    {
+#ifdef __linux__
+        if (inotifyFD >= 0)
+        {
+            ::close(inotifyFD);
+        }
+#endif
 
-            if (!DISABLE_REPORT)
-            {
-                if (currentMatch->canceled)
-                {
-                    // The match was canceled for some reason so output the reason to both the players and the server logs
+        inotifyFD = -1;
+        path.clear();
+    }
 
-                    bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: %s", currentMatch->cancelationReason.c_str());
-                    bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, currentMatch->cancelationReason.c_str());
-                }
-                else if (currentMatch->matchRoster.empty())
-                {
-                    // Oops... I darn goofed. Somehow the players were not recorded properly
+    bool isWatching () const
+    {
+        return !path.empty();
+    }
 
-                    bz_debugMessage(DEBUG_LEVEL, "DEBUG :: League Overseer :: No recorded players for this official match.");
-                    bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "Current match could not be reported due to not having a list of valid match participants.");
-                }
-                else
+    // Whether the file has changed since the last time this was called
+    bool changed ()
+    {
+        if (path.empty())
+        {
+            return false;
+        }
+
+#ifdef __linux__
+        if (inotifyFD >= 0)
+        {
+            bool fileChanged = false;
+            char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+            ssize_t length;
+
+            while ((length = read(inotifyFD, buffer, sizeof(buffer))) > 0)
+            {
+                for (char *ptr = buffer; ptr < buffer + length; )
                 {
-                    // This is a completed match (official or fm), so let's report it
+                    const struct inotify_event *event = (const struct inotify_event*)ptr;
 
-                    // Format the date to -> year-month-day hour:minute:second
-                    char matchDate[20];
-                    sprintf(matchDate, "%02d-%02d-%02d %02d:%02d:%02d", standardTime.year, standardTime.month, standardTime.day, standardTime.hour, standardTime.minute, standardTime.second);
-
-                    // Keep references to values for quick reference
-                    std::string teamOnePointsFinal = intToString(currentMatch->teamOnePoints);
-                    std::string teamTwoPointsFinal = intToString(currentMatch->teamTwoPoints);
-                    std::string matchDuration      = intToString(currentMatch->duration/60);
-                    std::string matchType          = (currentMatch->isOfficialMatch) ? "official" : "fm";
-
-                    // Store match data in the logs
-                    bz_debugMessagef(0, "Match Data :: League Overseer Match Report");
-                    bz_debugMessagef(0, "Match Data :: -----------------------------");
-                    bz_debugMessagef(0, "Match Data :: Match Time      : %s", matchDate);
-                    bz_debugMessagef(0, "Match Data :: Duration        : %s", matchDuration.c_str());
-                    bz_debugMessagef(0, "Match Data :: %s  Score  : %s", formatTeam(TEAM_ONE, true).c_str(), teamOnePointsFinal.c_str());
-                    bz_debugMessagef(0, "Match Data :: %s  Score  : %s", formatTeam(TEAM_TWO, true).c_str(), teamTwoPointsFinal.c_str());
-
-                    // Start building POST data to be sent to the league website
-                    std::string matchToSend = "query=reportMatch";
-                                matchToSend += "&apiVersion="   + std::string(bz_urlEncode(intToString(API_VERSION).c_str()));
-                                matchToSend += "&matchType="    + std::string(bz_urlEncode(matchType.c_str()));
-                                matchToSend += "&teamOneColor=" + std::string(bz_urlEncode(formatTeam(TEAM_ONE).c_str()));
-                                matchToSend += "&teamTwoColor=" + std::string(bz_urlEncode(formatTeam(TEAM_TWO).c_str()));
-                                matchToSend += "&teamOneWins="  + std::string(bz_urlEncode(teamOnePointsFinal.c_str()));
-                                matchToSend += "&teamTwoWins="  + std::string(bz_urlEncode(teamTwoPointsFinal.c_str()));
-                                matchToSend += "&duration="     + std::string(bz_urlEncode(matchDuration.c_str()));
-                                matchToSend += "&matchTime="    + std::string(bz_urlEncode(matchDate));
-                                matchToSend += "&server="       + std::string(bz_urlEncode(bz_getPublicAddr().c_str()));
-                                matchToSend += "&port="         + std::string(bz_urlEncode(intToString(bz_getPublicPort()).c_str()));
-                                matchToSend += "&replayFile="   + std::string(bz_urlEncode(recordingFileName.c_str()));
-
-                    // Only add this parameter if it's a rotational league such as Leagues United
-                    if (ROTATION_LEAGUE)
+                    if (event->len > 0 && fileName == event->name)
                     {
-                        matchToSend += "&mapPlayed=" + std::string(bz_urlEncode(MAP_NAME.c_str()));
+                        fileChanged = true;
                     }
 
-                    std::string teamOneBZIDs, teamOneIPs,
-                                teamTwoBZIDs, teamTwoIPs;
-
-                    buildPlayerStrings(TEAM_ONE, teamOneBZIDs, teamOneIPs);
-                    buildPlayerStrings(TEAM_TWO, teamTwoBZIDs, teamTwoIPs);
+                    ptr += sizeof(struct inotify_event) + event->len;
+                }
+            }
 
-                    // Build a string of BZIDs and also output the BZIDs to the server logs while we're at it
-                    matchToSend += "&teamOnePlayers=" + teamOneBZIDs;
-                    matchToSend += "&teamTwoPlayers=" + teamTwoBZIDs;
+            return fileChanged;
+        }
+#endif
 
-                    // Send the IPs that players used during the match
-                    matchToSend += "&teamOneIPs=" + teamOneIPs;
-                    matchToSend += "&teamTwoIPs=" + teamTwoIPs;
+        time_t now = time(NULL);
 
-                    // Finish prettifying the server logs
-                    bz_debugMessagef(0, "Match Data :: -----------------------------");
-                    bz_debugMessagef(0, "Match Data :: End of Match Report");
-                    bz_debugMessagef(0, "DEBUG :: League Overseer :: Reporting match data...");
-                    bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "Reporting match...");
+        if (now == lastChecked)
+        {
+            return false;
+        }
 
-                    // Send the match data to the league website
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Post data submitted: %s", matchToSend.c_str());
-                    bz_addURLJob(MATCH_REPORT_URL.c_str(), this, matchToSend.c_str());
-                    MATCH_INFO_SENT = true;
-                }
-            }
+        lastChecked = now;
+        time_t modified = getModificationTime(path);
 
-            // We're done with the struct, so make it NULL until the next match
-            currentMatch = NULL;
+        if (modified != lastModified)
+        {
+            lastModified = modified;
+            return true;
         }
-        break;
 
-        case bz_eGameResumeEvent:
-        {
-            // We've resumed an official match, so we need to properly edit the start time so we can calculate the roll call
-            time_t now = time(NULL);
-            double timePaused = difftime(now, currentMatch->matchPaused);
+        return false;
+    }
 
-            struct tm modMatchStart = *localtime(&currentMatch->matchStart);
-            modMatchStart.tm_sec += timePaused;
+private:
+    std::string path, fileName;
+    int         inotifyFD;
+    time_t      lastModified, lastChecked;
+};
 
-            currentMatch->matchStart = mktime(&modMatchStart);
-            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match paused for %.f seconds. Match continuing at %s.", timePaused, getMatchTime().c_str());
+// A fixed-size lock-free queue with exactly one thread pushing and exactly one thread popping
+template <typename T, size_t Capacity>
+class SPSCQueue
+{
+public:
+    SPSCQueue () :
+        head(0),
+        tail(0)
+    {}
 
-            // Go through our roster and offset their playing time to behave like there was never a game pause
-            for (auto &kv : currentMatch->matchRoster)
-            {
-                if (kv.second.startTime >= 0)
-                {
-                    kv.second.startTime += timePaused;
-                }
-            }
-        }
-        break;
+    // Producer only. The item is only moved from if there was room for it
+    bool push (T &item)
+    {
+        size_t tailIndex = tail.load(std::memory_order_relaxed);
 
-        case bz_eGameStartEvent: // This event is triggered when a timed game begins
+        if (tailIndex - head.load(std::memory_order_acquire) == Capacity)
         {
-            bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: A match has started");
+            return false;
+        }
 
-            // We started recording a match, so save the status
-            RECORDING = bz_startRecBuf();
+        items[tailIndex % Capacity] = std::move(item);
+        tail.store(tailIndex + 1, std::memory_order_release);
 
-            // We want to notify the logs if we couldn't start recording just in case an issue were to occur and the server
-            // owner needs to check to see if players were lying about there no replay
-            if (RECORDING)
-            {
-                bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match recording has started successfully");
-            }
-            else
-            {
-                bz_debugMessage(0, "ERROR :: League Overseer :: This match could not be recorded");
-            }
+        return true;
+    }
 
-            // Reset scores in case Caps happened during countdown delay.
-            currentMatch->teamOnePoints = currentMatch->teamTwoPoints = 0;
-            currentMatch->matchStart = time(NULL);
-            currentMatch->duration = bz_getTimeLimit();
+    // Consumer only
+    bool pop (T &item)
+    {
+        size_t headIndex = head.load(std::memory_order_relaxed);
 
-            // Take an initial roll call of the players
-            std::unique_ptr<bz_APIIntList> playerList(bz_getPlayerIndexList());
+        if (headIndex == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
 
-            // We can't do a roll call if the player list wasn't created
-            if (!playerList)
-            {
-                bz_debugMessagef(VERBOSE_LEVEL, "ERROR :: League Overseer :: Failure to create player list for roll call.");
-                return;
-            }
+        item = std::move(items[headIndex % Capacity]);
+        items[headIndex % Capacity] = T();
+        head.store(headIndex + 1, std::memory_order_release);
 
-            for (unsigned int i = 0; i < playerList->size(); i++)
-            {
-                std::unique_ptr<bz_BasePlayerRecord> playerRecord(bz_getPlayerByIndex(playerList->get(i)));
+        return true;
+    }
 
-                if (playerRecord && bz_getPlayerTeam(playerList->get(i)) != eObservers) // If player is not an observer
-                {
-                    std::string bzid = playerRecord->bzID;
+    bool empty () const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
 
-                    MatchParticipant currentPlayer(playerRecord.get());
+private:
+    T items[Capacity];
+    std::atomic<size_t> head, tail;
+};
 
-                    currentPlayer.teamName = teamMottos[bzid];
-                    currentPlayer.startTime = currentPlayer.lastDeathTime = bz_getCurrentTime();
+// A single thread the main loop hands slow work to, such as parsing a team dump or writing a file.
+//
+// The threading contract: a task's work runs on the worker thread and may only use what was captured
+// into it by value or through a shared_ptr nothing else touches until the task is done. It must never
+// call into bzfs, which isn't thread safe, or touch the plugin. A task's done callback runs on the main
+// thread from the tick event and is the only place the results may be applied to the plugin. Tasks run
+// in the order they were submitted. Debug builds assert that the main thread's side of the contract is
+// only ever used from the main thread.
+class BackgroundWorker
+{
+public:
+    BackgroundWorker () :
+        running(false),
+        stopping(false),
+        pending(0)
+    {}
 
-                    currentMatch->matchRoster[bzid] = currentPlayer;
+    ~BackgroundWorker ()
+    {
+        stop();
+    }
 
-                    // Some helpful debug messages
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Adding player '%s' to roll call...", currentPlayer.callsign.c_str());
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   BZID       : %s", currentPlayer.bzID.c_str());
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   IP Address : %s", currentPlayer.ipAddress.c_str());
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Name  : %s", currentPlayer.teamName.c_str());
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Color : %s", formatTeam(currentPlayer.teamColor).c_str());
-                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Start Time : %0.f", currentPlayer.startTime);
-                }
-            }
+    bool start ()
+    {
+        if (running)
+        {
+            return true;
         }
-        break;
 
-        case bz_eGetAutoTeamEvent:
-        {
-            bz_GetAutoTeamEventData_V1* autoTeamData = (bz_GetAutoTeamEventData_V1*)eventData;
+        stopping = false;
 
-            if (bz_getTeamPlayerLimit(autoTeamData->team) == 0)
-            {
-                autoTeamData->handled = true;
-                autoTeamData->team = (rand() % 2) ? TEAM_ONE : TEAM_TWO;
-            }
+        try
+        {
+            thread  = std::thread(&BackgroundWorker::run, this);
+            running = true;
         }
-        break;
-
-        case bz_eGetPlayerMotto: // This event is called when the player joins. It gives us the motto of the player
+        catch (const std::system_error &)
         {
-            bz_GetPlayerMottoData_V2* mottoData = (bz_GetPlayerMottoData_V2*)eventData;
-
-            if (!DISABLE_MOTTO)
-            {
-                mottoData->motto = teamMottos[mottoData->record->bzID.c_str()];
-            }
+            running = false;
         }
-        break;
 
-        case bz_ePlayerDieEvent:
-        {
-            bz_PlayerDieEventData_V1 *dieData = (bz_PlayerDieEventData_V1*)eventData;
+        return running;
+    }
 
-            if (currentMatch != NULL)
-            {
-                std::unique_ptr<bz_BasePlayerRecord> playerRecord(bz_getPlayerByIndex(dieData->playerID));
-                MatchParticipant &player = currentMatch->matchRoster[playerRecord->bzID];
-                player.lastDeathTime = bz_getCurrentTime();
-            }
+    // Finish the work that's already been submitted and join the thread. Done callbacks that haven't
+    // run yet are dropped
+    void stop ()
+    {
+        if (!running)
+        {
+            return;
         }
-        break;
 
-        case bz_ePlayerJoinEvent: // This event is called each time a player joins the game
         {
-            bz_PlayerJoinPartEventData_V1* joinData = (bz_PlayerJoinPartEventData_V1*)eventData;
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
 
-            // Only notify a player if they exist, have joined the observer team, and there is a match in progress
-            if ((bz_isCountDownActive() || bz_isCountDownInProgress()) && isValidPlayerID(joinData->playerID) && joinData->record->team == eObservers)
-            {
-                bz_sendTextMessagef(BZ_SERVER, joinData->playerID, "*** There is currently %s match in progress, please be respectful. ***",
-                                    ((currentMatch->isOfficialMatch) ? "an official" : "a fun"));
-            }
+        wake.notify_one();
+        thread.join();
 
-            if (!DISABLE_MOTTO)
-            {
-                // Only send a URL job if the user is verified
-                if (joinData->record->verified)
-                {
-                    requestTeamName(joinData->record->callsign.c_str(), joinData->record->bzID.c_str());
-                }
-            }
+        Task task;
+        while (results.pop(task)) {}
 
-            if (bz_isCountDownActive() && joinData->record->team != eObservers && !currentMatch->matchRoster.count(joinData->record->bzID))
-            {
-                MatchParticipant player(joinData->record);
+        running = false;
+        pending = 0;
+    }
 
-                player.startTime = player.lastDeathTime = bz_getCurrentTime();
-                player.teamName  = teamMottos[joinData->record->bzID];
+    // Main thread only. When the worker isn't running, the task is run right away. When the worker is too far
+    // behind, we wait for it to catch up instead so tasks still run in order
+    void submit (std::function<void()> work, std::function<void()> done = std::function<void()>())
+    {
+        assert(!onWorkerThread());
 
-                currentMatch->matchRoster[joinData->record->bzID] = player;
+        Task task;
+        task.work = work;
+        task.done = done;
 
-                // Some helpful debug messages
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Adding player '%s' to roll call...", player.callsign.c_str());
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   BZID       : %s", player.bzID.c_str());
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   IP Address : %s", player.ipAddress.c_str());
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Name  : %s", player.teamName.c_str());
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Color : %s", formatTeam(player.teamColor).c_str());
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Start Time : %0.f", player.startTime);
+        if (running)
+        {
+            while (!tasks.push(task))
+            {
+                runCompletions();
+                std::this_thread::yield();
             }
 
-            if (currentMatch && getMatchProgress() >= 30)
+            pending++;
+
             {
-                bz_setPlayerSpawnAtBase(joinData->playerID, false);
+                std::lock_guard<std::mutex> lock(wakeMutex);
             }
+
+            wake.notify_one();
+            return;
         }
-        break;
 
-        case bz_ePlayerPartEvent:
-        {
-            bz_PlayerJoinPartEventData_V1 *partData = (bz_PlayerJoinPartEventData_V1*)eventData;
-            std::string bzid = partData->record->bzID;
+        task.work();
 
-            if (currentMatch != NULL && currentMatch->matchRoster.find(bzid) != currentMatch->matchRoster.end() && partData->record->team != eObservers)
-            {
-                MatchParticipant &participant = currentMatch->matchRoster[bzid];
+        if (task.done)
+        {
+            task.done();
+        }
+    }
 
-                participant.updatePlayingTime(partData->record->team);
+    // Main thread only. Run the done callback of every task the worker has finished
+    void runCompletions ()
+    {
+        assert(!onWorkerThread());
 
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s has left with %.0f seconds of playing time",
-                                 participant.callsign.c_str(), participant.totalPlayTime);
-            }
-        }
-        break;
+        Task task;
 
-        case bz_ePlayerSpawnEvent:
+        while (results.pop(task))
         {
-            bz_PlayerSpawnEventData_V1 *spawnData = (bz_PlayerSpawnEventData_V1*)eventData;
+            pending--;
 
-            if (currentMatch != NULL)
+            if (task.done)
             {
-                std::unique_ptr<bz_BasePlayerRecord> playerRecord(bz_getPlayerByIndex(spawnData->playerID));
-
-                if (playerRecord)
-                {
-                    MatchParticipant &player = currentMatch->matchRoster[playerRecord->bzID];
-
-                    player.hasSpawned = true;
-                    player.totalIdleTime += std::max(0.0, (bz_getCurrentTime() - player.lastDeathTime - (bz_getBZDBDouble("_explodeTime") * 1.5)));
-                }
+                task.done();
             }
         }
-        break;
+    }
 
-        case bz_eTeamScoreChanged:
-        {
-            bz_TeamScoreChangeEventData_V1* teamScoreChange = (bz_TeamScoreChangeEventData_V1*)eventData;
+    // Main thread only. The number of tasks whose done callback hasn't run yet
+    size_t pendingTasks () const
+    {
+        return pending;
+    }
 
-            // We only need to keep track of the store if it's a match
-            if (currentMatch != NULL && teamScoreChange->element == bz_eLosses)
-            {
-                (teamScoreChange->team == TEAM_ONE) ? currentMatch->teamTwoPoints++ : currentMatch->teamOnePoints++;
+    static bool onWorkerThread ()
+    {
+        return isWorkerThread();
+    }
 
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s team scored.", formatTeam(teamScoreChange->team).c_str());
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s Match Score %s [%i] vs %s [%i]",
-                                 (currentMatch->isOfficialMatch) ? "Official" : "Fun",
-                                 formatTeam(TEAM_ONE).c_str(), currentMatch->teamOnePoints,
-                                 formatTeam(TEAM_TWO).c_str(), currentMatch->teamTwoPoints);
-            }
-        }
-        break;
+private:
+    struct Task
+    {
+        std::function<void()> work,
+                              done;
+    };
+
+    static bool& isWorkerThread ()
+    {
+        static thread_local bool workerThread = false;
+        return workerThread;
+    }
+
+    void run ()
+    {
+        isWorkerThread() = true;
 
-        case bz_eTickEvent: // This event is called once for each BZFS main loop
+        while (true)
         {
-            // Get the total number of tanks playing
-            int totaltanks = bz_getTeamCount(eRedTeam) + bz_getTeamCount(eGreenTeam) + bz_getTeamCount(eBlueTeam) + bz_getTeamCount(ePurpleTeam);
+            Task task;
 
-            // If there are no tanks playing, then we need to do some clean up
-            if (totaltanks == 0)
+            if (tasks.pop(task))
             {
-                // If there is an official match and no tanks playing, we need to cancel it
-                if (currentMatch != NULL)
+                try
                 {
-                    currentMatch->canceled = true;
-                    currentMatch->cancelationReason = "Current match automatically canceled due to all players leaving the match.";
+                    task.work();
                 }
+                catch (...) {}
+
+                task.work = std::function<void()>();
 
-                // If there is a countdown active an no tanks are playing, then cancel it
-                if (bz_isCountDownActive())
+                // Wait for the main thread to make room for the result unless we're shutting down
+                while (!results.push(task) && !stopping)
                 {
-                    bz_gameOver(253, eObservers);
-                    bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Game ended because no players were found playing with an active countdown.");
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 }
+
+                continue;
             }
-        }
-        break;
 
-        default: break;
+            std::unique_lock<std::mutex> lock(wakeMutex);
+
+            if (stopping && tasks.empty())
+            {
+                return;
+            }
+
+            wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+        }
     }
-}
 
-bool LeagueOverseer::SlashCommand (int playerID, bz_ApiString command, bz_ApiString /*message*/, bz_APIStringList *params)
+    static const size_t QUEUE_SIZE = 256;
+
+    SPSCQueue<Task, QUEUE_SIZE> tasks,    // Main thread to worker
+                                results;  // Worker to main thread
+
+    std::thread             thread;
+    std::mutex              wakeMutex;
+    std::condition_variable wake;
+
+    bool              running;
+    std::atomic<bool> stopping;
+    size_t            pending;
+};
+
+// Plugin state may only be touched from the main thread; see BackgroundWorker
+#define ASSERT_MAIN_THREAD() assert(!BackgroundWorker::onWorkerThread())
+
+// A hierarchical timer wheel for the plugin's time based work. Time is cut into ticks of RESOLUTION
+// seconds and each level of the wheel covers SLOTS times the span of the level below it; a timer sits
+// in the coarsest level that can hold it and is moved down a level as its time gets closer. Scheduling,
+// cancelling, and firing a timer are all constant time, and a tick with nothing due costs next to nothing.
+class TimerWheel
 {
-    std::unique_ptr<bz_BasePlayerRecord> playerData(bz_getPlayerByIndex(playerID));
+public:
+    typedef uint64_t TimerID;
 
-    // For some reason, the player record could not be created
-    if (!playerData)
+    // Called when a timer fires. A repeating timer keeps running for as long as its callback returns true
+    typedef std::function<bool()> Callback;
+
+    static const int    SLOT_BITS  = 6;
+    static const int    SLOTS      = 1 << SLOT_BITS;
+    static const int    LEVELS     = 3;
+    static const double RESOLUTION;
+
+    // Every slot starts out with room for this many timers, so the first timer to land in a slot doesn't allocate
+    // either. A new match schedules its timer in whichever slots its start happens to line up with
+    static const size_t SLOT_CAPACITY = 8;
+
+    TimerWheel () :
+        origin(-1),
+        currentTick(0),
+        nextID(1)
     {
-        return true;
+        for (int level = 0; level < LEVELS; level++)
+        {
+            for (int slot = 0; slot < SLOTS; slot++)
+            {
+                wheel[level][slot].reserve(SLOT_CAPACITY);
+            }
+
+            scratch[level].reserve(SLOT_CAPACITY);
+        }
     }
 
-    // If the player is not verified and does not have the spawn permission, they can't use any of the commands
-    if (!playerData->verified || !bz_hasPerm(playerID, "spawn"))
+    // Run a callback once after a delay, or every interval seconds after that if the interval is positive
+    TimerID schedule (double now, double delay, double interval, Callback callback)
     {
-        bz_sendTextMessagef(BZ_SERVER, playerID, "You do not have permission to run the /%s command.", command.c_str());
-        return true;
+        catchUp(now);
+
+        TimerID id = nextID++;
+        Timer &timer = timers[id];
+
+        timer.callback = callback;
+        timer.interval = interval;
+        timer.expires  = currentTick + ticksFor(delay);
+
+        insert(id, timer.expires);
+
+        return id;
     }
 
-    if (command == "cancel")
+    // Cancelled timers are left in their slot and skipped when it comes up
+    void cancel (TimerID id)
     {
-        if (playerData->team == eObservers) // Observers can't cancel matches
+        timers.erase(id);
+    }
+
+    bool isScheduled (TimerID id) const
+    {
+        return timers.count(id) > 0;
+    }
+
+    bool empty () const
+    {
+        return timers.empty();
+    }
+
+    size_t size () const
+    {
+        return timers.size();
+    }
+
+    // Fire every timer that has come due by now
+    void advance (double now)
+    {
+        uint64_t target = tickAt(now);
+
+        while (currentTick < target && !timers.empty())
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to cancel matches.");
+            currentTick++;
+            runTick();
         }
-        else if (bz_isCountDownInProgress()) // Cancel the countdown if it's in progress
+
+        currentTick = std::max(currentTick, target);
+    }
+
+private:
+    struct Timer
+    {
+        Callback callback;
+        double   interval;
+        uint64_t expires;
+    };
+
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+
+    uint64_t tickAt (double now)
+    {
+        if (origin < 0)
         {
-            bz_cancelCountdown(playerID);
+            origin = now;
+        }
 
-            currentMatch = NULL;
+        return (uint64_t)std::max(0.0, (now - origin) / RESOLUTION);
+    }
+
+    static uint64_t ticksFor (double seconds)
+    {
+        return std::max((uint64_t)1, (uint64_t)ceil(seconds / RESOLUTION));
+    }
+
+    // With nothing scheduled the wheel isn't advanced, so move it up to the present before adding to it
+    void catchUp (double now)
+    {
+        if (timers.empty())
+        {
+            currentTick = std::max(currentTick, tickAt(now));
         }
-        else if (bz_isCountDownActive()) // We can only cancel a match if the countdown is active
+    }
+
+    void insert (TimerID id, uint64_t expires)
+    {
+        uint64_t delta = expires - currentTick;
+
+        for (int level = 0; level < LEVELS; level++)
         {
-            // We're canceling an official match
-            if (currentMatch->isOfficialMatch)
-            {
-                currentMatch->canceled = true;
-                currentMatch->cancelationReason = "Official match cancellation requested by " + std::string(playerData->callsign.c_str());
-            }
-            else // Cancel the fun match like normal
+            int shift = level * SLOT_BITS;
+
+            // Anything further away than the wheel reaches waits in the last slot it can and is put back
+            // in when that slot comes up
+            if (delta < ((uint64_t)SLOTS << shift) || level == LEVELS - 1)
             {
-                bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Fun match ended by %s", playerData->callsign.c_str());
+                uint64_t placement = std::min(expires, currentTick + ((uint64_t)SLOTS << shift) - 1);
+                wheel[level][(placement >> shift) & SLOT_MASK].push_back(id);
+                return;
             }
-
-            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Match ended by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
-            bz_gameOver(253, eObservers);
         }
-        else
+    }
+
+    // Move every timer in a slot of a coarser level down to where it belongs now. The slot is swapped with the
+    // level's scratch vector and the scratch vector is cleared afterwards, so both keep their capacity and a
+    // warmed up wheel never allocates
+    void cascade (int level)
+    {
+        std::vector<TimerID> &slot = scratch[level];
+        slot.swap(wheel[level][(currentTick >> (level * SLOT_BITS)) & SLOT_MASK]);
+
+        for (size_t i = 0; i < slot.size(); i++)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "There is no match in progress to cancel.");
+            std::unordered_map<TimerID, Timer>::const_iterator it = timers.find(slot[i]);
+
+            if (it != timers.end())
+            {
+                insert(slot[i], it->second.expires);
+            }
         }
 
-        return true;
+        slot.clear();
     }
-    else if (command == "countdown")
+
+    void runTick ()
     {
-        if (params->size() > 0)
+        // Whenever a level wraps around, the next slot of the level above it is moved down. The coarsest level
+        // goes first so its timers can keep moving down in the same tick
+        for (int level = LEVELS - 1; level > 0; level--)
         {
-            if (params->get(0) == "pause")
+            if ((currentTick & (((uint64_t)1 << (level * SLOT_BITS)) - 1)) == 0)
             {
-                bz_sendTextMessagef(BZ_SERVER, playerID, "** '/countdown pause' is disabled, please use /pause instead **");
+                cascade(level);
             }
-            else if (params->get(0) == "resume")
+        }
+
+        // Timers scheduled by the callbacks go into the wheel, never into the due list being walked here
+        std::vector<TimerID> &due = scratch[0];
+        due.swap(wheel[0][currentTick & SLOT_MASK]);
+
+        for (size_t i = 0; i < due.size(); i++)
+        {
+            TimerID id = due[i];
+            std::unordered_map<TimerID, Timer>::iterator it = timers.find(id);
+
+            if (it == timers.end())
             {
-                bz_sendTextMessagef(BZ_SERVER, playerID, "** '/countdown resume' is disabled, please use /resume instead **");
+                continue;
             }
-            else if (params->get(0) == "cancel")
+
+            if (it->second.expires > currentTick)
             {
-                bz_sendTextMessagef(BZ_SERVER, playerID, "** '/countdown cancel' is disabled, please use /cancel instead **");
+                insert(id, it->second.expires);
+                continue;
+            }
+
+            // The callback may schedule or cancel timers, itself included, so it can't run out of the table. It's
+            // moved out rather than copied, which never allocates, and moved back if the timer keeps running
+            Callback callback = std::move(it->second.callback);
+            double interval = it->second.interval;
+            bool keepRunning = callback();
+
+            it = timers.find(id);
+
+            if (it == timers.end())
+            {
+                continue;
+            }
+
+            if (interval > 0 && keepRunning)
+            {
+                it->second.callback = std::move(callback);
+                it->second.expires  = currentTick + ticksFor(interval);
+                insert(id, it->second.expires);
             }
             else
             {
-                bz_sendTextMessage(BZ_SERVER, playerID, "** '/countdown TIME' is disabled, please use /official or /fm instead **");
+                timers.erase(it);
             }
         }
-        else
+
+        due.clear();
+    }
+
+    double   origin;      // The time tick 0 started at
+    uint64_t currentTick;
+    TimerID  nextID;
+
+    std::unordered_map<TimerID, Timer> timers;
+    std::vector<TimerID> wheel[LEVELS][SLOTS];
+    std::vector<TimerID> scratch[LEVELS]; // Holds the slot being emptied at each level; level 0 is the slot that's due
+};
+
+const double TimerWheel::RESOLUTION = 0.1;
+
+// Get a human readable name for the events this plugin listens to
+static const char* eventTypeName (int eventType)
+{
+    switch (eventType)
+    {
+        case bz_eBZDBChange:        return "bz_eBZDBChange";
+        case bz_eCaptureEvent:      return "bz_eCaptureEvent";
+        case bz_eFlagDroppedEvent:  return "bz_eFlagDroppedEvent";
+        case bz_eFlagGrabbedEvent:  return "bz_eFlagGrabbedEvent";
+        case bz_eGameEndEvent:      return "bz_eGameEndEvent";
+        case bz_eGameResumeEvent:   return "bz_eGameResumeEvent";
+        case bz_eGameStartEvent:    return "bz_eGameStartEvent";
+        case bz_eGetAutoTeamEvent:  return "bz_eGetAutoTeamEvent";
+        case bz_eGetPlayerMotto:    return "bz_eGetPlayerMotto";
+        case bz_ePlayerDieEvent:    return "bz_ePlayerDieEvent";
+        case bz_ePlayerJoinEvent:   return "bz_ePlayerJoinEvent";
+        case bz_ePlayerPartEvent:   return "bz_ePlayerPartEvent";
+        case bz_ePlayerSpawnEvent:  return "bz_ePlayerSpawnEvent";
+        case bz_eTeamScoreChanged:  return "bz_eTeamScoreChanged";
+        case bz_eTickEvent:         return "bz_eTickEvent";
+
+        default: return NULL;
+    }
+}
+
+// The types of requests we send to the league website
+enum URLJobType
+{
+    eReportMatchJob = 0,
+    eTeamDumpJob,
+    eTeamNameJob,
+    URL_JOB_TYPE_COUNT
+};
+
+// The value of the 'query' POST parameter for each type of request, also used as a metric label
+static const char* URL_JOB_NAMES[URL_JOB_TYPE_COUNT] = { "reportMatch", "teamDump", "teamNameQuery" };
+
+// How urgently each type of request has to reach the league website. Queued requests of a higher
+// priority are always sent first, and only the low priority ones are rate limited or dropped
+enum URLJobPriority
+{
+    eHighPriority = 0,
+    eNormalPriority,
+    eLowPriority,
+    URL_JOB_PRIORITY_COUNT
+};
+
+static const URLJobPriority URL_JOB_PRIORITIES[URL_JOB_TYPE_COUNT] = { eHighPriority, eNormalPriority, eLowPriority };
+
+// The amount of seconds each type of request is given to finish when we send it ourselves with libcurl; bzfs
+// uses the same timeout for every request it sends. A team name query that takes longer than a few seconds is
+// useless by the time it comes back, while a match report is worth waiting for
+static const long URL_JOB_TIMEOUTS[URL_JOB_TYPE_COUNT] = { 60, 30, 5 };
+
+// The number of requests we let bzfs work on at once; anything else waits in our own queues where it
+// can still be reordered. A request that hasn't been answered after URL_JOB_STALL_TIMEOUT seconds is
+// assumed lost and no longer holds up the queue. A sidecar gets many requests at once on its single
+// connection instead
+const size_t MAX_URL_JOBS_IN_FLIGHT = 1;
+const size_t MAX_SIDECAR_JOBS_IN_FLIGHT = 16;
+const double URL_JOB_STALL_TIMEOUT = 120.0;
+
+#ifdef HAVE_LIBCURL
+// Sends requests to the league website with a libcurl multi handle of our own instead of bz_addURLJob. The
+// transfers are only ever moved along from the tick event with curl_multi_perform(), which never waits on the
+// network, and the connections are kept alive between requests so a match report or team name query doesn't
+// start with a fresh TCP and TLS handshake. The handler of a request is called the same way bzfs would call it,
+// with the body of a response always followed by a null terminator.
+class CurlTransport
+{
+public:
+    CurlTransport () :
+        multi(NULL)
+    {}
+
+    ~CurlTransport ()
+    {
+        stop();
+    }
+
+    bool start ()
+    {
+        if (multi)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "** '/countdown' is disabled, please use /official or /fm instead **");
+            return true;
+        }
+
+        multi = curl_multi_init();
+
+        if (!multi)
+        {
+            return false;
         }
 
+        // All of our requests go to one or two URLs, so there's no need to keep more connections than that around
+        curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, 4L);
+
         return true;
     }
-    else if (command == "finish")
+
+    // Abort every request that is still in flight, without calling its handler, and close all of the connections
+    void stop ()
     {
-        if (playerData->team == eObservers) // Observers can't cancel matches
+        for (auto &request : requests)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to finish matches.");
+            curl_multi_remove_handle(multi, request->easy);
+            curl_easy_cleanup(request->easy);
         }
-        else if (bz_isCountDownInProgress()) // Refer them to the /cancel command to stop a countdown
+
+        requests.clear();
+
+        if (multi)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "Use the /cancel command to cancel the countdown.");
+            curl_multi_cleanup(multi);
+            multi = NULL;
         }
-        else if (bz_isCountDownActive()) // Only finish if the countdown is active
+    }
+
+    bool isStarted () const
+    {
+        return (multi != NULL);
+    }
+
+    size_t inFlight () const
+    {
+        return requests.size();
+    }
+
+    // POST a request that has to finish within the given amount of seconds; the handler is called from poll()
+    bool send (const std::string &url, const std::string &postData, long timeout, bz_BaseURLHandler *handler)
+    {
+        if (!multi)
         {
-            // We can only '/finish' official matches because I wanted to have a command only dedicated to
-            // reporting partially completed matches
-            if (currentMatch->isOfficialMatch)
-            {
-                // Let's check if we can report the match, in other words, at least half of the match has been reported
-                if (getMatchProgress() >= currentMatch->duration / 2)
-                {
-                    bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Official match ended early by %s (%s)", playerData->callsign.c_str(), playerData->ipAddress.c_str());
-                    bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Official match ended early by %s", playerData->callsign.c_str());
+            return false;
+        }
 
-                    bz_gameOver(253, eObservers);
-                }
-                else
-                {
-                    bz_sendTextMessage(BZ_SERVER, playerID, "Sorry, I cannot automatically report a match less than half way through.");
-                    bz_sendTextMessage(BZ_SERVER, playerID, "Please use the /cancel command and message a referee for review of this match.");
-                }
-            }
-            else
-            {
-                bz_sendTextMessage(BZ_SERVER, playerID, "You cannot /finish a fun match. Use /cancel instead.");
-            }
+        CURL *easy = curl_easy_init();
+
+        if (!easy)
+        {
+            return false;
         }
-        else
+
+        std::unique_ptr<Request> request(new Request);
+        request->easy    = easy;
+        request->url     = url;
+        request->handler = handler;
+
+        curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(easy, CURLOPT_COPYPOSTFIELDS, postData.c_str());
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT, timeout);
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, std::min(timeout, 10L));
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &CurlTransport::writeResponse);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, request.get());
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, request.get());
+
+        if (curl_multi_add_handle(multi, easy) != CURLM_OK)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "There is no match in progress to end.");
+            curl_easy_cleanup(easy);
+            return false;
         }
 
+        requests.push_back(std::move(request));
+
         return true;
     }
-    else if (command == "fm")
+
+    // Do whatever can be done without waiting on the network and call the handlers of the requests that finished
+    void poll ()
     {
-        if (playerData->team == eObservers) // Observers can't start matches
-        {
-            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to start matches.");
-        }
-        else if (currentMatch != NULL || bz_isCountDownActive() || bz_isCountDownInProgress()) // There is already a countdown
+        if (!multi || requests.empty())
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "There is already a game in progress; you cannot start another.");
+            return;
         }
-        else // They are verified, not an observer, there is no match. So start one
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg *message;
+        int remaining = 0;
+
+        while ((message = curl_multi_info_read(multi, &remaining)))
         {
-            currentMatch.reset(new CurrentMatch());
+            if (message->msg != CURLMSG_DONE)
+            {
+                continue;
+            }
 
-            // We signify an FM whenever the 'currentMatch' variable is set to NULL so set it to null
-            currentMatch->isOfficialMatch = false;
+            CURLcode result = message->data.result;
+            Request *finished = NULL;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char**)&finished);
 
-            // Log the actions
-            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Fun match started by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
-            bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Fun match started by %s.", playerData->callsign.c_str());
+            curl_multi_remove_handle(multi, finished->easy);
+            curl_easy_cleanup(finished->easy);
 
-            // The amount of seconds the countdown should take
-            int timeToStart = (params->size() == 1) ? atoi(params->get(0).c_str()) : 10;
+            // Take the request out of our list before calling its handler, which may very well send another one
+            std::unique_ptr<Request> request;
 
-            // Sanity check...
-            if (timeToStart <= 60 && timeToStart >= 10)
+            for (auto it = requests.begin(); it != requests.end(); ++it)
             {
-                bz_startCountdown(timeToStart, bz_getTimeLimit(), "Server"); // Start the countdown with a custom countdown time limit under 1 minute
+                if (it->get() == finished)
+                {
+                    request = std::move(*it);
+                    requests.erase(it);
+                    break;
+                }
+            }
+
+            if (result == CURLE_OK)
+            {
+                request->handler->URLDone(request->url.c_str(), request->response.c_str(), (unsigned int)request->response.size(), true);
+            }
+            else if (result == CURLE_OPERATION_TIMEDOUT)
+            {
+                request->handler->URLTimeout(request->url.c_str(), result);
             }
             else
             {
-                bz_sendTextMessage(BZ_SERVER, playerID, "Holy sanity check, Batman! Let's not have a countdown last longer than 60 seconds or less than 10.");
-                bz_startCountdown(10, bz_getTimeLimit(), "Server"); // Start the countdown for the official match
+                request->handler->URLError(request->url.c_str(), result, curl_easy_strerror(result));
             }
         }
+    }
 
-        return true;
+private:
+    struct Request
+    {
+        CURL        *easy;
+        std::string  url,
+                     response;
+
+        bz_BaseURLHandler *handler;
+    };
+
+    static size_t writeResponse (char *data, size_t size, size_t count, void *userdata)
+    {
+        static_cast<Request*>(userdata)->response.append(data, size * count);
+
+        return size * count;
     }
-    else if (command == "gameover")
+
+    CURLM *multi;
+
+    std::vector<std::unique_ptr<Request>> requests;
+};
+#else
+// The plugin was built without libcurl, so there's no client of our own to start and requests are sent by bzfs
+class CurlTransport
+{
+public:
+    bool   start ()           { return false; }
+    void   stop ()            {}
+    bool   isStarted () const { return false; }
+    size_t inFlight () const  { return 0; }
+    void   poll ()            {}
+
+    bool send (const std::string &/*url*/, const std::string &/*postData*/, long /*timeout*/, bz_BaseURLHandler* /*handler*/)
     {
-        bz_sendTextMessagef(BZ_SERVER, playerID, "** '/gameover' is disabled, please use /finish or /cancel instead **");
+        return false;
+    }
+};
+#endif
+
+// Sends requests to a sidecar daemon listening on a Unix domain socket on the same host, which forwards them to
+// the league website however it sees fit. Every request and response is a frame made of a header line and a body,
+//
+//     request:  <id> <length>\n<POST data>
+//     response: <id> <ok|error> <length>\n<response body, or the error message>
+//
+// so any number of requests can be in flight on the one connection and the sidecar may answer them in any order.
+// The socket is never waited on, not even while connecting; poll() writes and reads whatever it can from the tick
+// event. When the connection is lost every request in flight fails and the next request tries to connect again.
+// Handlers are only ever called from poll(), so a request never fails while the plugin is in the middle of
+// something else, such as reloading its configuration.
+class SidecarTransport
+{
+public:
+    // The largest response we accept, anything bigger means the sidecar is speaking another protocol
+    static const size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+    // The amount of seconds we leave the sidecar alone after failing to connect to it
+    static const double RETRY_DELAY;
+
+    SidecarTransport () :
+        fd(-1),
+        connecting(false),
+        nextID(1),
+        lastFailure(0)
+    {}
+
+    ~SidecarTransport ()
+    {
+        stop();
+    }
+
+    // Use a different socket from the next request on, failing the requests that are in flight on the current one
+    void setPath (const std::string &socketPath)
+    {
+        if (socketPath != path)
+        {
+            disconnect();
+            path = socketPath;
+            lastFailure = 0;
+        }
+    }
+
+    bool isConnected () const
+    {
+        return (fd >= 0);
+    }
+
+    size_t inFlight () const
+    {
+        return requests.size() + lost.size();
+    }
+
+    // Forget every request in flight without calling its handler and close the connection
+    void stop ()
+    {
+        requests.clear();
+        lost.clear();
+        closeSocket();
+    }
+
+    // Close the connection; every request that was in flight on it fails on the next poll()
+    void disconnect ()
+    {
+        for (auto &request : requests)
+        {
+            lost.push_back(request.second);
+        }
+
+        requests.clear();
+        closeSocket();
+    }
+
+    // Queue a request that has to be answered within the given amount of seconds; the handler is called from
+    // poll(). Returns false if the sidecar can't be reached so the caller can send the request another way
+    bool send (const std::string &url, const std::string &postData, double timeout, double now, bz_BaseURLHandler *handler)
+    {
+        if (fd < 0 && !connectSocket(now))
+        {
+            return false;
+        }
+
+        uint32_t id = nextID++;
+
+        Request &request = requests[id];
+        request.url      = url;
+        request.handler  = handler;
+        request.deadline = now + timeout;
+
+        char header[32];
+        snprintf(header, sizeof(header), "%u %u\n", id, (unsigned int)postData.size());
+
+        output += header;
+        output += postData;
+
+        if (!connecting)
+        {
+            flush();
+        }
 
         return true;
     }
-    else if (command == "offi" || command == "official")
+
+    // Write and read as much as the socket allows without waiting, then call the handlers of the requests that
+    // were answered or ran out of time
+    void poll (double now)
     {
-        if (playerData->team == eObservers) // Observers can't start matches
+        if (fd < 0 && requests.empty() && lost.empty())
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to start matches.");
+            return;
         }
-        else if (bz_getTeamCount(TEAM_ONE) < 2 || bz_getTeamCount(TEAM_TWO) < 2) // An official match cannot be 1v1 or 2v1
+
+        if (connecting)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "You may not have an official match with less than 2 players per team.");
+            checkConnected(now);
         }
-        else if (currentMatch != NULL || bz_isCountDownActive() || bz_isCountDownInProgress()) // A countdown is in progress already
+
+        std::vector<std::pair<Request, Response>> finished;
+
+        if (fd >= 0 && !connecting)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "There is already a game in progress; you cannot start another.");
+            flush();
+            receive();
+            parseResponses(finished);
         }
-        else // They are verified non-observer with valid team sizes and no existing match. Start one!
+
+        // Nothing more is coming for the requests that were sent on a connection we've lost
+        if (fd < 0)
         {
-            currentMatch.reset(new CurrentMatch());
+            disconnect();
+        }
 
-            // Log the actions so admins can bug brad to look at detailed information
-            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Official match started by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
-            bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Official match started by %s.", playerData->callsign.c_str());
+        for (auto &request : lost)
+        {
+            Response response;
+            response.status = eRejected;
+            response.body   = "connection to the sidecar lost";
 
-            // The amount of seconds the countdown should take
-            int timeToStart = (params->size() == 1) ? atoi(params->get(0).c_str()) : 10;
+            finished.push_back(std::make_pair(request, response));
+        }
 
-            // Sanity check...
-            if (timeToStart <= 60 && timeToStart >= 10)
+        lost.clear();
+
+        for (auto it = requests.begin(); it != requests.end(); )
+        {
+            if (it->second.deadline <= now)
             {
-                bz_startCountdown(timeToStart, bz_getTimeLimit(), "Server"); // Start the countdown with a custom countdown time limit under 1 minute
+                Response timedOut;
+                timedOut.status = eTimedOut;
+
+                finished.push_back(std::make_pair(it->second, timedOut));
+                it = requests.erase(it);
             }
             else
             {
-                bz_sendTextMessage(BZ_SERVER, playerID, "Holy sanity check, Batman! Let's not have a countdown last longer than 60 seconds or less than 10.");
-                bz_startCountdown(10, bz_getTimeLimit(), "Server"); // Start the countdown for the official match
+                ++it;
             }
         }
 
-        return true;
+        // The handlers are only called once we're done with our own state since they may send new requests
+        for (auto &result : finished)
+        {
+            const Request  &request  = result.first;
+            const Response &response = result.second;
+
+            if (response.status == eAnswered)
+            {
+                request.handler->URLDone(request.url.c_str(), response.body.c_str(), (unsigned int)response.body.size(), true);
+            }
+            else if (response.status == eTimedOut)
+            {
+                request.handler->URLTimeout(request.url.c_str(), 0);
+            }
+            else
+            {
+                request.handler->URLError(request.url.c_str(), 0, response.body.c_str());
+            }
+        }
     }
-    else if (command == "pause")
+
+private:
+    enum ResponseStatus
     {
-        if (bz_isCountDownPaused())
+        eAnswered,
+        eRejected,
+        eTimedOut
+    };
+
+    struct Request
+    {
+        std::string url;
+        double      deadline;
+
+        bz_BaseURLHandler *handler;
+    };
+
+    struct Response
+    {
+        ResponseStatus status;
+        std::string    body;
+    };
+
+    bool connectSocket (double now)
+    {
+#ifndef _WIN32
+        if (path.empty() || now - lastFailure < RETRY_DELAY)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "The match is already paused!");
+            return false;
         }
-        else if (bz_isCountDownActive())
+
+        struct sockaddr_un address;
+
+        if (path.size() >= sizeof(address.sun_path))
         {
-            bz_pauseCountdown(playerData->callsign.c_str());
+            lastFailure = now;
+            return false;
+        }
 
-            // We've paused an official match, so we need to delay the approxTimeProgress in order to calculate the roll call time properly
-            currentMatch->matchPaused = time(NULL);
-            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match paused at %s by %s.", getMatchTime().c_str(), playerData->callsign.c_str());
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path, path.c_str(), path.size());
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd < 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+        {
+            closeSocket();
+            lastFailure = now;
+
+            return false;
         }
-        else
+
+        // Requests are queued up while the connection is being set up and written once it's accepted. Linux refuses
+        // a local connection with EAGAIN when the sidecar has too many waiting to be accepted, which is no different
+        // from the sidecar not being there
+        if (::connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "There is no active match to pause right now.");
+            if (errno != EINPROGRESS && errno != EINTR)
+            {
+                closeSocket();
+                lastFailure = now;
+
+                return false;
+            }
+
+            connecting = true;
         }
 
         return true;
+#else
+        (void)now;
+        return false;
+#endif
     }
-    else if (command == "resume")
+
+    // See whether a connection that was still being set up has been accepted or refused since
+    void checkConnected (double now)
     {
-        if (!bz_isCountDownPaused())
+#ifndef _WIN32
+        struct pollfd waiting;
+        waiting.fd      = fd;
+        waiting.events  = POLLOUT;
+        waiting.revents = 0;
+
+        int ready = ::poll(&waiting, 1, 0);
+
+        if (ready == 0 || (ready < 0 && errno == EINTR))
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "The match is not paused!");
+            return;
         }
-        else if (bz_isCountDownActive())
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+
+        if (ready < 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0)
         {
-            bz_resumeCountdown(playerData->callsign.c_str());
+            closeSocket();
+            lastFailure = now;
 
-            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match resumed by %s.", playerData->callsign.c_str());
+            return;
         }
-        else
+
+        connecting = false;
+#else
+        (void)now;
+#endif
+    }
+
+    void closeSocket ()
+    {
+#ifndef _WIN32
+        if (fd >= 0)
         {
-            bz_sendTextMessage(BZ_SERVER, playerID, "There is no active match to resume right now.");
+            ::close(fd);
         }
+#endif
 
-        return true;
+        fd = -1;
+        connecting = false;
+        input.clear();
+        output.clear();
     }
-    else if (command == "spawn")
+
+    void flush ()
     {
-        if (bz_hasPerm(playerID, "ban"))
-        {
-            if (params->size() > 0)
-            {
-                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s has executed the /spawn command.", playerData->callsign.c_str());
+#ifndef _WIN32
+        size_t written = 0;
 
-                std::unique_ptr<bz_BasePlayerRecord> target(bz_getPlayerBySlotOrCallsign(params->get(0).c_str()));
+        while (written < output.size())
+        {
+            ssize_t result = ::send(fd, output.data() + written, output.size() - written, MSG_NOSIGNAL);
 
-                if (target)
+            if (result < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
                 {
-                    bz_grantPerm(target->playerID, "spawn");
-                    bz_sendTextMessagef(BZ_SERVER, eAdministrators, "%s granted %s the ability to spawn.", playerData->callsign.c_str(), target->callsign.c_str());
-
+                    closeSocket();
+                    return;
                 }
-                else
+
+                if (errno != EINTR)
                 {
-                    bz_sendTextMessagef(BZ_SERVER, playerID, "player %s not found", params->get(0).c_str());
+                    break;
                 }
             }
             else
             {
-                bz_sendTextMessage(BZ_SERVER, playerID, "/spawn <player id or callsign>");
+                written += result;
             }
         }
-        else
-        {
-            bz_sendTextMessage(BZ_SERVER, playerID, "You do not have permission to use the /spawn command.");
-        }
 
-        return true;
+        output.erase(0, written);
+#endif
     }
 
-    return false;
-}
+    void receive ()
+    {
+#ifndef _WIN32
+        char buffer[16384];
 
-// We got a response from one of our URL jobs
-void LeagueOverseer::URLDone(const char* /*URL*/, const void* data, unsigned int /*size*/, bool /*complete*/)
-{
-    // This variable will only be set to true for the duration of one URL job, so just set it back to false regardless
-    MATCH_INFO_SENT = false;
+        while (fd >= 0)
+        {
+            ssize_t result = recv(fd, buffer, sizeof(buffer), 0);
 
-    // Convert the data we get from the URL job to a std::string
-    std::string siteData = (const char*)(data);
-    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: URL Job returned: %s", siteData.c_str());
+            if (result > 0)
+            {
+                input.append(buffer, result);
+            }
+            else if (result == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                // Hold on to what we've already received so complete responses can still be handed out
+                std::string received;
+                received.swap(input);
+                closeSocket();
+                input.swap(received);
 
-    // The returned data starts with a '{' and ends with a '}' so chances are it's JSON data
-    if (siteData.at(0) == '{' && siteData.at(siteData.length() - 1) == '}')
+                return;
+            }
+            else if (errno != EINTR)
+            {
+                return;
+            }
+        }
+#endif
+    }
+
+    // Take every complete response out of the input buffer along with the request it answers
+    void parseResponses (std::vector<std::pair<Request, Response>> &finished)
     {
-        json_object* jobj = json_tokener_parse(siteData.c_str());
-        enum json_type type;
-        std::string urlJobBZID = "", urlJobTeamName = "";
+        size_t position = 0;
 
-        // Because our JSON information has a BZID and a team name, we need to loop through them to get the information
-        json_object_object_foreach(jobj, key, val)
+        while (true)
         {
-            // Get the type of object, we need to make sure we only handle strings because that's all we should be expecting
-            type = json_object_get_type(val);
+            size_t newline = input.find('\n', position);
 
-            // There are multiple JSON types so let's switch through them
-            switch (type)
+            if (newline == std::string::npos)
             {
-                // We're getting an array meaning it's an entire team dump, so handle it accordingly
-                case json_type_array:
+                if (input.size() - position > 64)
                 {
-                    bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Team dump JSON data received.");
+                    closeSocket();
+                    return;
+                }
 
-                    // Our array will have multiple indexes with each index containing two elements
-                    // so we need to create an array_list that will give us access to all of the indexes
-                    array_list* teamMembers = json_object_get_array(val);
+                break;
+            }
 
-                    // Loop through of the indexes in our array
-                    for (int i = 0; i < array_list_length(teamMembers); i++)
-                    {
-                        // Now we need to create a JSON object so we can access the two values that the index
-                        // holds, i.e. the team name and BZIDs of the members
-                        json_object* individualTeam = (json_object*)array_list_get_idx(teamMembers, i);
+            std::string header = input.substr(position, newline - position);
+            unsigned int id = 0, length = 0;
+            char status[8] = "";
 
-                        // We will be storing the team name out here so we can access it as we're looping through
-                        // all of the team members
-                        std::string teamName;
+            if (sscanf(header.c_str(), "%u %7s %u", &id, status, &length) != 3 || length > MAX_FRAME_SIZE)
+            {
+                closeSocket();
+                return;
+            }
 
-                        // Now we need to loop through both those elements in the current index
-                        json_object_object_foreach(individualTeam, _key, _value)
-                        {
-                            // Just in case there's something funky, only handle strings at this point
-                            if (json_object_get_type(_value) == json_type_string)
-                            {
-                                // Our first key is the team name so save it
-                                if (strcmp(_key, "team") == 0)
-                                {
-                                    teamName = json_object_get_string(_value);
+            if (input.size() - newline - 1 < length)
+            {
+                break;
+            }
 
-                                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Team '%s' recorded. Getting team members...", teamName.c_str());
-                                }
-                                // Our second key is going to be the team members' BZIDs seperated by commas
-                                else if (strcmp(_key, "members") == 0)
-                                {
-                                    // Now we need to handle each BZID separately so we will split the elements
-                                    // by each comma and stuff it into a vector
-                                    std::vector<std::string> bzIDs = split(json_object_get_string(_value), ',');
+            auto request = requests.find(id);
 
-                                    // Now iterate through the vector of team members so we can save them to our
-                                    // map
-                                    for (std::vector<std::string>::const_iterator it = bzIDs.begin(); it != bzIDs.end(); ++it)
-                                    {
-                                        std::string bzID = std::string(*it);
-                                        teamMottos[bzID.c_str()] = teamName.c_str();
+            // A response to a request that already timed out is simply dropped
+            if (request != requests.end())
+            {
+                Response response;
+                response.status = (strcmp(status, "ok") == 0) ? eAnswered : eRejected;
+                response.body   = input.substr(newline + 1, length);
 
-                                        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: BZID %s set to team %s.", bzID.c_str(), teamName.c_str());
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                break;
+                finished.push_back(std::make_pair(request->second, response));
+                requests.erase(request);
+            }
 
-                // We've found a JSON string, which means it's only a single team name and bzid so handle it accordingly
-                case json_type_string:
-                {
-                    bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Team name JSON data received.");
+            position = newline + 1 + length;
+        }
 
-                    // Store the respective information in other variables because we aren't done looping
-                    if (strcmp(key, "bzid") == 0)
-                    {
-                        urlJobBZID = json_object_get_string(val);
-                    }
-                    else if (strcmp(key, "team") == 0)
-                    {
-                        urlJobTeamName = json_object_get_string(val);
-                    }
-                }
-                break;
+        input.erase(0, position);
+    }
 
-                default: break;
-            }
+    int         fd;
+    bool        connecting;  // Whether the sidecar has yet to accept or refuse our connection
+    std::string path,
+                input,
+                output;
+    uint32_t    nextID;
+    double      lastFailure;
+
+    std::map<uint32_t, Request> requests;
+    std::vector<Request>        lost;      // Requests on a connection that was closed, which fail on the next poll()
+};
+
+const double SidecarTransport::RETRY_DELAY = 5.0;
+
+// A fixed-bucket histogram in the format Prometheus expects. Recording a sample is only a couple
+// of relaxed atomic increments so it never locks and never allocates
+class MetricHistogram
+{
+public:
+    static const int BUCKET_COUNT = 10;
+
+    MetricHistogram ()
+    {
+        reset();
+    }
+
+    void observe (double seconds)
+    {
+        int bucket = 0;
+
+        while (bucket < BUCKET_COUNT && seconds > BUCKET_BOUNDS[bucket])
+        {
+            bucket++;
         }
 
-        // We have both a BZID and a team name so let's update our team motto map
-        if (urlJobBZID != "")
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        sumMicroseconds.fetch_add((uint64_t)(std::max(0.0, seconds) * 1e6), std::memory_order_relaxed);
+    }
+
+    void reset ()
+    {
+        for (int i = 0; i <= BUCKET_COUNT; i++)
+        {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+
+        sumMicroseconds.store(0, std::memory_order_relaxed);
+    }
+
+    // Write the cumulative '_bucket', '_sum', and '_count' series for this histogram
+    void write (std::ostream &out, const std::string &name, const std::string &labels) const
+    {
+        uint64_t cumulative = 0;
+
+        for (int i = 0; i <= BUCKET_COUNT; i++)
+        {
+            cumulative += counts[i].load(std::memory_order_relaxed);
+
+            out << name << "_bucket{" << labels << ",le=\"";
+
+            if (i < BUCKET_COUNT)
+            {
+                out << BUCKET_BOUNDS[i];
+            }
+            else
+            {
+                out << "+Inf";
+            }
+
+            out << "\"} " << cumulative << "\n";
+        }
+
+        out << name << "_sum{" << labels << "} " << (sumMicroseconds.load(std::memory_order_relaxed) / 1e6) << "\n";
+        out << name << "_count{" << labels << "} " << cumulative << "\n";
+    }
+
+private:
+    static const double BUCKET_BOUNDS[BUCKET_COUNT];
+
+    std::atomic<uint64_t> counts[BUCKET_COUNT + 1];
+    std::atomic<uint64_t> sumMicroseconds;
+};
+
+// The upper bounds, in seconds, of each latency bucket
+const double MetricHistogram::BUCKET_BOUNDS[MetricHistogram::BUCKET_COUNT] = { 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60 };
+
+// A histogram of how long a handler took to run in nanoseconds with power of two buckets, which is
+// precise enough to tell a 2µs handler from a 2ms handler and cheap enough to record on every tick
+class HandlerProfile
+{
+public:
+    static const int BUCKET_COUNT = 64;
+
+    HandlerProfile ()
+    {
+        reset();
+    }
+
+    void record (uint64_t nanoseconds)
+    {
+        // Bucket 0 holds zero; bucket i holds samples in [2^(i-1), 2^i)
+        int bucket = 0;
+
+        for (uint64_t value = nanoseconds; value != 0 && bucket < BUCKET_COUNT - 1; value >>= 1)
+        {
+            bucket++;
+        }
+
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t currentMax = maximum.load(std::memory_order_relaxed);
+
+        while (nanoseconds > currentMax && !maximum.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Estimate a percentile (0 to 1) as the upper bound of the bucket it falls in
+    uint64_t percentile (double fraction) const
+    {
+        uint64_t total = count.load(std::memory_order_relaxed);
+        uint64_t target = (uint64_t)ceil(total * fraction);
+        uint64_t cumulative = 0;
+
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        for (int i = 0; i < BUCKET_COUNT; i++)
+        {
+            cumulative += buckets[i].load(std::memory_order_relaxed);
+
+            if (cumulative >= target)
+            {
+                uint64_t upperBound = (i == 0) ? 0 : ((i >= 63) ? UINT64_MAX : ((uint64_t)1 << i) - 1);
+
+                return std::min(upperBound, maximum.load(std::memory_order_relaxed));
+            }
+        }
+
+        return maximum.load(std::memory_order_relaxed);
+    }
+
+    uint64_t samples () const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max () const
+    {
+        return maximum.load(std::memory_order_relaxed);
+    }
+
+    void reset ()
+    {
+        for (int i = 0; i < BUCKET_COUNT; i++)
+        {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+
+        count.store(0, std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> maximum;
+};
+
+// Time the scope this object lives in and record it into a profile when the scope is left
+class ProfileScope
+{
+public:
+    ProfileScope (HandlerProfile &_profile) :
+        profile(_profile),
+        start(std::chrono::steady_clock::now())
+    {}
+
+    ~ProfileScope ()
+    {
+        profile.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    HandlerProfile &profile;
+    std::chrono::steady_clock::time_point start;
+};
+
+// All of the counters and histograms the plugin keeps about itself. Counters are plain relaxed
+// atomics so they are safe to bump from anywhere; gauges are sampled when the file is written
+struct PluginMetrics
+{
+    std::atomic<uint64_t> eventsHandled[bz_eLastEvent];
+
+    std::atomic<uint64_t> urlJobsSent[URL_JOB_TYPE_COUNT],
+                          urlJobsDone[URL_JOB_TYPE_COUNT],
+                          urlJobTimeouts[URL_JOB_TYPE_COUNT],
+                          urlJobErrors[URL_JOB_TYPE_COUNT],
+                          urlJobsShed[URL_JOB_TYPE_COUNT];
+
+    MetricHistogram       urlJobLatency[URL_JOB_TYPE_COUNT],
+                          urlJobQueueWait[URL_JOB_TYPE_COUNT];
+
+    PluginMetrics ()
+    {
+        for (int i = 0; i < bz_eLastEvent; i++)
+        {
+            eventsHandled[i].store(0, std::memory_order_relaxed);
+        }
+
+        for (int i = 0; i < URL_JOB_TYPE_COUNT; i++)
+        {
+            urlJobsSent[i].store(0, std::memory_order_relaxed);
+            urlJobsDone[i].store(0, std::memory_order_relaxed);
+            urlJobTimeouts[i].store(0, std::memory_order_relaxed);
+            urlJobErrors[i].store(0, std::memory_order_relaxed);
+            urlJobsShed[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static void increment (std::atomic<uint64_t> &counter)
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Write all of the counters in the Prometheus text exposition format; every series carries
+    // the given labels so multiple servers on one host can share a textfile collector
+    void write (std::ostream &out, const std::string &labels) const
+    {
+        out << "# HELP leagueoverseer_events_total Number of bzfs events handled by the plugin.\n";
+        out << "# TYPE leagueoverseer_events_total counter\n";
+
+        for (int i = 0; i < bz_eLastEvent; i++)
+        {
+            if (eventTypeName(i))
+            {
+                out << "leagueoverseer_events_total{" << labels << ",event=\"" << eventTypeName(i) << "\"} " << eventsHandled[i].load(std::memory_order_relaxed) << "\n";
+            }
+        }
+
+        writeJobCounter(out, labels, "leagueoverseer_url_jobs_total", "Number of requests sent to the league website.", urlJobsSent);
+        writeJobCounter(out, labels, "leagueoverseer_url_jobs_completed_total", "Number of requests the league website answered.", urlJobsDone);
+        writeJobCounter(out, labels, "leagueoverseer_url_job_timeouts_total", "Number of requests to the league website that timed out.", urlJobTimeouts);
+        writeJobCounter(out, labels, "leagueoverseer_url_job_errors_total", "Number of requests to the league website that failed.", urlJobErrors);
+        writeJobCounter(out, labels, "leagueoverseer_url_jobs_shed_total", "Number of requests dropped because too many were already queued.", urlJobsShed);
+
+        out << "# HELP leagueoverseer_url_job_duration_seconds Time between queuing a request and receiving its response.\n";
+        out << "# TYPE leagueoverseer_url_job_duration_seconds histogram\n";
+
+        for (int i = 0; i < URL_JOB_TYPE_COUNT; i++)
+        {
+            urlJobLatency[i].write(out, "leagueoverseer_url_job_duration_seconds", labels + ",type=\"" + URL_JOB_NAMES[i] + "\"");
+        }
+
+        out << "# HELP leagueoverseer_url_job_queue_seconds Time a request waited in the plugin's queue before being sent.\n";
+        out << "# TYPE leagueoverseer_url_job_queue_seconds histogram\n";
+
+        for (int i = 0; i < URL_JOB_TYPE_COUNT; i++)
+        {
+            urlJobQueueWait[i].write(out, "leagueoverseer_url_job_queue_seconds", labels + ",type=\"" + URL_JOB_NAMES[i] + "\"");
+        }
+    }
+
+private:
+    static void writeJobCounter (std::ostream &out, const std::string &labels, const char *name, const char *help, const std::atomic<uint64_t> *counters)
+    {
+        out << "# HELP " << name << " " << help << "\n";
+        out << "# TYPE " << name << " counter\n";
+
+        for (int i = 0; i < URL_JOB_TYPE_COUNT; i++)
+        {
+            out << name << "{" << labels << ",type=\"" << URL_JOB_NAMES[i] << "\"} " << counters[i].load(std::memory_order_relaxed) << "\n";
+        }
+    }
+};
+
+// The team name of every league member we know about. Team names are stored once each in a dense table,
+// along with the motto each one makes, and members are kept in a flat open-addressing hash from their numeric
+// BZID to the index of their team, so the table costs a few bytes per member and a lookup is usually a single
+// probe. Team 0 is reserved for members we know don't belong to a team.
+class MottoTable
+{
+public:
+    MottoTable () :
+        used(0)
+    {
+        teams.push_back("");
+        mottos.push_back("");
+        teamIDs[""] = NO_TEAM;
+    }
+
+    void set (uint32_t bzID, const std::string &teamName)
+    {
+        // Keep the load factor at or below one half so probe sequences stay short
+        if ((used + 1) * 2 > slots.size())
+        {
+            grow();
+        }
+
+        Slot &slot = slots[probe(bzID)];
+
+        if (slot.team == EMPTY)
+        {
+            slot.bzID = bzID;
+            used++;
+        }
+
+        slot.team = intern(teamName);
+    }
+
+    // Get the team name of a BZID; NULL if we don't know anything about them and an empty string if we
+    // know they don't belong to a team
+    const std::string* lookup (uint32_t bzID) const
+    {
+        if (slots.empty())
+        {
+            return NULL;
+        }
+
+        const Slot &slot = slots[probe(bzID)];
+
+        return (slot.team == EMPTY) ? NULL : &teams[slot.team];
+    }
+
+    // The same as lookup() but with the team name already encoded as a motto, so a player joining costs us a
+    // probe and nothing else
+    const std::string* lookupMotto (uint32_t bzID) const
+    {
+        if (slots.empty())
+        {
+            return NULL;
+        }
+
+        const Slot &slot = slots[probe(bzID)];
+
+        return (slot.team == EMPTY) ? NULL : &mottos[slot.team];
+    }
+
+    // Make room for a number of members up front so building a table from a team dump never rehashes it
+    void reserve (size_t members)
+    {
+        size_t capacity = 1024;
+
+        while (capacity < members * 2)
+        {
+            capacity *= 2;
+        }
+
+        if (capacity > slots.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    // Call `visit` with the BZID and team ID of every member, in no particular order
+    template <typename Visitor>
+    void forEach (Visitor visit) const
+    {
+        for (auto &slot : slots)
+        {
+            if (slot.team != EMPTY)
+            {
+                visit(slot.bzID, slot.team);
+            }
+        }
+    }
+
+    const std::string& teamName (uint32_t teamID) const { return teams[teamID]; }
+
+    size_t size () const { return used; }
+    size_t teamCount () const { return teams.size(); }
+
+private:
+    static const uint32_t NO_TEAM = 0;
+    static const uint32_t EMPTY   = UINT32_MAX;
+
+    struct Slot
+    {
+        uint32_t bzID;
+        uint32_t team;
+    };
+
+    // Find the slot a BZID is in, or the empty slot it would go in
+    size_t probe (uint32_t bzID) const
+    {
+        size_t mask  = slots.size() - 1;
+        size_t index = (bzID * 2654435761u) & mask;
+
+        while (slots[index].team != EMPTY && slots[index].bzID != bzID)
+        {
+            index = (index + 1) & mask;
+        }
+
+        return index;
+    }
+
+    void grow ()
+    {
+        rehash(std::max((size_t)1024, slots.size() * 2));
+    }
+
+    void rehash (size_t capacity)
+    {
+        std::vector<Slot> previous;
+        previous.swap(slots);
+
+        Slot empty = { 0, EMPTY };
+        slots.assign(capacity, empty);
+
+        for (auto &slot : previous)
+        {
+            if (slot.team != EMPTY)
+            {
+                slots[probe(slot.bzID)] = slot;
+            }
+        }
+    }
+
+    uint32_t intern (const std::string &teamName)
+    {
+        std::unordered_map<std::string, uint32_t>::const_iterator it = teamIDs.find(teamName);
+
+        if (it != teamIDs.end())
+        {
+            return it->second;
+        }
+
+        uint32_t teamID = teams.size();
+
+        teams.push_back(teamName);
+        mottos.push_back(encodeMotto(teamName));
+        teamIDs[teamName] = teamID;
+
+        return teamID;
+    }
+
+    std::vector<std::string> teams;                      // Team names indexed by their ID
+    std::vector<std::string> mottos;                     // The same team names encoded as mottos
+    std::unordered_map<std::string, uint32_t> teamIDs;   // The ID of each team name, only used when adding members
+    std::vector<Slot> slots;
+    size_t used;
+};
+
+// A read-only table of team mottos that lives in a memory mapped file so that every bzfs instance
+// on a host can share a single copy of the team dump. Whichever instance refreshes first downloads
+// the dump and publishes it; every other instance maps the table read-only and reads from it.
+//
+// Layout: a header page, a sorted array of <BZID, name offset> entries, then the team names as NUL
+// terminated strings. Writers are serialized with flock() and publish with a seqlock so readers
+// never block and retry if they raced with a swap.
+class SharedMottoCache
+{
+public:
+    // The size of the shared segment; room for a few hundred thousand league members
+    static const size_t SEGMENT_SIZE = 4 * 1024 * 1024;
+
+    SharedMottoCache () :
+        fd(-1),
+        header(NULL),
+        segment(NULL)
+    {}
+
+    ~SharedMottoCache ()
+    {
+        close();
+    }
+
+    bool open (const std::string &path)
+    {
+#ifndef _WIN32
+        close();
+
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        // Only the first instance to get here will initialize the file; ftruncate() zero fills
+        flock(fd, LOCK_EX);
+
+        struct stat fileInfo;
+
+        if (fstat(fd, &fileInfo) != 0 || ((size_t)fileInfo.st_size < SEGMENT_SIZE && ftruncate(fd, SEGMENT_SIZE) != 0))
+        {
+            flock(fd, LOCK_UN);
+            close();
+
+            return false;
+        }
+
+        // The header is writable so instances can claim a refresh, the rest of the table is read-only
+        void *headerMap  = mmap(NULL, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        void *segmentMap = mmap(NULL, SEGMENT_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (headerMap == MAP_FAILED || segmentMap == MAP_FAILED)
+        {
+            if (headerMap != MAP_FAILED)
+            {
+                munmap(headerMap, sizeof(Header));
+            }
+
+            if (segmentMap != MAP_FAILED)
+            {
+                munmap(segmentMap, SEGMENT_SIZE);
+            }
+
+            flock(fd, LOCK_UN);
+            close();
+
+            return false;
+        }
+
+        header  = (Header*)headerMap;
+        segment = (const char*)segmentMap;
+
+        if (header->magic != MAGIC)
+        {
+            memset((void*)header, 0, sizeof(Header));
+            header->magic = MAGIC;
+        }
+
+        flock(fd, LOCK_UN);
+
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    void close ()
+    {
+#ifndef _WIN32
+        if (header)
+        {
+            munmap((void*)header, sizeof(Header));
+        }
+
+        if (segment)
+        {
+            munmap((void*)segment, SEGMENT_SIZE);
+        }
+
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+#endif
+
+        fd = -1;
+        header = NULL;
+        segment = NULL;
+    }
+
+    bool isOpen () const
+    {
+        return (header != NULL);
+    }
+
+    // The number of times a table has been published; 0 if nobody has published one yet
+    uint64_t generation () const
+    {
+        return (header) ? header->generation.load(std::memory_order_acquire) : 0;
+    }
+
+    // The UNIX timestamp of when the current table was published
+    int64_t publishedAt () const
+    {
+        return (header) ? header->publishedAt.load(std::memory_order_acquire) : 0;
+    }
+
+    uint32_t size () const
+    {
+        return (header) ? header->entryCount.load(std::memory_order_acquire) : 0;
+    }
+
+    // Try to become the instance that downloads and publishes the next table. A claim that was not
+    // followed by a publish within 'timeout' seconds is considered abandoned and can be taken over
+    bool claimRefresh (int64_t now, int64_t timeout)
+    {
+        if (!header)
+        {
+            return false;
+        }
+
+        int64_t claimed = header->refreshClaimed.load(std::memory_order_acquire);
+
+        if (claimed != 0 && now - claimed < timeout && claimed > header->publishedAt.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        return header->refreshClaimed.compare_exchange_strong(claimed, now, std::memory_order_acq_rel);
+    }
+
+    // Look up the team name of a BZID. Returns false if the BZID is not in the table
+    bool lookup (const std::string &bzID, std::string &teamName) const
+    {
+        uint32_t key;
+
+        if (!header || !parseBZID(bzID, key))
+        {
+            return false;
+        }
+
+        for (int attempt = 0; attempt < 16; attempt++)
+        {
+            uint32_t sequence = header->sequence.load(std::memory_order_acquire);
+
+            // A writer is in the middle of publishing a new table
+            if (sequence & 1)
+            {
+                continue;
+            }
+
+            uint32_t entryCount = std::min(header->entryCount.load(std::memory_order_relaxed), (uint32_t)MAX_ENTRIES);
+            const Entry *entries = (const Entry*)(segment + ENTRIES_OFFSET);
+
+            bool found = false;
+            teamName.clear();
+
+            // Binary search through the sorted entries
+            uint32_t low = 0, high = entryCount;
+
+            while (low < high)
+            {
+                uint32_t middle = low + (high - low) / 2;
+
+                if (entries[middle].bzID < key)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+
+            if (low < entryCount && entries[low].bzID == key)
+            {
+                // Bound everything we read by the segment size since a racing writer could leave us
+                // looking at garbage until we notice the sequence changed
+                size_t nameOffset = entries[low].nameOffset;
+
+                if (nameOffset < SEGMENT_SIZE)
+                {
+                    const char *name = segment + nameOffset;
+                    size_t length = 0;
+
+                    while (nameOffset + length < SEGMENT_SIZE && name[length] != '\0')
+                    {
+                        length++;
+                    }
+
+                    teamName.assign(name, length);
+                    found = true;
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (header->sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                return found;
+            }
+        }
+
+        return false;
+    }
+
+    // Publish a team dump for every instance to use. Returns false if the table could not be
+    // written, in which case the caller should keep its own copy
+    bool publish (const MottoTable &mottos, int64_t now)
+    {
+#ifndef _WIN32
+        if (!header)
+        {
+            return false;
+        }
+
+        // Build the table in private memory first so the time spent with the seqlock held is a memcpy
+        std::vector<Entry> entries;
+        std::string names;
+        std::vector<uint32_t> nameOffsets(mottos.teamCount(), UINT32_MAX);
+
+        entries.reserve(mottos.size());
+
+        mottos.forEach([&](uint32_t bzID, uint32_t teamID)
+        {
+            const std::string &teamName = mottos.teamName(teamID);
+
+            if (teamName.empty())
+            {
+                return;
+            }
+
+            if (nameOffsets[teamID] == UINT32_MAX)
+            {
+                nameOffsets[teamID] = NAMES_OFFSET + names.size();
+                names.append(teamName.c_str(), teamName.size() + 1);
+            }
+
+            Entry entry;
+            entry.bzID       = bzID;
+            entry.nameOffset = nameOffsets[teamID];
+            entries.push_back(entry);
+        });
+
+        if (entries.size() > MAX_ENTRIES || NAMES_OFFSET + names.size() > SEGMENT_SIZE)
+        {
+            return false;
+        }
+
+        // Readers search the BZIDs with a binary search
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.bzID < b.bzID; });
+
+        void *writable = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (writable == MAP_FAILED)
+        {
+            return false;
+        }
+
+        flock(fd, LOCK_EX);
+
+        header->sequence.fetch_add(1, std::memory_order_acq_rel);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        memcpy((char*)writable + ENTRIES_OFFSET, entries.data(), entries.size() * sizeof(Entry));
+        memcpy((char*)writable + NAMES_OFFSET, names.data(), names.size());
+        header->entryCount.store(entries.size(), std::memory_order_relaxed);
+
+        header->sequence.fetch_add(1, std::memory_order_release);
+        header->publishedAt.store(now, std::memory_order_release);
+        header->generation.fetch_add(1, std::memory_order_acq_rel);
+
+        flock(fd, LOCK_UN);
+        munmap(writable, SEGMENT_SIZE);
+
+        return true;
+#else
+        (void)mottos;
+        (void)now;
+        return false;
+#endif
+    }
+
+private:
+    static const uint32_t MAGIC = 0x4c4f4d31; // "LOM1"
+
+    struct Header
+    {
+        uint32_t              magic;
+        std::atomic<uint32_t> sequence;       // Odd while a writer is publishing a table
+        std::atomic<uint32_t> entryCount;
+        std::atomic<uint64_t> generation;     // Bumped after every publish
+        std::atomic<int64_t>  publishedAt;    // When the current table was published
+        std::atomic<int64_t>  refreshClaimed; // When an instance last claimed the next refresh
+    };
+
+    struct Entry
+    {
+        uint32_t bzID;
+        uint32_t nameOffset; // Offset from the start of the segment
+    };
+
+    static const size_t ENTRIES_OFFSET = 4096;
+    static const size_t MAX_ENTRIES    = 262144;
+    static const size_t NAMES_OFFSET   = ENTRIES_OFFSET + MAX_ENTRIES * sizeof(Entry);
+
+    int         fd;
+    Header     *header;
+    const char *segment;
+};
+
+// The answers the league website gave us when we asked for the team of a single player. Players with a
+// team and players without one expire after separate amounts of time, and once the cache is full the
+// least recently used answer is thrown out so servers that see a lot of different players don't grow
+// forever. Players without a team are remembered as an empty team name.
+class MottoCache
+{
+public:
+    MottoCache () :
+        capacity(4096)
+    {}
+
+    void setCapacity (size_t _capacity)
+    {
+        capacity = std::max((size_t)1, _capacity);
+        trim();
+    }
+
+    void store (uint32_t bzID, const std::string &teamName, double expires)
+    {
+        std::unordered_map<uint32_t, std::list<Entry>::iterator>::iterator it = index.find(bzID);
+
+        if (it != index.end())
+        {
+            entries.erase(it->second);
+        }
+
+        Entry entry = { bzID, expires, teamName };
+        entries.push_front(entry);
+        index[bzID] = entries.begin();
+
+        trim();
+    }
+
+    // Get the team name we have for a BZID; NULL if we don't have one or it's expired
+    const std::string* lookup (uint32_t bzID, double now)
+    {
+        std::unordered_map<uint32_t, std::list<Entry>::iterator>::iterator it = index.find(bzID);
+
+        if (it == index.end())
+        {
+            return NULL;
+        }
+
+        if (it->second->expires <= now)
+        {
+            entries.erase(it->second);
+            index.erase(it);
+
+            return NULL;
+        }
+
+        // Move the entry to the front so it's the last to be evicted
+        entries.splice(entries.begin(), entries, it->second);
+
+        return &it->second->teamName;
+    }
+
+    void clear ()
+    {
+        entries.clear();
+        index.clear();
+    }
+
+    size_t size () const { return index.size(); }
+
+private:
+    struct Entry
+    {
+        uint32_t    bzID;
+        double      expires;
+        std::string teamName;
+    };
+
+    void trim ()
+    {
+        while (index.size() > capacity)
+        {
+            index.erase(entries.back().bzID);
+            entries.pop_back();
+        }
+    }
+
+    size_t capacity;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<uint32_t, std::list<Entry>::iterator> index;
+};
+
+// A monotonic arena for the memory of a match's roster nodes and heatmap. Allocations are bumped out of
+// fixed-size blocks and never freed on their own; the whole arena is released at once when the match is
+// destroyed. Released blocks are kept on a spare list for the next match so a server that has been up for
+// months doesn't keep growing its heap one roster at a time. Only the main thread may use an arena.
+//
+// The arena only owns raw memory. Whatever lives in it is still destroyed the usual way, so strings and
+// vectors inside those objects free their own heap memory when the match is destroyed.
+class MatchArena
+{
+public:
+    static const size_t BLOCK_SIZE       = 16 * 1024;
+    static const size_t MAX_SPARE_BLOCKS = 16;
+
+    MatchArena () :
+        offset(0),
+        bytesUsed(0)
+    {}
+
+    ~MatchArena ()
+    {
+        reset();
+    }
+
+    void* allocate (size_t bytes, size_t alignment)
+    {
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+
+        if (blocks.empty() || start + bytes > blocks.back().size)
+        {
+            addBlock(bytes + alignment);
+            start = (offset + alignment - 1) & ~(alignment - 1);
+        }
+
+        offset = start + bytes;
+        bytesUsed += bytes;
+
+        return blocks.back().data.get() + start;
+    }
+
+    // Give every block back to the spare list; anything allocated from this arena is gone after this
+    void reset ()
+    {
+        std::vector<Block> &spares = spareBlocks();
+
+        for (auto &block : blocks)
+        {
+            if (block.size == BLOCK_SIZE && spares.size() < MAX_SPARE_BLOCKS)
+            {
+                spares.push_back(std::move(block));
+            }
+        }
+
+        blocks.clear();
+        offset = 0;
+        bytesUsed = 0;
+    }
+
+    size_t used () const { return bytesUsed; }
+    size_t capacity () const
+    {
+        size_t total = 0;
+
+        for (auto &block : blocks)
+        {
+            total += block.size;
+        }
+
+        return total;
+    }
+
+private:
+    MatchArena (const MatchArena&);
+    MatchArena& operator= (const MatchArena&);
+
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    static std::vector<Block>& spareBlocks ()
+    {
+        static std::vector<Block> spares;
+        return spares;
+    }
+
+    void addBlock (size_t minimumSize)
+    {
+        std::vector<Block> &spares = spareBlocks();
+        Block block;
+
+        // Anything too big for a regular block gets one of its own, which isn't kept around afterwards
+        if (minimumSize > BLOCK_SIZE)
+        {
+            block.data.reset(new char[minimumSize]);
+            block.size = minimumSize;
+        }
+        else if (!spares.empty())
+        {
+            block = std::move(spares.back());
+            spares.pop_back();
+        }
+        else
+        {
+            block.data.reset(new char[BLOCK_SIZE]);
+            block.size = BLOCK_SIZE;
+        }
+
+        blocks.push_back(std::move(block));
+        offset = 0;
+    }
+
+    std::vector<Block> blocks;
+    size_t offset,    // Where the next allocation starts in the last block
+           bytesUsed;
+};
+
+// An allocator for standard containers that takes its memory from a MatchArena. Deallocating does nothing;
+// the memory comes back when the arena is reset
+template <typename T>
+struct ArenaAllocator
+{
+    typedef T value_type;
+
+    explicit ArenaAllocator (MatchArena *_arena) : arena(_arena) {}
+
+    template <typename U>
+    ArenaAllocator (const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T* allocate (size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate (T*, size_t) {}
+
+    MatchArena *arena;
+};
+
+template <typename T, typename U>
+bool operator== (const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+
+template <typename T, typename U>
+bool operator!= (const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+// Counts where players died and spawned during a match on a grid laid over the world. The grid comes out of
+// the match's arena when the match starts, so counting an event is a single increment with no allocation.
+// Counters stop at their maximum instead of wrapping around
+class MatchHeatmap
+{
+public:
+    enum Layer
+    {
+        eDeaths = 0,
+        eSpawns,
+        LAYER_COUNT
+    };
+
+    static const int MAX_COLUMNS = 256;
+
+    MatchHeatmap () :
+        cells(NULL),
+        columns(0),
+        worldSize(0),
+        cellSize(0)
+    {}
+
+    // Lay a grid of cells over a square world centered on the origin. Cells are made bigger than asked for
+    // if there would otherwise be more than MAX_COLUMNS of them across
+    void init (MatchArena &arena, double _worldSize, double _cellSize)
+    {
+        if (_worldSize <= 0 || _cellSize <= 0)
+        {
+            return;
+        }
+
+        worldSize = _worldSize;
+        cellSize  = std::max(_cellSize, worldSize / MAX_COLUMNS);
+        columns   = std::max(1, (int)ceil(worldSize / cellSize));
+
+        size_t bytes = (size_t)columns * columns * LAYER_COUNT * sizeof(uint16_t);
+
+        cells = static_cast<uint16_t*>(arena.allocate(bytes, alignof(uint16_t)));
+        memset(cells, 0, bytes);
+    }
+
+    bool isEnabled () const { return cells != NULL; }
+
+    void add (Layer layer, const float *pos)
+    {
+        if (!cells)
+        {
+            return;
+        }
+
+        int column = std::min(columns - 1, std::max(0, (int)((pos[0] + worldSize / 2) / cellSize)));
+        int row    = std::min(columns - 1, std::max(0, (int)((pos[1] + worldSize / 2) / cellSize)));
+
+        uint16_t &counter = cells[((size_t)row * columns + column) * LAYER_COUNT + layer];
+
+        if (counter < UINT16_MAX)
+        {
+            counter++;
+        }
+    }
+
+    // Write out every cell that saw anything as a line of text, one cell per line, so the heatmap can be
+    // drawn with nothing fancier than a spreadsheet or a short script
+    std::string format (const std::string &mapName) const
+    {
+        std::ostringstream out;
+
+        out << "# League Overseer heatmap" << (mapName.empty() ? "" : " of ") << mapName << "\n";
+        out << "# world size " << worldSize << ", cell size " << cellSize << ", " << columns << "x" << columns << " cells\n";
+        out << "# x and y are the bottom left corner of a cell in world coordinates; empty cells are left out\n";
+        out << "# x y deaths spawns\n";
+
+        for (int row = 0; cells && row < columns; row++)
+        {
+            for (int column = 0; column < columns; column++)
+            {
+                const uint16_t *cell = &cells[((size_t)row * columns + column) * LAYER_COUNT];
+
+                if (cell[eDeaths] || cell[eSpawns])
+                {
+                    out << (column * cellSize - worldSize / 2) << " " << (row * cellSize - worldSize / 2) << " "
+                        << cell[eDeaths] << " " << cell[eSpawns] << "\n";
+                }
+            }
+        }
+
+        return out.str();
+    }
+
+private:
+    uint16_t *cells;     // LAYER_COUNT counters per cell, row by row starting at the world's bottom left corner
+    int       columns;   // The number of cells across the world in each direction
+    double    worldSize,
+              cellSize;
+};
+
+// The contents of a response to a teamDump or teamNameQuery request
+struct MottoResponse
+{
+    MottoResponse () :
+        valid(false),
+        published(false),
+        keepMottos(false),
+        dumpedMembers(0)
+    {}
+
+    std::string data;                                 // The raw response from the league website
+    bool        valid,                                // Whether or not the response was a JSON object
+                published,                            // Whether or not the team dump was published to the shared cache
+                keepMottos;                           // Whether or not to fill dumpedMottos, which is only needed to log them
+    std::map<std::string, std::string> dumpedMottos; // <BZID, Team Name> of every member in a team dump when keepMottos is set
+    std::shared_ptr<const MottoTable> dumpedTable;    // The team dump as a table ready to replace ours; NULL if it was published
+    size_t      dumpedMembers;                        // The number of members in the team dump
+    std::string bzID,                                 // The player a team name query was about and their team
+                teamName;
+};
+
+// The number of BZIDs in the "members" of every team in a team dump
+static size_t countDumpedMembers (array_list* teams)
+{
+    size_t members = 0;
+
+    for (size_t i = 0; i < array_list_length(teams); i++)
+    {
+        json_object* team = (json_object*)array_list_get_idx(teams, i);
+
+        if (!team || json_object_get_type(team) != json_type_object)
+        {
+            continue;
+        }
+
+        json_object_object_foreach(team, key, value)
+        {
+            if (strcmp(key, "members") == 0 && json_object_get_type(value) == json_type_string)
+            {
+                const char* bzIDs = json_object_get_string(value);
+                members++;
+
+                for (const char* comma = strchr(bzIDs, ','); comma; comma = strchr(comma + 1, ','))
+                {
+                    members++;
+                }
+            }
+        }
+    }
+
+    return members;
+}
+
+// Read a JSON response to one of our team name requests. This runs on the worker thread so it must not call
+// into bzfs, not even to log anything
+static void parseMottoResponse (MottoResponse &response)
+{
+    json_object* jobj = json_tokener_parse(response.data.c_str());
+
+    if (!jobj || json_object_get_type(jobj) != json_type_object)
+    {
+        if (jobj)
+        {
+            json_object_put(jobj);
+        }
+
+        return;
+    }
+
+    response.valid = true;
+
+    std::shared_ptr<MottoTable> table;
+
+    // Because our JSON information has a BZID and a team name, we need to loop through them to get the information
+    json_object_object_foreach(jobj, key, val)
+    {
+        // There are multiple JSON types so let's switch through them
+        switch (json_object_get_type(val))
+        {
+            // We're getting an array meaning it's an entire team dump, so handle it accordingly
+            case json_type_array:
+            {
+                // Our array will have multiple indexes with each index containing two elements
+                // so we need to create an array_list that will give us access to all of the indexes
+                array_list* teamMembers = json_object_get_array(val);
+
+                // Count the members first so the table is sized once and never rehashed while it's filled
+                if (!table)
+                {
+                    table = std::make_shared<MottoTable>();
+                }
+
+                table->reserve(table->size() + countDumpedMembers(teamMembers));
+
+                // Loop through of the indexes in our array
+                for (int i = 0; i < array_list_length(teamMembers); i++)
+                {
+                    // Now we need to create a JSON object so we can access the two values that the index
+                    // holds, i.e. the team name and BZIDs of the members
+                    json_object* individualTeam = (json_object*)array_list_get_idx(teamMembers, i);
+
+                    if (!individualTeam || json_object_get_type(individualTeam) != json_type_object)
+                    {
+                        continue;
+                    }
+
+                    // We will be storing the team name out here so we can access it as we're looping through
+                    // all of the team members
+                    std::string teamName;
+
+                    // Now we need to loop through both those elements in the current index
+                    json_object_object_foreach(individualTeam, _key, _value)
+                    {
+                        // Just in case there's something funky, only handle strings at this point
+                        if (json_object_get_type(_value) == json_type_string)
+                        {
+                            // Our first key is the team name so save it
+                            if (strcmp(_key, "team") == 0)
+                            {
+                                teamName = json_object_get_string(_value);
+                            }
+                            // Our second key is going to be the team members' BZIDs seperated by commas
+                            else if (strcmp(_key, "members") == 0)
+                            {
+                                // Now we need to handle each BZID separately, so go through them one comma at a
+                                // time and put each member straight into the table
+                                const char* members = json_object_get_string(_value);
+                                std::string bzID;
+
+                                while (true)
+                                {
+                                    const char* comma = strchr(members, ',');
+                                    bzID.assign(members, (comma) ? comma - members : strlen(members));
+
+                                    uint32_t key;
+
+                                    if (parseBZID(bzID, key))
+                                    {
+                                        table->set(key, teamName);
+                                    }
+
+                                    if (response.keepMottos)
+                                    {
+                                        response.dumpedMottos[bzID] = teamName;
+                                    }
+
+                                    response.dumpedMembers++;
+
+                                    if (!comma)
+                                    {
+                                        break;
+                                    }
+
+                                    members = comma + 1;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            break;
+
+            // We've found a JSON string, which means it's only a single team name and bzid so handle it accordingly
+            case json_type_string:
+            {
+                // Store the respective information in other variables because we aren't done looping
+                if (strcmp(key, "bzid") == 0)
+                {
+                    response.bzID = json_object_get_string(val);
+                }
+                else if (strcmp(key, "team") == 0)
+                {
+                    response.teamName = json_object_get_string(val);
+                }
+            }
+            break;
+
+            default: break;
+        }
+    }
+
+    json_object_put(jobj);
+
+    if (table && response.dumpedMembers > 0)
+    {
+        response.dumpedTable = table;
+    }
+}
+
+// What became of a match once it was over, as far as the league website is concerned
+enum MatchReportStatus
+{
+    eReportPending = 0, // The report was handed to the league website and we're waiting to hear back
+    eReportSent,        // The league website answered the report
+    eReportFailed,      // The report timed out or could not be sent
+    eReportCanceled,    // The match was canceled so it was never reported
+    eReportSkipped,     // The match was not reported because reports are disabled or nobody qualified
+    REPORT_STATUS_COUNT
+};
+
+static const char* REPORT_STATUS_NAMES[REPORT_STATUS_COUNT] = { "pending", "reported", "failed", "canceled", "not reported" };
+
+// A file that records are only ever appended to, shared by the match history and the replay catalog. The file
+// starts with a magic number and the version of its layout, and each record after that is a type and a length
+// followed by its payload.
+//
+// Records are appended whole, so the only damage a crash can do is cut the last one short; that record is
+// dropped when the file is loaded so whatever is appended next isn't glued onto it. A record whose payload
+// can't be read is skipped since its length still leads to the next one. A length that makes no sense means
+// the framing itself is lost: the records before it are loaded but nothing is ever appended to the file again
+// until someone repairs it, so nothing in it is destroyed.
+class RecordFile
+{
+public:
+    typedef std::function<bool (uint8_t type, const std::string &payload)> RecordReader;
+
+    RecordFile (uint32_t _magic, uint16_t _version) :
+        magic(_magic),
+        version(_version),
+        damaged(false),
+        skipped(0)
+    {}
+
+    // Load the file at a path, handing every record to `reader`, or create the file if it doesn't exist. Returns
+    // false if the file belongs to something else or can't be read, created or have a partial record dropped
+    bool open (const std::string &_path, const RecordReader &reader)
+    {
+        close();
+
+        std::string header = buildHeader();
+
+        struct stat fileInfo;
+
+        if (stat(_path.c_str(), &fileInfo) != 0)
+        {
+            // Only start a new file when there is none; one we merely can't get at right now may still hold records
+            if (errno != ENOENT || !writeFileAtomically(_path, header))
+            {
+                return false;
+            }
+
+            path = _path;
+            return true;
+        }
+
+        std::string contents;
+
+        if (!readFile(_path, contents))
+        {
+            return false;
+        }
+
+        if (contents.size() < header.size())
+        {
+            // The server went down while the file was being created
+            if (header.compare(0, contents.size(), contents) != 0 || !writeFileAtomically(_path, header))
+            {
+                return false;
+            }
+
+            path = _path;
+            return true;
+        }
+
+        if (contents.compare(0, header.size(), header) != 0)
+        {
+            return false;
+        }
+
+        size_t position = header.size();
+
+        while (position + RECORD_HEADER_SIZE <= contents.size())
+        {
+            uint8_t  type;
+            uint32_t length;
+
+            memcpy(&type, contents.data() + position, sizeof(type));
+            memcpy(&length, contents.data() + position + sizeof(type), sizeof(length));
+
+            if (length > MAX_RECORD_LENGTH)
+            {
+                damaged = true;
+                break;
+            }
+
+            if (position + RECORD_HEADER_SIZE + length > contents.size())
+            {
+                break;
+            }
+
+            if (!reader(type, contents.substr(position + RECORD_HEADER_SIZE, length)))
+            {
+                skipped++;
+            }
+
+            position += RECORD_HEADER_SIZE + length;
+        }
+
+        // Drop a record cut short at the end of the file
+        if (!damaged && position < contents.size() && !writeFileAtomically(_path, contents.substr(0, position)))
+        {
+            return false;
+        }
+
+        path = _path;
+        return true;
+    }
+
+    void close ()
+    {
+        path.clear();
+        damaged = false;
+        skipped = 0;
+    }
+
+    bool isOpen () const { return !path.empty(); }
+
+    // Whether records may be appended to the file; false once its framing has been found to be lost
+    bool isWritable () const { return isOpen() && !damaged; }
+
+    const std::string& getPath () const { return path; }
+
+    // The number of records skipped when the file was loaded because their payload couldn't be read
+    size_t getSkipped () const { return skipped; }
+
+    // The start of every file of this kind, to write a new one with
+    std::string buildHeader () const
+    {
+        BinaryWriter writer;
+
+        writer.write(magic);
+        writer.write(version);
+
+        return writer.buffer;
+    }
+
+    static std::string buildRecord (uint8_t type, const std::string &payload)
+    {
+        BinaryWriter writer;
+
+        writer.write<uint8_t>(type);
+        writer.write<uint32_t>(payload.size());
+        writer.buffer += payload;
+
+        return writer.buffer;
+    }
+
+private:
+    static const size_t RECORD_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+
+    // No record we write comes anywhere near this, so a longer one can only be garbage
+    static const uint32_t MAX_RECORD_LENGTH = 1024 * 1024;
+
+    uint32_t    magic;
+    uint16_t    version;
+    std::string path;
+    bool        damaged;
+    size_t      skipped;
+};
+
+// Identifies a match history file and the version of its layout
+const uint32_t MATCH_HISTORY_MAGIC = 0x4c4f4d48; // "LOMH"
+const uint16_t MATCH_HISTORY_VERSION = 1;
+
+// Every match this server has finished, kept in a file that is only ever appended to so the history survives
+// restarts and doesn't depend on the league website being up. It's a RecordFile where a match record describes
+// a finished match and a status record changes the report status of an earlier one. Match IDs only ever go up
+// but may skip a few where a record never made it to the disk. The whole file is loaded into
+// memory along with an index of the matches each BZID played in, so looking up a player never touches the
+// disk. The records are built here but written by the caller, which is expected to do it off the main thread.
+//
+// Every player also gets an Elo style rating out of the matches they were counted in, updated as each match
+// is added so the team balancer can look it up as players join.
+class MatchHistory
+{
+public:
+    struct Player
+    {
+        std::string bzID,
+                    callsign;
+        int32_t     team;     // The team the player was loyal to
+        float       playTime; // The estimated seconds the player played
+        bool        counted;  // Whether the player was included in the match report
+    };
+
+    struct Match
+    {
+        uint32_t    id;
+        int64_t     finishedAt;
+        bool        official;
+        uint8_t     status;
+        int32_t     teamOneColor,
+                    teamTwoColor,
+                    teamOnePoints,
+                    teamTwoPoints,
+                    duration;      // The length of the match in seconds
+        std::string teamOneName,
+                    teamTwoName,
+                    mapName,
+                    replayFile;
+        std::vector<Player> players;
+    };
+
+    MatchHistory () :
+        file(MATCH_HISTORY_MAGIC, MATCH_HISTORY_VERSION)
+    {}
+
+    // Load the history stored at a path, creating the file if it doesn't exist yet. Returns false if the
+    // file belongs to something else or can't be read or created, in which case the history stays closed.
+    bool open (const std::string &_path)
+    {
+        close();
+
+        if (!file.open(_path, [this](uint8_t type, const std::string &payload) { return readRecord(type, payload); }))
+        {
+            clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close ()
+    {
+        file.close();
+        clear();
+    }
+
+    bool isOpen () const { return file.isOpen(); }
+
+    // Whether new records may be appended to the file; see RecordFile
+    bool isWritable () const { return file.isWritable(); }
+
+    const std::string& getPath () const { return file.getPath(); }
+
+    // The number of records that couldn't be read when the history was loaded
+    size_t getSkipped () const { return file.getSkipped(); }
+
+    // Add a finished match to the history and get the record to append to the file. The match's ID is assigned here
+    std::string add (Match &match)
+    {
+        match.id = (matches.empty()) ? 1 : matches.back().id + 1;
+
+        BinaryWriter writer;
+
+        writer.write(match.id);
+        writer.write(match.finishedAt);
+        writer.write<uint8_t>(match.official);
+        writer.write(match.status);
+        writer.write(match.teamOneColor);
+        writer.write(match.teamTwoColor);
+        writer.write(match.teamOnePoints);
+        writer.write(match.teamTwoPoints);
+        writer.write(match.duration);
+        writer.writeString(match.teamOneName);
+        writer.writeString(match.teamTwoName);
+        writer.writeString(match.mapName);
+        writer.writeString(match.replayFile);
+        writer.write<uint16_t>(std::min(match.players.size(), (size_t)UINT16_MAX));
+
+        for (size_t i = 0; i < match.players.size() && i < UINT16_MAX; i++)
+        {
+            const Player &player = match.players[i];
+
+            writer.writeString(player.bzID);
+            writer.writeString(player.callsign);
+            writer.write(player.team);
+            writer.write(player.playTime);
+            writer.write<uint8_t>(player.counted);
+        }
+
+        index(match, matches.size());
+        matches.push_back(match);
+
+        return RecordFile::buildRecord(eMatchRecord, writer.buffer);
+    }
+
+    // Change the report status of a match and get the record to append to the file
+    std::string setStatus (uint32_t id, MatchReportStatus status)
+    {
+        Match *match = find(id);
+
+        if (match == NULL)
+        {
+            return "";
+        }
+
+        match->status = status;
+
+        BinaryWriter writer;
+        writer.write(id);
+        writer.write<uint8_t>(status);
+
+        return RecordFile::buildRecord(eStatusRecord, writer.buffer);
+    }
+
+    // The most recently finished match; NULL if there isn't one
+    const Match* last () const
+    {
+        return (matches.empty()) ? NULL : &matches.back();
+    }
+
+    // Get up to `limit` of the most recent matches a BZID played in, newest first
+    std::vector<const Match*> findPlayer (const std::string &bzID, size_t limit) const
+    {
+        std::vector<const Match*> found;
+        uint32_t key;
+
+        if (!parseBZID(bzID, key))
+        {
+            return found;
+        }
+
+        std::unordered_map<uint32_t, std::vector<uint32_t> >::const_iterator it = playerIndex.find(key);
+
+        if (it != playerIndex.end())
+        {
+            for (std::vector<uint32_t>::const_reverse_iterator match = it->second.rbegin(); match != it->second.rend() && found.size() < limit; ++match)
+            {
+                found.push_back(&matches[*match]);
+            }
+        }
+
+        return found;
+    }
+
+    // Get the BZID of the last player to play a match under a callsign, ignoring case; empty if nobody has
+    std::string findCallsign (const std::string &callsign) const
+    {
+        std::unordered_map<std::string, std::string>::const_iterator it = callsignIndex.find(makelower(callsign));
+
+        return (it != callsignIndex.end()) ? it->second : "";
+    }
+
+    // The rating of a player; players who have never been counted in a match get the starting rating
+    float getRating (const std::string &bzID) const
+    {
+        uint32_t key;
+        std::unordered_map<uint32_t, float>::const_iterator it = (parseBZID(bzID, key)) ? ratings.find(key) : ratings.end();
+
+        return (it != ratings.end()) ? it->second : INITIAL_RATING;
+    }
+
+    // The number of matches in the history
+    size_t size () const { return matches.size(); }
+
+    static const float INITIAL_RATING;
+
+private:
+    enum RecordType
+    {
+        eMatchRecord = 1,
+        eStatusRecord = 2
+    };
+
+    static const float RATING_FACTOR;
+
+    static std::string makelower (std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+        return str;
+    }
+
+    // Matches are kept in the order of their IDs, so a match is found with a binary search; NULL if there's no such match
+    Match* find (uint32_t id)
+    {
+        std::vector<Match>::iterator it = std::lower_bound(matches.begin(), matches.end(), id, [](const Match &match, uint32_t _id)
+        {
+            return match.id < _id;
+        });
+
+        return (it != matches.end() && it->id == id) ? &*it : NULL;
+    }
+
+    bool readRecord (uint8_t type, const std::string &payload)
+    {
+        BinaryReader reader(payload);
+
+        if (type == eStatusRecord)
+        {
+            uint32_t id     = reader.read<uint32_t>();
+            uint8_t  status = reader.read<uint8_t>();
+
+            if (!reader.good() || status >= REPORT_STATUS_COUNT)
+            {
+                return false;
+            }
+
+            // The record of the match itself may never have made it to the disk, which is harmless
+            Match *match = find(id);
+
+            if (match != NULL)
+            {
+                match->status = status;
+            }
+
+            return true;
+        }
+        else if (type != eMatchRecord)
+        {
+            // A record type from a newer version; skip it
+            return true;
+        }
+
+        Match match;
+
+        match.id            = reader.read<uint32_t>();
+        match.finishedAt    = reader.read<int64_t>();
+        match.official      = reader.read<uint8_t>() != 0;
+        match.status        = reader.read<uint8_t>();
+        match.teamOneColor  = reader.read<int32_t>();
+        match.teamTwoColor  = reader.read<int32_t>();
+        match.teamOnePoints = reader.read<int32_t>();
+        match.teamTwoPoints = reader.read<int32_t>();
+        match.duration      = reader.read<int32_t>();
+        match.teamOneName   = reader.readString();
+        match.teamTwoName   = reader.readString();
+        match.mapName       = reader.readString();
+        match.replayFile    = reader.readString();
+
+        uint16_t playerCount = reader.read<uint16_t>();
+
+        for (uint16_t i = 0; i < playerCount && reader.good(); i++)
+        {
+            Player player;
+
+            player.bzID     = reader.readString();
+            player.callsign = reader.readString();
+            player.team     = reader.read<int32_t>();
+            player.playTime = reader.read<float>();
+            player.counted  = reader.read<uint8_t>() != 0;
+
+            match.players.push_back(player);
+        }
+
+        if (!reader.good() || match.id == 0 || (!matches.empty() && match.id <= matches.back().id) || match.status >= REPORT_STATUS_COUNT)
+        {
+            return false;
+        }
+
+        index(match, matches.size());
+        matches.push_back(match);
+
+        return true;
+    }
+
+    void index (const Match &match, uint32_t position)
+    {
+        for (auto &player : match.players)
+        {
+            uint32_t key;
+
+            if (parseBZID(player.bzID, key))
+            {
+                playerIndex[key].push_back(position);
+            }
+
+            callsignIndex[makelower(player.callsign)] = player.bzID;
+        }
+
+        rate(match);
+    }
+
+    // Move the ratings of the players who were counted in a match by how much better or worse their team did
+    // than the average ratings of both teams predicted
+    void rate (const Match &match)
+    {
+        double total[2] = { 0, 0 };
+        int    count[2] = { 0, 0 };
+        uint32_t key;
+
+        if (match.status == eReportCanceled)
+        {
+            return;
+        }
+
+        for (auto &player : match.players)
+        {
+            int side = (player.team == match.teamOneColor) ? 0 : (player.team == match.teamTwoColor) ? 1 : -1;
+
+            if (player.counted && side >= 0 && parseBZID(player.bzID, key))
+            {
+                total[side] += getRating(player.bzID);
+                count[side]++;
+            }
+        }
+
+        if (count[0] == 0 || count[1] == 0)
+        {
+            return;
+        }
+
+        double expected = 1.0 / (1.0 + pow(10.0, (total[1] / count[1] - total[0] / count[0]) / 400.0));
+        double actual   = (match.teamOnePoints > match.teamTwoPoints) ? 1.0 : (match.teamOnePoints < match.teamTwoPoints) ? 0.0 : 0.5;
+        float  change   = (float)(RATING_FACTOR * (actual - expected));
+
+        for (auto &player : match.players)
+        {
+            int side = (player.team == match.teamOneColor) ? 0 : (player.team == match.teamTwoColor) ? 1 : -1;
+
+            if (player.counted && side >= 0 && parseBZID(player.bzID, key))
+            {
+                std::unordered_map<uint32_t, float>::iterator it = ratings.insert(std::make_pair(key, INITIAL_RATING)).first;
+                it->second += (side == 0) ? change : -change;
+            }
+        }
+    }
+
+    void clear ()
+    {
+        matches.clear();
+        playerIndex.clear();
+        callsignIndex.clear();
+        ratings.clear();
+    }
+
+    RecordFile file;
+    std::vector<Match> matches; // Oldest first, which is also in the order of their IDs
+    std::unordered_map<uint32_t, std::vector<uint32_t> > playerIndex;  // The positions of the matches each BZID played in
+    std::unordered_map<std::string, std::string> callsignIndex;         // The BZID that last played under each lowercase callsign
+    std::unordered_map<uint32_t, float> ratings;                        // The rating of each BZID that has been counted in a match
+};
+
+const float MatchHistory::INITIAL_RATING = 1500;
+const float MatchHistory::RATING_FACTOR = 24;
+
+// Keeps the teams even as players join and leave. The strength of a team is the sum of the ratings of the
+// players on it, updated as each player comes, goes or switches teams, so picking a team for a new player never
+// has to look at anyone else. bzfs doesn't tell plug-ins when a player switches teams, so a switch is noticed the
+// next time the player spawns. Only the main thread may use the balancer
+class TeamBalancer
+{
+public:
+    TeamBalancer ()
+    {
+        clear();
+    }
+
+    // Start keeping track of a player, or of their new team and rating if we already were
+    void add (int playerID, bz_eTeamType team, float rating)
+    {
+        if (playerID < 0 || playerID >= MAX_PLAYER_SLOTS)
+        {
+            return;
+        }
+
+        remove(playerID);
+
+        slotRating[playerID] = rating;
+        join(playerID, team);
+    }
+
+    // A player we're keeping track of is now on another team; they keep the rating they were added with
+    void move (int playerID, bz_eTeamType team)
+    {
+        if (playerID < 0 || playerID >= MAX_PLAYER_SLOTS || slotTeam[playerID] == eNoTeam || slotTeam[playerID] == team)
+        {
+            return;
+        }
+
+        leave(playerID);
+        join(playerID, team);
+    }
+
+    // A player we're keeping track of has a new rating
+    void rate (int playerID, float rating)
+    {
+        if (playerID < 0 || playerID >= MAX_PLAYER_SLOTS || slotTeam[playerID] == eNoTeam)
+        {
+            return;
+        }
+
+        bz_eTeamType team = slotTeam[playerID];
+
+        leave(playerID);
+        slotRating[playerID] = rating;
+        join(playerID, team);
+    }
+
+    void remove (int playerID)
+    {
+        if (playerID < 0 || playerID >= MAX_PLAYER_SLOTS || slotTeam[playerID] == eNoTeam)
+        {
+            return;
+        }
+
+        leave(playerID);
+    }
+
+    // Pick the team a new player should join: the one that leaves the teams closest in size and, when both
+    // choices are equally close, closest in strength. eNoTeam if neither team has room
+    bz_eTeamType pick (bz_eTeamType teamOne, bool teamOneHasRoom, bz_eTeamType teamTwo, bool teamTwoHasRoom, float rating) const
+    {
+        if (!teamOneHasRoom || !teamTwoHasRoom)
+        {
+            return (teamOneHasRoom) ? teamOne : (teamTwoHasRoom) ? teamTwo : eNoTeam;
+        }
+
+        int    sizeOne     = std::abs(size[teamOne] + 1 - size[teamTwo]),
+               sizeTwo     = std::abs(size[teamTwo] + 1 - size[teamOne]);
+        double strengthOne = std::fabs(strength[teamOne] + rating - strength[teamTwo]),
+               strengthTwo = std::fabs(strength[teamTwo] + rating - strength[teamOne]);
+
+        if (sizeOne != sizeTwo)
+        {
+            return (sizeOne < sizeTwo) ? teamOne : teamTwo;
+        }
+
+        return (strengthOne <= strengthTwo) ? teamOne : teamTwo;
+    }
+
+    double getStrength (bz_eTeamType team) const { return isPlayingTeam(team) ? strength[team] : 0; }
+
+    void clear ()
+    {
+        std::fill(slotTeam, slotTeam + MAX_PLAYER_SLOTS, eNoTeam);
+        std::fill(slotRating, slotRating + MAX_PLAYER_SLOTS, 0.0f);
+        std::fill(strength, strength + ePurpleTeam + 1, 0.0);
+        std::fill(size, size + ePurpleTeam + 1, 0);
+    }
+
+private:
+    void join (int playerID, bz_eTeamType team)
+    {
+        slotTeam[playerID] = team;
+
+        if (isPlayingTeam(team))
+        {
+            strength[team] += slotRating[playerID];
+            size[team]++;
+        }
+    }
+
+    void leave (int playerID)
+    {
+        bz_eTeamType team = slotTeam[playerID];
+
+        slotTeam[playerID] = eNoTeam;
+
+        // Start over from zero once a team is empty so rounding errors don't pile up over a long uptime
+        if (isPlayingTeam(team))
+        {
+            strength[team] = (--size[team] > 0) ? strength[team] - slotRating[playerID] : 0;
+        }
+    }
+
+    bz_eTeamType slotTeam[MAX_PLAYER_SLOTS];   // The team of the player in each slot, observers included; eNoTeam if the slot is empty
+    float        slotRating[MAX_PLAYER_SLOTS]; // The rating each player was added with
+    double       strength[ePurpleTeam + 1];    // The sum of the ratings of each team's players, indexed by team color
+    int          size[ePurpleTeam + 1];        // The number of players on each team, indexed by team color
+};
+
+// Identifies a replay catalog file and the version of its layout
+const uint32_t REPLAY_CATALOG_MAGIC = 0x4c4f5243; // "LORC"
+const uint16_t REPLAY_CATALOG_VERSION = 1;
+
+// Every replay in the server's recording directory, kept in a file so listing or pruning the replays never has to
+// scan the directory. Like the match history, it's a RecordFile where a replay record adds a replay. New replays are
+// appended, but pruning rewrites the whole file with only the replays that are left, so the file doesn't keep every
+// replay the server ever saved. Removal records dropping a replay are still read from files written before that.
+// The records are built here but written by the caller, which is expected to do it off the main thread along with
+// deleting the replays.
+class ReplayCatalog
+{
+public:
+    enum ReplayType
+    {
+        eUnknownReplay = 0, // Found in the recording directory when the catalog was created
+        eFunReplay,
+        eOfficialReplay,
+        REPLAY_TYPE_COUNT
+    };
+
+    struct Replay
+    {
+        std::string fileName;
+        uint64_t    size,
+                    hash;          // The 64-bit FNV-1a hash of the file's contents
+        int64_t     savedAt;
+        uint8_t     type;
+        int32_t     teamOneColor,
+                    teamTwoColor;
+        std::string teamOneName,
+                    teamTwoName;
+    };
+
+    ReplayCatalog () :
+        file(REPLAY_CATALOG_MAGIC, REPLAY_CATALOG_VERSION),
+        liveSize(0),
+        removed(0),
+        records(0)
+    {}
+
+    // Load the catalog stored at a path, creating the file if it doesn't exist yet. Returns false if the
+    // file belongs to something else or can't be read or created, in which case the catalog stays closed.
+    bool open (const std::string &_path)
+    {
+        close();
+
+        if (!file.open(_path, [this](uint8_t type, const std::string &payload) { return readRecord(type, payload); }))
+        {
+            clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close ()
+    {
+        file.close();
+        clear();
+    }
+
+    bool isOpen () const { return file.isOpen(); }
+
+    // Whether new records may be appended to the file; see RecordFile
+    bool isWritable () const { return file.isWritable(); }
+
+    const std::string& getPath () const { return file.getPath(); }
+
+    // The number of records that couldn't be read when the catalog was loaded
+    size_t getSkipped () const { return file.getSkipped(); }
+
+    bool contains (const std::string &fileName) const
+    {
+        return byName.count(fileName) > 0;
+    }
+
+    // Add a replay to the catalog and get the record to append to the file; empty if it's already in the catalog
+    std::string add (const Replay &replay)
+    {
+        if (contains(replay.fileName))
+        {
+            return "";
+        }
+
+        insert(replay);
+        records++;
+
+        return buildReplayRecord(replay);
+    }
+
+    // Drop a replay from the catalog. The file still lists it until it's replaced with rewrite()
+    bool remove (const std::string &fileName)
+    {
+        return erase(fileName);
+    }
+
+    // Whether the file holds records of replays that are no longer in the catalog, or of their removal
+    bool hasStaleRecords () const { return records > byName.size(); }
+
+    // Get the contents of a catalog file listing only the replays in the catalog, oldest first, to replace the
+    // file with. Records from a newer version are kept as they were
+    std::string rewrite ()
+    {
+        std::string contents = file.buildHeader() + foreignRecords;
+
+        for (auto &replay : replays)
+        {
+            if (!replay.fileName.empty())
+            {
+                contents += buildReplayRecord(replay);
+            }
+        }
+
+        records = byName.size();
+
+        return contents;
+    }
+
+    // Get the replays that have to go to bring the catalog within its budgets, oldest first. Replays older than
+    // their type's maximum age in seconds go first, then fun replays and then official ones until the rest fit
+    // in maxSize bytes. The most recent replay is never given up to make room. A budget of 0 is unlimited.
+    std::vector<std::string> findExpired (int64_t now, double maxAge, double officialMaxAge, uint64_t maxSize) const
+    {
+        std::vector<std::string> expired;
+        std::vector<const Replay*> kept[2];
+        uint64_t keptSize = 0;
+
+        for (auto &replay : replays)
+        {
+            if (replay.fileName.empty())
+            {
+                continue;
+            }
+
+            bool   official = (replay.type == eOfficialReplay);
+            double age      = (official) ? officialMaxAge : maxAge;
+
+            if (age > 0 && now - replay.savedAt > age)
+            {
+                expired.push_back(replay.fileName);
+            }
+            else
+            {
+                kept[official].push_back(&replay);
+                keptSize += replay.size;
+            }
+        }
+
+        const Replay *newest = NULL;
+
+        for (auto it = replays.rbegin(); it != replays.rend() && newest == NULL; ++it)
+        {
+            if (!it->fileName.empty())
+            {
+                newest = &*it;
+            }
+        }
+
+        for (int official = 0; official < 2 && maxSize > 0; official++)
+        {
+            for (size_t i = 0; i < kept[official].size() && keptSize > maxSize; i++)
+            {
+                if (kept[official][i] != newest)
+                {
+                    expired.push_back(kept[official][i]->fileName);
+                    keptSize -= kept[official][i]->size;
+                }
+            }
+        }
+
+        return expired;
+    }
+
+    // Get up to `limit` of the most recent replays, newest first, optionally only those of a single type
+    std::vector<const Replay*> list (size_t limit, int type = -1) const
+    {
+        std::vector<const Replay*> found;
+
+        for (auto it = replays.rbegin(); it != replays.rend() && found.size() < limit; ++it)
+        {
+            if (!it->fileName.empty() && (type < 0 || it->type == type))
+            {
+                found.push_back(&*it);
+            }
+        }
+
+        return found;
+    }
+
+    // The number of replays in the catalog and their combined size in bytes
+    size_t   size ()      const { return byName.size(); }
+    uint64_t totalSize () const { return liveSize; }
+
+    static const char* TYPE_NAMES[REPLAY_TYPE_COUNT];
+
+private:
+    enum RecordType
+    {
+        eReplayRecord = 1,
+        eRemovedRecord = 2
+    };
+
+    bool readRecord (uint8_t type, const std::string &payload)
+    {
+        BinaryReader reader(payload);
+
+        if (type == eRemovedRecord)
+        {
+            std::string fileName = reader.readString();
+
+            // Removing a replay that isn't in the catalog is harmless, so it doesn't count as corruption
+            if (!reader.good())
+            {
+                return false;
+            }
+
+            erase(fileName);
+            records++;
+
+            return true;
+        }
+        else if (type != eReplayRecord)
+        {
+            // A record type from a newer version; skip it, but keep it for when the file is rewritten
+            foreignRecords += RecordFile::buildRecord(type, payload);
+            return true;
+        }
+
+        Replay replay;
+
+        replay.fileName     = reader.readString();
+        replay.size         = reader.read<uint64_t>();
+        replay.hash         = reader.read<uint64_t>();
+        replay.savedAt      = reader.read<int64_t>();
+        replay.type         = reader.read<uint8_t>();
+        replay.teamOneColor = reader.read<int32_t>();
+        replay.teamTwoColor = reader.read<int32_t>();
+        replay.teamOneName  = reader.readString();
+        replay.teamTwoName  = reader.readString();
+
+        if (!reader.good() || replay.fileName.empty() || replay.type >= REPLAY_TYPE_COUNT)
+        {
+            return false;
+        }
+
+        // A replay saved again under the same name replaces the old entry
+        erase(replay.fileName);
+        insert(replay);
+        records++;
+
+        return true;
+    }
+
+    static std::string buildReplayRecord (const Replay &replay)
+    {
+        BinaryWriter writer;
+
+        writer.writeString(replay.fileName);
+        writer.write(replay.size);
+        writer.write(replay.hash);
+        writer.write(replay.savedAt);
+        writer.write(replay.type);
+        writer.write(replay.teamOneColor);
+        writer.write(replay.teamTwoColor);
+        writer.writeString(replay.teamOneName);
+        writer.writeString(replay.teamTwoName);
+
+        return RecordFile::buildRecord(eReplayRecord, writer.buffer);
+    }
+
+    void insert (const Replay &replay)
+    {
+        byName[replay.fileName] = replays.size();
+        replays.push_back(replay);
+        liveSize += replay.size;
+    }
+
+    // Removed replays are left behind with an empty name so the positions in byName stay valid, until they make
+    // up more than half of the catalog and it's compacted
+    bool erase (const std::string &fileName)
+    {
+        std::unordered_map<std::string, size_t>::iterator it = byName.find(fileName);
+
+        if (it == byName.end())
+        {
+            return false;
+        }
+
+        Replay &replay = replays[it->second];
+        liveSize -= replay.size;
+        replay = Replay();
+        byName.erase(it);
+
+        if (++removed * 2 > replays.size())
+        {
+            compact();
+        }
+
+        return true;
+    }
+
+    void compact ()
+    {
+        std::vector<Replay> live;
+        live.reserve(byName.size());
+
+        for (auto &replay : replays)
+        {
+            if (!replay.fileName.empty())
+            {
+                byName[replay.fileName] = live.size();
+                live.push_back(std::move(replay));
+            }
+        }
+
+        replays.swap(live);
+        removed = 0;
+    }
+
+    void clear ()
+    {
+        replays.clear();
+        byName.clear();
+        foreignRecords.clear();
+        liveSize = 0;
+        removed  = 0;
+        records  = 0;
+    }
+
+    RecordFile file;
+    std::vector<Replay> replays;                     // Oldest first, including the empty places of removed replays
+    std::unordered_map<std::string, size_t> byName;  // The position of each replay in the catalog by file name
+    std::string foreignRecords;                      // The records from a newer version, to write back as they were
+    uint64_t liveSize;                               // The combined size of every replay in the catalog
+    size_t   removed,                                // The number of empty places in replays
+             records;                                // The number of replay and removal records in the file
+};
+
+const char* ReplayCatalog::TYPE_NAMES[REPLAY_TYPE_COUNT] = { "unknown", "fun", "official" };
+
+// The BZDB variables read by our event handlers. Looking a variable up in bzfs means a string keyed lookup and
+// parsing its value every time, so they're read once and then refreshed whenever an admin or the map changes
+// any BZDB variable; since a value may be an expression that refers to other variables, every one of them
+// is read again rather than only the one that changed
+struct BZDBSnapshot
+{
+    double explodeTime, // _explodeTime: the amount of seconds a tank takes to explode
+           worldSize;   // _worldSize: the width of the world in world units
+
+    BZDBSnapshot () :
+        explodeTime(5),
+        worldSize(800)
+    {}
+
+    void refresh ()
+    {
+        explodeTime = bz_getBZDBDouble("_explodeTime");
+        worldSize   = bz_getBZDBDouble("_worldSize");
+    }
+};
+
+// Every setting that is read from the configuration file. The plugin inherits these so they can be used
+// directly; a reload parses and validates a complete copy of them before assigning them all at once so
+// no handler ever sees a mix of old and new settings
+struct PluginSettings
+{
+    bool         ROTATION_LEAGUE,  // Whether or not we are watching a league that uses different maps
+                 DISABLE_REPORT,   // Whether or not to disable automatic match reports if a server is not used as an official match server
+                 DISABLE_MOTTO;    // Whether or not to set a player's motto to their team name
+
+    int          DEBUG_LEVEL,      // The DEBUG level the server owner wants the plugin to use for its messages
+                 VERBOSE_LEVEL;    // This is the spamming/ridiculous level of debug that the plugin uses
+
+    double       METRICS_INTERVAL, // The amount of seconds between each rewrite of the metrics file
+                 CHECKPOINT_INTERVAL, // The amount of seconds between each checkpoint of the current match
+                 HEATMAP_CELL_SIZE, // The width of each cell of a match heatmap in world units
+                 REPLAY_MAX_SIZE,  // The amount of megabytes the cataloged replays may take up; 0 for no limit
+                 REPLAY_MAX_AGE,   // The amount of days fun match replays are kept; 0 for no limit
+                 REPLAY_OFFICIAL_MAX_AGE, // The amount of days official match replays are kept; 0 for no limit
+                 LIVE_STATE_INTERVAL, // The amount of seconds between each check for changes to publish to LIVE_STATE_PATH
+                 SHARED_MOTTO_MAX_AGE, // The amount of seconds a team dump in the shared motto cache is used before it's downloaded again
+                 MOTTO_CACHE_TTL,  // The amount of seconds we remember the team of a player before asking the league website again
+                 MOTTO_CACHE_NEGATIVE_TTL, // The amount of seconds we remember that a player has no team before asking again
+                 MOTTO_REQUEST_RATE; // The number of team name queries per second we send to the league website
+
+    int          MOTTO_CACHE_SIZE, // The number of players whose team we remember from individual team name queries
+                 MOTTO_REQUEST_BURST, // The number of team name queries we may send at once after being quiet for a while
+                 MOTTO_QUEUE_LIMIT; // The number of team name queries that may wait to be sent before new ones are dropped
+
+    std::string  MATCH_REPORT_URL, // The URL the plugin will use to report matches. This should be the URL the PHP counterpart of this plugin
+                 TEAM_NAME_URL,
+                 MAPCHANGE_PATH,   // The path to the file that contains the name of current map being played
+                 METRICS_PATH,     // The path to the Prometheus text file the plugin's metrics are written to; empty to disable
+                 SHARED_MOTTO_CACHE, // The path to the file mapped into memory to share team mottos with other servers; empty to disable
+                 CHECKPOINT_PATH,  // The path to the file the current match is periodically saved to; empty to disable
+                 MATCH_HISTORY_PATH, // The path to the file every finished match is appended to; empty to disable
+                 HEATMAP_PATH,     // The directory the heatmap of each match is saved to; empty to disable
+                 REPLAY_PATH,      // The directory bzfs saves replays to, the same as its -recdir option
+                 REPLAY_CATALOG_PATH, // The path to the file the replays in REPLAY_PATH are cataloged in; empty to disable
+                 LIVE_STATE_PATH,  // The path to the JSON file the state of the current match is published to; empty to disable
+                 HTTP_TRANSPORT,   // Who sends our requests to the league website: "bzfs", "curl" or "sidecar"
+                 SIDECAR_SOCKET;   // The path to the Unix domain socket of the sidecar used when HTTP_TRANSPORT is "sidecar"
+
+    PluginSettings () :
+        ROTATION_LEAGUE(false),
+        DISABLE_REPORT(false),
+        DISABLE_MOTTO(false),
+        DEBUG_LEVEL(1),
+        VERBOSE_LEVEL(4),
+        METRICS_INTERVAL(15),
+        CHECKPOINT_INTERVAL(15),
+        HEATMAP_CELL_SIZE(10),
+        REPLAY_MAX_SIZE(0),
+        REPLAY_MAX_AGE(0),
+        REPLAY_OFFICIAL_MAX_AGE(0),
+        LIVE_STATE_INTERVAL(1),
+        SHARED_MOTTO_MAX_AGE(3600),
+        MOTTO_CACHE_TTL(1800),
+        MOTTO_CACHE_NEGATIVE_TTL(600),
+        MOTTO_REQUEST_RATE(2),
+        MOTTO_CACHE_SIZE(4096),
+        MOTTO_REQUEST_BURST(5),
+        MOTTO_QUEUE_LIMIT(32),
+        HTTP_TRANSPORT("bzfs")
+    {}
+};
+
+class LeagueOverseer : public bz_Plugin, public bz_CustomSlashCommandHandler, public bz_BaseURLHandler, public PluginSettings
+{
+public:
+    virtual const char* Name ()
+    {
+        static std::string pluginBuild = "";
+
+        if (!pluginBuild.size())
+        {
+            std::ostringstream pluginBuildStream;
+
+            pluginBuildStream << "League Overseer " << MAJOR << "." << MINOR << "." << REV << " (" << BUILD << ")";
+            pluginBuild = pluginBuildStream.str();
+        }
+
+        return pluginBuild.c_str();
+    }
+    virtual void Init (const char* config);
+    virtual void Event (bz_EventData *eventData);
+    virtual void Cleanup (void);
+
+    virtual bool SlashCommand (int playerID, bz_ApiString, bz_ApiString, bz_APIStringList*);
+
+    virtual void URLDone (const char* URL, const void* data, unsigned int size, bool complete);
+    virtual void applyMottoResponse (const MottoResponse &response);
+    virtual void replaceTeamMottos (std::shared_ptr<const MottoTable> table);
+    virtual void URLTimeout (const char* URL, int errorCode);
+    virtual void URLError (const char* URL, int errorCode, const char *errorString);
+
+    // bzfs only tells a URL handler which URL answered and all of our requests go to the same URL,
+    // so every request gets a handler of its own that knows what type of request it is
+    class URLJobHandler : public bz_BaseURLHandler
+    {
+    public:
+        URLJobHandler (LeagueOverseer *_plugin, URLJobType _type, uint32_t _matchID) :
+            plugin(_plugin),
+            type(_type),
+            matchID(_matchID),
+            startTime(std::chrono::steady_clock::now())
+        {}
+
+        virtual void URLDone (const char* URL, const void* data, unsigned int size, bool complete)
+        {
+            ProfileScope profile(plugin->urlCallbackProfiles[type]);
+
+            plugin->finishURLJob(this, plugin->metrics.urlJobsDone[type]);
+            plugin->finishMatchReport(matchID, eReportSent);
+            plugin->URLDone(URL, data, size, complete);
+            plugin->updateTickEvent();
+        }
+
+        virtual void URLTimeout (const char* URL, int errorCode)
+        {
+            ProfileScope profile(plugin->urlCallbackProfiles[type]);
+
+            plugin->finishURLJob(this, plugin->metrics.urlJobTimeouts[type]);
+            plugin->finishMatchReport(matchID, eReportFailed);
+            plugin->URLTimeout(URL, errorCode);
+
+            if (type == eReportMatchJob)
+            {
+                bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "The match could not be reported due to the connection to the league site timing out.");
+                bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "If the league site is not down, please notify the server owner to reconfigure this plugin.");
+            }
+
+            plugin->updateTickEvent();
+        }
+
+        virtual void URLError (const char* URL, int errorCode, const char *errorString)
+        {
+            ProfileScope profile(plugin->urlCallbackProfiles[type]);
+
+            plugin->finishURLJob(this, plugin->metrics.urlJobErrors[type]);
+            plugin->finishMatchReport(matchID, eReportFailed);
+            plugin->URLError(URL, errorCode, errorString);
+
+            if (type == eReportMatchJob)
+            {
+                bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "An unknown error has occurred, please notify the server owner to reconfigure this plugin.");
+            }
+
+            plugin->updateTickEvent();
+        }
+
+        LeagueOverseer *plugin;
+        URLJobType      type;
+
+        // The match history ID of the match a report was sent for, so its answer is recorded against the right
+        // match even when answers come back out of order; 0 for every other request
+        uint32_t matchID;
+
+        // When the request was handed over to be sent, so requests answered out of order are still timed right
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    // We will be storing information about the players who participated in a match so we will
+    // be storing that information inside a struct
+    struct MatchParticipant
+    {
+        // Basic player info
+        int slotID;
+        std::string bzID;
+        std::string callsign;
+        std::string ipAddress;
+
+        std::string teamName;
+        bz_eTeamType teamColor;
+
+        bool hasSpawned; // Set to true if the player has ever spawned in the match
+
+        double startTime;     // The time the player started playing their last session
+        double lastDeathTime; // The time the player last died
+        double totalPlayTime; // The total amount of time a player has played in a match in seconds
+        double totalIdleTime; // An estimated amount of idle time a player has had during the match
+
+        // The amount of seconds a player has played on each respective team, indexed by team color
+        double playTimeByTeam[ePurpleTeam + 1];
+
+        // What the player did with the team flags
+        int flagGrabs;        // The number of enemy team flags they grabbed
+        int flagCaptures;     // The number of enemy team flags they captured
+        int flagReturns;      // The number of times they grabbed their own team's flag to bring it home
+        double flagCarryTime; // The amount of seconds they spent carrying enemy team flags
+
+        bool checkpointDirty;         // Whether this player has changed since their checkpoint record was last built
+        std::string checkpointRecord; // This player's serialized record in the match checkpoint
+
+        MatchParticipant() :
+            slotID(-1),
+            teamColor(eNoTeam),
+            hasSpawned(false),
+            startTime(-1),
+            lastDeathTime(-1),
+            totalPlayTime(0),
+            totalIdleTime(0),
+            flagGrabs(0),
+            flagCaptures(0),
+            flagReturns(0),
+            flagCarryTime(0),
+            checkpointDirty(true)
+        {
+            std::fill(playTimeByTeam, playTimeByTeam + ePurpleTeam + 1, 0.0);
+        }
+
+        MatchParticipant(bz_BasePlayerRecord *pr) :
+            MatchParticipant()
+        {
+            slotID    = pr->playerID;
+            bzID      = pr->bzID;
+            callsign  = pr->callsign;
+            ipAddress = pr->ipAddress;
+            teamColor = pr->team;
+        }
+
+        double estimatedPlayTime ()
+        {
+            return (totalPlayTime - (totalIdleTime * IDLE_FORGIVENESS));
+        }
+
+        bz_eTeamType getLoyalty (bz_eTeamType team1, bz_eTeamType team2)
+        {
+            if (!isPlayingTeam(team2) || (isPlayingTeam(team1) && playTimeByTeam[team1] >= playTimeByTeam[team2]))
+            {
+                return team1;
+            }
+
+            return team2;
+        }
+
+        bool isEligible (bool isOfficial, double matchDuration)
+        {
+            return (
+                (isOfficial  && estimatedPlayTime() >= OFFI_MIN_TIME) ||  // It's an official match and they played at least the minimum time
+                (!isOfficial && estimatedPlayTime() >= (matchDuration * FM_MIN_RATIO))  // It's a fun match and they played at least the minimum time
+            );
+        }
+
+        void updatePlayingTime (bz_eTeamType team)
+        {
+            if (!hasSpawned)
+            {
+                return;
+            }
+
+            double sessionPlaytime = bz_getCurrentTime() - startTime;
+
+            totalPlayTime += sessionPlaytime;
+            startTime = -1;
+            checkpointDirty = true;
+
+            if (isPlayingTeam(team))
+            {
+                playTimeByTeam[team] += sessionPlaytime;
+            }
+        }
+
+        // A player who left the match has come back, so start counting their playing time again
+        void resumePlaying ()
+        {
+            startTime = lastDeathTime = bz_getCurrentTime();
+            checkpointDirty = true;
+        }
+
+        // Serialize everything about this player that a checkpoint needs, reusing the previous
+        // record if nothing has changed since it was built
+        const std::string& getCheckpointRecord ()
+        {
+            if (checkpointDirty)
+            {
+                BinaryWriter writer;
+
+                writer.writeString(bzID);
+                writer.writeString(callsign);
+                writer.writeString(ipAddress);
+                writer.writeString(teamName);
+                writer.write<int32_t>(teamColor);
+                writer.write<uint8_t>(hasSpawned);
+                writer.write(startTime);
+                writer.write(lastDeathTime);
+                writer.write(totalPlayTime);
+                writer.write(totalIdleTime);
+
+                for (int team = eRogueTeam; team <= ePurpleTeam; team++)
+                {
+                    writer.write(playTimeByTeam[team]);
+                }
+
+                writer.write<int32_t>(flagGrabs);
+                writer.write<int32_t>(flagCaptures);
+                writer.write<int32_t>(flagReturns);
+                writer.write(flagCarryTime);
+
+                checkpointRecord.swap(writer.buffer);
+                checkpointDirty = false;
+            }
+
+            return checkpointRecord;
+        }
+
+        bool readCheckpointRecord (BinaryReader &reader)
+        {
+            bzID          = reader.readString();
+            callsign      = reader.readString();
+            ipAddress     = reader.readString();
+            teamName      = reader.readString();
+            teamColor     = (bz_eTeamType)reader.read<int32_t>();
+            hasSpawned    = reader.read<uint8_t>() != 0;
+            startTime     = reader.read<double>();
+            lastDeathTime = reader.read<double>();
+            totalPlayTime = reader.read<double>();
+            totalIdleTime = reader.read<double>();
+
+            for (int team = eRogueTeam; team <= ePurpleTeam; team++)
+            {
+                playTimeByTeam[team] = reader.read<double>();
+            }
+
+            flagGrabs     = reader.read<int32_t>();
+            flagCaptures  = reader.read<int32_t>();
+            flagReturns   = reader.read<int32_t>();
+            flagCarryTime = reader.read<double>();
+
+            return reader.good();
+        }
+    };
+
+    // Simply out of preference, we will be storing all the information regarding a match inside
+    // of a struct where the struct will be NULL if it is current a fun match
+    struct CurrentMatch
+    {
+        bool        playersRecorded,    // Whether or not the players participating in the match have been recorded or not
+                    isOfficialMatch,    // Whether or not the match is official; when set to false it'll be a fun match
+                    canceled;           // Whether or not the official match was canceled
+
+        std::string cancelationReason,  // If the match was canceled, store the reason as to why it was canceled
+                    teamOneName,        // We'll be doing our best to store the team names of who's playing so store the names for
+                    teamTwoName;        //     each team respectively. This will be blank if it's a fun match
+
+        double      duration,           // The length of the match in seconds. Used when reporting a match to the server
+                    matchRollCall;      // The amount of seconds that need to pass in a match before the first roll call
+
+        // We keep the number of points scored in the case where all the members of a team leave and their team
+        // score get reset to 0
+        int         teamOnePoints,
+                    teamTwoPoints;
+
+        time_t      matchStart,         // The timestamp of when a match was started in order to calculate the timer
+                    matchPaused;        // If the match is paused, it will be stored here in order to update matchStart appropriately for the timer
+
+        // The roster's nodes and the heatmap's cells come out of this arena, so it must be declared before
+        // anything that allocates from it. Destroying the match still walks the roster to destroy each
+        // participant, and a participant's strings that don't fit in std::string's own buffer (long
+        // callsigns and team names, the checkpoint record) are on the regular heap, as are statusLines and
+        // cancelationReason; only the nodes themselves are given back with the arena in one go
+        MatchArena  arena;
+
+        typedef std::map<std::string, MatchParticipant, std::less<std::string>,
+                         ArenaAllocator<std::pair<const std::string, MatchParticipant> > > Roster;
+
+        Roster      matchRoster;
+
+        // The roster entry of the player in each slot so the events that fire constantly during a match don't
+        // need to look players up by BZID; NULL for slots without a participant
+        MatchParticipant* rosterBySlot[MAX_PLAYER_SLOTS];
+
+        // Where players died and spawned; only set up once the match starts and only when HEATMAP_PATH is set
+        MatchHeatmap heatmap;
+
+        // The /matchstatus lines as of the last time anything they show changed, and the bz_getCurrentTime() at
+        // which they go stale on their own because a player becomes eligible; 0 when they need to be rebuilt
+        std::vector<std::string> statusLines;
+        double statusExpires;
+
+        // When the player in each slot grabbed the enemy team flag they're carrying; -1 if they aren't carrying one
+        double flagCarryStart[MAX_PLAYER_SLOTS];
+
+        // Set the default values for this struct
+        CurrentMatch () :
+            playersRecorded(false),
+            isOfficialMatch(true),
+            canceled(false),
+            cancelationReason(""),
+            teamOneName("Team-A"),
+            teamTwoName("Team-B"),
+            duration(-1.0f),
+            matchRollCall(90.0),
+            teamOnePoints(0),
+            teamTwoPoints(0),
+            matchStart(time(NULL)),
+            matchPaused(time(NULL)),
+            arena(),
+            matchRoster(std::less<std::string>(), Roster::allocator_type(&arena)),
+            statusExpires(0)
+        {
+            std::fill(rosterBySlot, rosterBySlot + MAX_PLAYER_SLOTS, (MatchParticipant*)NULL);
+            std::fill(flagCarryStart, flagCarryStart + MAX_PLAYER_SLOTS, -1.0);
+        }
+
+        // Add a player to the roster and remember which slot they're playing in
+        MatchParticipant& addParticipant (const MatchParticipant &player)
+        {
+            MatchParticipant &entry = matchRoster[player.bzID] = player;
+            setParticipantSlot(player.slotID, &entry);
+
+            return entry;
+        }
+
+        void setParticipantSlot (int playerID, MatchParticipant *player)
+        {
+            if (playerID >= 0 && playerID < MAX_PLAYER_SLOTS)
+            {
+                rosterBySlot[playerID] = player;
+            }
+
+            invalidateStatus();
+        }
+
+        // Something /matchstatus shows has changed
+        void invalidateStatus ()
+        {
+            statusExpires = 0;
+        }
+
+        // Get the roster entry of the player in a slot, or NULL if they're not a part of this match
+        MatchParticipant* findParticipant (int playerID)
+        {
+            return (playerID >= 0 && playerID < MAX_PLAYER_SLOTS) ? rosterBySlot[playerID] : NULL;
+        }
+
+        // Add the time the player in a slot has been carrying an enemy team flag to their total, if they were carrying one
+        void finishFlagCarry (int playerID, double now)
+        {
+            MatchParticipant *player = findParticipant(playerID);
+
+            if (player && flagCarryStart[playerID] >= 0)
+            {
+                player->flagCarryTime += std::max(0.0, now - flagCarryStart[playerID]);
+                player->checkpointDirty = true;
+            }
+
+            if (playerID >= 0 && playerID < MAX_PLAYER_SLOTS)
+            {
+                flagCarryStart[playerID] = -1;
+            }
+        }
+    };
+
+    virtual void addURLJob (URLJobType type, const std::string &url, const std::string &postData, uint32_t matchID = 0);
+    virtual void dispatchURLJobs (void);
+    virtual void sendURLJob (URLJobType type, const std::string &url, const std::string &postData, uint32_t matchID);
+    virtual void finishURLJob (URLJobHandler *handler, std::atomic<uint64_t> &outcome);
+    virtual void writeMetrics (void);
+    virtual void updateTickEvent (void);
+    virtual void appendFileInBackground (const std::string &path, const std::string &contents, const char *description);
+    virtual void startHTTPTransport (void);
+    virtual TimerWheel::TimerID scheduleTimer (double delay, double interval, TimerWheel::Callback callback);
+    virtual void startWatcherTimer (void);
+    virtual void startMatchTimer (void);
+    virtual void startCheckpointTimer (void);
+    virtual void startMetricsTimer (void);
+    virtual void startLiveStateTimer (void);
+    virtual void publishLiveState (void);
+    virtual void checkWatchers (void);
+    virtual bool checkMatch (void);
+    virtual void writeFileInBackground (const std::string &path, const std::string &contents, const char *description);
+    virtual void sendProfile (int playerID, const char *handler, const HandlerProfile &profile);
+    virtual void writeCheckpoint (void);
+    virtual void loadCheckpoint (void);
+    virtual void reportMatch (bz_Time &standardTime, const std::string &replayFile, const std::string &mapPlayed, uint32_t historyID);
+    virtual void openMatchHistory (void);
+    virtual uint32_t recordMatch (time_t finishedAt, const std::string &replayFile, const std::string &mapPlayed, bool reporting);
+    virtual void finishMatchReport (uint32_t matchID, MatchReportStatus status);
+    virtual void appendMatchHistory (const std::string &record);
+    virtual void sendMatchSummary (int playerID, const MatchHistory::Match &match);
+    virtual void openReplayCatalog (void);
+    virtual void importReplays (void);
+    virtual void catalogReplay (const std::string &fileName, time_t savedAt);
+    virtual void pruneReplays (void);
+    virtual void refreshTeamBalancer (void);
+    virtual void buildPlayerStrings (bz_eTeamType team, std::string &bzidString, std::string &ipString, std::string &flagString);
+    virtual bz_ApiString buildReplayName (bz_Time &standardTime);
+    virtual int getMatchProgress ();
+    virtual std::string getMatchTime ();
+    virtual std::string getMatchTime (int progress);
+    virtual void buildMatchStatus (void);
+    virtual void loadConfig (const char *cmdLine);
+    virtual bool parseConfig (const char *cmdLine, PluginSettings &settings);
+    virtual bool reloadConfig (void);
+    virtual void printConfig (void);
+    virtual void readMapName (void);
+    virtual void requestTeamName (bz_eTeamType team);
+    virtual void requestTeamName (std::string callsign, std::string bzID);
+    virtual void updateTeamNames (void);
+    virtual void refreshTeamMottos (void);
+    virtual std::string getTeamMotto (const std::string &bzID);
+    virtual std::string getPlayerMotto (const std::string &bzID);
+
+    // All the variables that will be used in the plugin; the configuration file settings live in PluginSettings
+    bool         RECORDING;        // Whether or not we are recording a match
+
+    std::string  MAP_NAME,         // The name of the map that is currently be played if it's a rotation league (i.e. OpenLeague uses multiple maps)
+                 CONFIG_PATH;      // The path to the configuration file so it can be reloaded
+
+    // Watch the configuration file and the mapchange file so we only read them when they change
+    FileWatcher  configWatcher,
+                 mapChangeWatcher;
+
+    bz_eTeamType TEAM_ONE,         // Because we're serving more than just GU league, we need to support different colors therefore, call the teams
+                 TEAM_TWO;         //     ONE and TWO
+
+    // This is the only pointer of the struct for the official match that we will be using. If this
+    // variable is set to NULL, that means that there is currently no official match occurring.
+    std::unique_ptr<CurrentMatch> currentMatch;
+
+    // A match that was still in progress when the server went down, waiting on a referee to report or
+    // discard it with /lorecover. This is NULL when there is nothing to recover.
+    std::unique_ptr<CurrentMatch> recoveredMatch;
+    std::string recoveredMapName;
+    time_t recoveredAt;     // When the recovered match was last checkpointed
+    int recoveredProgress;  // How many seconds into the recovered match the last checkpoint was
+
+    // The team name of every BZID in the last team dump from the league website. A new dump is built into a
+    // table of its own on the worker thread and replaces this one as a whole; it's never modified in place
+    std::shared_ptr<const MottoTable> teamMottos;
+
+    // The answers to the team name queries sent for individual players as they join. These are newer than
+    // the team dump so they take precedence over it
+    MottoCache mottoCache;
+
+    // The team dump shared by all of the servers on this host, used when SHARED_MOTTO_CACHE is set.
+    // Entries in teamMottos take precedence over the shared table.
+    SharedMottoCache sharedMottos;
+
+    // The plugin's time based work and the timers for each kind of it; a timer's ID stays around after it
+    // has stopped so check TimerWheel::isScheduled() before assuming one is running
+    TimerWheel timers;
+    TimerWheel::TimerID watcherTimer,      // Polls the configuration and mapchange files while players are online
+                        matchTimer,        // Keeps an eye on the current match while one exists
+                        checkpointTimer,   // Checkpoints the current match while it is being played
+                        metricsTimer,      // Rewrites the metrics file
+                        liveStateTimer,    // Publishes the state of the current match if it has changed
+                        sharedMottoTimer;  // Checks whether another server has published the team dump we're waiting on
+
+    // Whether we're currently listening to the tick event
+    bool tickRegistered;
+
+    // The contents of the last file published to LIVE_STATE_PATH, so it's only rewritten when something changed
+    std::string lastLiveState;
+
+    // Every match this server has finished, used when MATCH_HISTORY_PATH is set
+    MatchHistory matchHistory;
+
+    // Every replay in REPLAY_PATH, used when REPLAY_CATALOG_PATH is set
+    ReplayCatalog replayCatalog;
+
+    // The strength of each team, used to pick a team for players who join with automatic team selection
+    TeamBalancer teamBalancer;
+
+    // The counters and histograms that are periodically written to METRICS_PATH
+    PluginMetrics metrics;
+
+    // The handlers of the requests waiting on a response from the league website, and of the ones that got it
+    // since the last tick; a handler is only freed once it has returned
+    std::vector<std::unique_ptr<URLJobHandler>> urlJobsInFlight,
+                                                urlJobsFinished;
+
+    // Parses team dumps and writes the metrics and checkpoint files off of the main loop
+    BackgroundWorker worker;
+
+    // The BZDB variables our event handlers need, kept up to date by bz_eBZDBChange
+    BZDBSnapshot bzdb;
+
+    // Sends our requests to the league website instead of bzfs when HTTP_TRANSPORT is "curl"
+    CurlTransport httpClient;
+
+    // Hands our requests to a local sidecar instead when HTTP_TRANSPORT is "sidecar"
+    SidecarTransport sidecar;
+
+    // A request to the league website that is waiting for its turn to be handed to bzfs
+    struct QueuedURLJob
+    {
+        URLJobType  type;
+        std::string url,
+                    postData;
+        uint32_t    matchID;
+
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    // The requests waiting to be sent, one queue per priority
+    std::deque<QueuedURLJob> urlJobQueues[URL_JOB_PRIORITY_COUNT];
+
+    // A token bucket that keeps team name queries from reaching the league website in bursts
+    double mottoRequestTokens,
+           lastTokenRefill;
+
+    // How long our handlers take to run, shown with the /loprofile command
+    HandlerProfile eventProfiles[bz_eLastEvent],
+                   slashCommandProfile,
+                   urlCallbackProfiles[URL_JOB_TYPE_COUNT];
+};
+
+BZ_PLUGIN(LeagueOverseer)
+
+void LeagueOverseer::Init (const char* commandLine)
+{
+    // Register our events with Register()
+    Register(bz_eBZDBChange);
+    Register(bz_eCaptureEvent);
+    Register(bz_eFlagDroppedEvent);
+    Register(bz_eFlagGrabbedEvent);
+    Register(bz_eGameEndEvent);
+    Register(bz_eGameResumeEvent);
+    Register(bz_eGameStartEvent);
+    Register(bz_eGetAutoTeamEvent);
+    Register(bz_eGetPlayerMotto);
+    Register(bz_ePlayerDieEvent);
+    Register(bz_ePlayerJoinEvent);
+    Register(bz_ePlayerPartEvent);
+    Register(bz_ePlayerSpawnEvent);
+    Register(bz_eTeamScoreChanged);
+
+    // Read the BZDB variables we use now, bz_eBZDBChange keeps them up to date from here on
+    bzdb.refresh();
+
+    // Register our custom slash commands
+    bz_registerCustomSlashCommand("cancel", this);
+    bz_registerCustomSlashCommand("finish", this);
+    bz_registerCustomSlashCommand("fm", this);
+    bz_registerCustomSlashCommand("history", this);
+    bz_registerCustomSlashCommand("lastmatch", this);
+    bz_registerCustomSlashCommand("replays", this);
+    bz_registerCustomSlashCommand("matchstatus", this);
+    bz_registerCustomSlashCommand("loprofile", this);
+    bz_registerCustomSlashCommand("loreload", this);
+    bz_registerCustomSlashCommand("lorecover", this);
+    bz_registerCustomSlashCommand("offi", this);
+    bz_registerCustomSlashCommand("official", this);
+    bz_registerCustomSlashCommand("spawn", this);
+    bz_registerCustomSlashCommand("pause", this);
+    bz_registerCustomSlashCommand("resume", this);
+
+    bz_registerCustomSlashCommand("gameover", this);
+    bz_registerCustomSlashCommand("countdown", this);
+
+    // Set some default values
+    currentMatch = NULL;
+    watcherTimer = matchTimer = checkpointTimer = metricsTimer = liveStateTimer = sharedMottoTimer = 0;
+    tickRegistered = false;
+    teamMottos = std::make_shared<MottoTable>();
+    recoveredAt = 0;
+    recoveredProgress = 0;
+
+    if (!worker.start())
+    {
+        bz_debugMessage(0, "WARNING :: League Overseer :: The worker thread could not be started, all work will be done on the main thread.");
+    }
+
+    // Load the configuration data when the plugin is loaded
+    loadConfig(commandLine);
+    startHTTPTransport();
+
+    mottoRequestTokens = MOTTO_REQUEST_BURST;
+    lastTokenRefill = bz_getCurrentTime();
+
+    readMapName();
+
+    // Assign our two team colors to eNoTeam simply so we have something to check for
+    // when we are trying to find the two colors the map is using
+    TEAM_ONE = eNoTeam;
+    TEAM_TWO = eNoTeam;
+
+    // Loop through all the team colors
+    for (bz_eTeamType t = eRedTeam; t <= ePurpleTeam; t = (bz_eTeamType) (t + 1))
+    {
+        // If the current team's player limit is more than 0, that means that we found a
+        // team color that the map is using
+        if (bz_getTeamPlayerLimit(t) > 0)
+        {
+            // If team one is eNoTeam, then that means this is just the first team with player limit
+            // that we have found. If it's not eNoTeam, that means we've found the second team
+            if (TEAM_ONE == eNoTeam)
+            {
+                TEAM_ONE = t;
+            }
+            else if (TEAM_TWO == eNoTeam)
+            {
+                TEAM_TWO = t;
+                break; // After we've found the second team, there's no need to continue so break out of here
+            }
+        }
+    }
+
+    // Make sure both teams were found, if they weren't then notify in the logs
+    ASSERT(TEAM_ONE != eNoTeam && TEAM_TWO != eNoTeam);
+
+    // Servers on the same host can share a single copy of the team dump
+    if (!SHARED_MOTTO_CACHE.empty() && !sharedMottos.open(SHARED_MOTTO_CACHE))
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The shared motto cache at %s could not be opened.", SHARED_MOTTO_CACHE.c_str());
+    }
+
+    refreshTeamMottos();
+    openMatchHistory();
+    openReplayCatalog();
+    refreshTeamBalancer();
+
+    // If the server went down in the middle of a match, hold on to what we know about it
+    loadCheckpoint();
+
+    // Start the periodic work; the tick event is only registered while any of it is scheduled
+    startWatcherTimer();
+    startMetricsTimer();
+    startLiveStateTimer();
+
+    if (bz_isCountDownActive() || bz_isCountDownInProgress())
+    {
+        startMatchTimer();
+    }
+
+    if (bz_getTimeLimit() == 0.0)
+    {
+        bz_debugMessage(DEBUG_LEVEL, "WARNING :: League Overseer :: No time limit is specified with '-time'. Default value used: 1800 seconds.");
+        bz_setTimeLimit(1800);
+    }
+}
+
+void LeagueOverseer::Cleanup (void)
+{
+    Flush(); // Clean up all the events
+
+    // Clean up our custom slash commands
+    bz_removeCustomSlashCommand("cancel");
+    bz_removeCustomSlashCommand("finish");
+    bz_removeCustomSlashCommand("fm");
+    bz_removeCustomSlashCommand("history");
+    bz_removeCustomSlashCommand("lastmatch");
+    bz_removeCustomSlashCommand("replays");
+    bz_removeCustomSlashCommand("matchstatus");
+    bz_removeCustomSlashCommand("loprofile");
+    bz_removeCustomSlashCommand("loreload");
+    bz_removeCustomSlashCommand("lorecover");
+    bz_removeCustomSlashCommand("offi");
+    bz_removeCustomSlashCommand("official");
+    bz_removeCustomSlashCommand("spawn");
+    bz_removeCustomSlashCommand("pause");
+    bz_removeCustomSlashCommand("resume");
+
+    bz_removeCustomSlashCommand("gameover");
+    bz_removeCustomSlashCommand("countdown");
+
+    if (!urlJobQueues[eHighPriority].empty())
+    {
+        bz_debugMessagef(0, "WARNING :: League Overseer :: %d match report(s) were still waiting to be sent and have been dropped.", (int)urlJobQueues[eHighPriority].size());
+    }
+
+    // Leave the metrics as they were at the moment the plugin was unloaded, with the requests that are about to be
+    // dropped still counted as pending
+    writeMetrics();
+
+    // Our URL handlers are about to be freed, so don't let bzfs call them for pending requests
+    bz_removeURLJob(MATCH_REPORT_URL.c_str());
+    bz_removeURLJob(TEAM_NAME_URL.c_str());
+    httpClient.stop();
+    sidecar.stop();
+    urlJobsInFlight.clear();
+    urlJobsFinished.clear();
+
+    // Let the worker finish writing files before the plugin goes away
+    worker.stop();
+}
+
+void LeagueOverseer::Event (bz_EventData *eventData)
+{
+    ASSERT_MAIN_THREAD();
+
+    // Keep track of how many events of each type we handle and how long it takes to handle them
+    int eventIndex = (eventData->eventType >= 0 && eventData->eventType < bz_eLastEvent) ? eventData->eventType : bz_eNullEvent;
+
+    PluginMetrics::increment(metrics.eventsHandled[eventIndex]);
+    ProfileScope profile(eventProfiles[eventIndex]);
+
+    switch (eventData->eventType)
+    {
+        case bz_eBZDBChange: // This event is called each time a BZDB variable is set
+        {
+            bzdb.refresh();
+        }
+        break;
+
+        case bz_eCaptureEvent:
+        {
+            bz_CTFCaptureEventData_V1 *captureData = (bz_CTFCaptureEventData_V1*)eventData;
+            MatchParticipant *player = (currentMatch != NULL) ? currentMatch->findParticipant(captureData->playerCapping) : NULL;
+
+            if (player)
+            {
+                currentMatch->finishFlagCarry(captureData->playerCapping, bz_getCurrentTime());
+                player->flagCaptures++;
+                player->checkpointDirty = true;
+            }
+        }
+        break;
+
+        case bz_eFlagDroppedEvent:
+        {
+            bz_FlagDroppedEventData_V1 *dropData = (bz_FlagDroppedEventData_V1*)eventData;
+
+            if (currentMatch != NULL)
+            {
+                currentMatch->finishFlagCarry(dropData->playerID, bz_getCurrentTime());
+            }
+        }
+        break;
+
+        case bz_eFlagGrabbedEvent:
+        {
+            bz_FlagGrabbedEventData_V1 *grabData = (bz_FlagGrabbedEventData_V1*)eventData;
+
+            // Use the roster's slot index so a grab doesn't allocate anything, and only look at team flags
+            MatchParticipant *player = (currentMatch != NULL) ? currentMatch->findParticipant(grabData->playerID) : NULL;
+            bz_eTeamType flagTeam = getFlagTeam(grabData->flagType);
+
+            if (player && flagTeam != eNoTeam)
+            {
+                bz_eTeamType playerTeam = bz_getPlayerTeam(grabData->playerID);
+
+                if (flagTeam == playerTeam)
+                {
+                    player->flagReturns++;
+                }
+                else
+                {
+                    player->flagGrabs++;
+                    currentMatch->flagCarryStart[grabData->playerID] = bz_getCurrentTime();
+                }
+
+                player->checkpointDirty = true;
+            }
+        }
+        break;
+
+        case bz_eGameEndEvent: // This event is called each time a game ends
+        {
+            bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: A match has ended.");
+
+            // Get the current standard UTC time
+            bz_Time standardTime;
+            bz_getUTCtime(&standardTime);
+
+            std::unique_ptr<bz_APIIntList> playerList(bz_getPlayerIndexList());
+
+            for (unsigned int i = 0; i < playerList->size(); i++)
+            {
+                MatchParticipant *player = currentMatch->findParticipant(playerList->get(i));
+                bz_eTeamType team = bz_getPlayerTeam(playerList->get(i));
+
+                if (player && team != eObservers) // If player is not an observer
+                {
+                    player->updatePlayingTime(team);
+                }
+
+                currentMatch->finishFlagCarry(playerList->get(i), bz_getCurrentTime());
+            }
+
+            std::string recordingFileName = buildReplayName(standardTime);
+            bool replaySaved = RECORDING;
+
+            // Only save the recording buffer if we actually started recording when the match started
+            if (RECORDING)
+            {
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Recording was in progress during the match.");
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Replay file will be named: %s", recordingFileName.c_str());
+
+                // Save the recording buffer and stop recording
+                bz_saveRecBuf(recordingFileName.c_str(), 0);
+                bz_stopRecBuf();
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Replay file has been saved and recording has stopped.");
+
+                // We're no longer recording, so set the boolean and announce to players that the file has been saved
+                RECORDING = false;
+                bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Match saved as: %s", recordingFileName.c_str());
+            }
+
+            // Save the heatmap under the same name as the replay, or the time the match ended if there isn't one
+            if (currentMatch->heatmap.isEnabled())
+            {
+                std::string heatmapName = recordingFileName;
+
+                if (heatmapName.size() > 4 && heatmapName.compare(heatmapName.size() - 4, 4, ".rec") == 0)
+                {
+                    heatmapName.erase(heatmapName.size() - 4);
+                }
+                else if (heatmapName.empty())
+                {
+                    char matchDate[20];
+                    snprintf(matchDate, sizeof(matchDate), "%d%02d%02d-%02d%02d%02d", standardTime.year, standardTime.month, standardTime.day,
+                             standardTime.hour, standardTime.minute, standardTime.second);
+                    heatmapName = matchDate;
+                }
+
+                writeFileInBackground(joinPath(HEATMAP_PATH, heatmapName + ".heatmap"), currentMatch->heatmap.format(MAP_NAME), "a match heatmap");
+            }
+
+            if (replaySaved)
+            {
+                catalogReplay(recordingFileName, time(NULL));
+            }
+
+            // Pick up a map rotation we haven't noticed yet in case it happened this very tick
+            if (ROTATION_LEAGUE && mapChangeWatcher.changed())
+            {
+                readMapName();
+            }
+
+            uint32_t historyID = recordMatch(time(NULL), (replaySaved) ? recordingFileName : "", MAP_NAME, !DISABLE_REPORT);
+
+            if (!DISABLE_REPORT)
+            {
+                reportMatch(standardTime, recordingFileName, MAP_NAME, historyID);
+            }
+
+            // We're done with the struct, so make it NULL until the next match
+            currentMatch = NULL;
+
+            // The match finished normally so there's nothing to recover if the server goes down now. This goes through
+            // the worker so it happens after any checkpoint it's still writing
+            if (!CHECKPOINT_PATH.empty())
+            {
+                std::string checkpointPath = CHECKPOINT_PATH;
+                worker.submit([checkpointPath]() { std::remove(checkpointPath.c_str()); });
+            }
+        }
+        break;
+
+        case bz_eGameResumeEvent:
+        {
+            // We've resumed an official match, so we need to properly edit the start time so we can calculate the roll call
+            time_t now = time(NULL);
+            double timePaused = difftime(now, currentMatch->matchPaused);
+
+            struct tm modMatchStart = *localtime(&currentMatch->matchStart);
+            modMatchStart.tm_sec += timePaused;
+
+            currentMatch->matchStart = mktime(&modMatchStart);
+            currentMatch->invalidateStatus();
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match paused for %.f seconds. Match continuing at %s.", timePaused, getMatchTime().c_str());
+
+            // Go through our roster and offset their playing time to behave like there was never a game pause
+            for (auto &kv : currentMatch->matchRoster)
+            {
+                if (kv.second.startTime >= 0)
+                {
+                    kv.second.startTime += timePaused;
+                    kv.second.checkpointDirty = true;
+                }
+            }
+
+            // Time spent paused with a flag doesn't count as carrying it either
+            for (int i = 0; i < MAX_PLAYER_SLOTS; i++)
+            {
+                if (currentMatch->flagCarryStart[i] >= 0)
+                {
+                    currentMatch->flagCarryStart[i] += timePaused;
+                }
+            }
+        }
+        break;
+
+        case bz_eGameStartEvent: // This event is triggered when a timed game begins
+        {
+            bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: A match has started");
+
+            // We started recording a match, so save the status
+            RECORDING = bz_startRecBuf();
+
+            // We want to notify the logs if we couldn't start recording just in case an issue were to occur and the server
+            // owner needs to check to see if players were lying about there no replay
+            if (RECORDING)
+            {
+                bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match recording has started successfully");
+            }
+            else
+            {
+                bz_debugMessage(0, "ERROR :: League Overseer :: This match could not be recorded");
+            }
+
+            // Reset scores in case Caps happened during countdown delay.
+            currentMatch->teamOnePoints = currentMatch->teamTwoPoints = 0;
+            currentMatch->matchStart = time(NULL);
+            currentMatch->duration = bz_getTimeLimit();
+            currentMatch->invalidateStatus();
+
+            if (!HEATMAP_PATH.empty())
+            {
+                currentMatch->heatmap.init(currentMatch->arena, bzdb.worldSize, HEATMAP_CELL_SIZE);
+            }
+
+            // Checkpoint the match as soon as the roll call is done
+            startCheckpointTimer();
+            startMatchTimer();
+
+            // Take an initial roll call of the players
+            std::unique_ptr<bz_APIIntList> playerList(bz_getPlayerIndexList());
+
+            // We can't do a roll call if the player list wasn't created
+            if (!playerList)
+            {
+                bz_debugMessagef(VERBOSE_LEVEL, "ERROR :: League Overseer :: Failure to create player list for roll call.");
+                return;
+            }
+
+            for (unsigned int i = 0; i < playerList->size(); i++)
+            {
+                std::unique_ptr<bz_BasePlayerRecord> playerRecord(bz_getPlayerByIndex(playerList->get(i)));
+
+                if (playerRecord && bz_getPlayerTeam(playerList->get(i)) != eObservers) // If player is not an observer
+                {
+                    std::string bzid = playerRecord->bzID;
+
+                    MatchParticipant currentPlayer(playerRecord.get());
+
+                    currentPlayer.teamName = getTeamMotto(bzid);
+                    currentPlayer.startTime = currentPlayer.lastDeathTime = bz_getCurrentTime();
+
+                    currentMatch->addParticipant(currentPlayer);
+
+                    // Some helpful debug messages
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Adding player '%s' to roll call...", currentPlayer.callsign.c_str());
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   BZID       : %s", currentPlayer.bzID.c_str());
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   IP Address : %s", currentPlayer.ipAddress.c_str());
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Name  : %s", currentPlayer.teamName.c_str());
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Color : %s", formatTeam(currentPlayer.teamColor).c_str());
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Start Time : %0.f", currentPlayer.startTime);
+                }
+            }
+        }
+        break;
+
+        case bz_eGetAutoTeamEvent:
+        {
+            bz_GetAutoTeamEventData_V1* autoTeamData = (bz_GetAutoTeamEventData_V1*)eventData;
+
+            // Only step in when bzfs picked a team this server has no room on at all, and then put the player on
+            // whichever of our two teams keeps the teams the most even
+            if (bz_getTeamPlayerLimit(autoTeamData->team) != 0)
+            {
+                break;
+            }
+
+            std::unique_ptr<bz_BasePlayerRecord> playerData(bz_getPlayerByIndex(autoTeamData->playerID));
+            float rating = (playerData) ? matchHistory.getRating(playerData->bzID.c_str()) : MatchHistory::INITIAL_RATING;
+
+            // A player who is already on a team isn't weighed against themselves
+            teamBalancer.remove(autoTeamData->playerID);
+
+            bz_eTeamType team = teamBalancer.pick(TEAM_ONE, bz_getTeamCount(TEAM_ONE) < bz_getTeamPlayerLimit(TEAM_ONE),
+                                                  TEAM_TWO, bz_getTeamCount(TEAM_TWO) < bz_getTeamPlayerLimit(TEAM_TWO), rating);
+
+            if (team != eNoTeam)
+            {
+                autoTeamData->handled = true;
+                autoTeamData->team = team;
+
+                teamBalancer.add(autoTeamData->playerID, team, rating);
+
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Auto team picked %s for a player rated %.0f (strength %.0f vs %.0f).",
+                                 formatTeam(team).c_str(), rating, teamBalancer.getStrength(TEAM_ONE), teamBalancer.getStrength(TEAM_TWO));
+            }
+        }
+        break;
+
+        case bz_eGetPlayerMotto: // This event is called when the player joins. It gives us the motto of the player
+        {
+            bz_GetPlayerMottoData_V2* mottoData = (bz_GetPlayerMottoData_V2*)eventData;
+
+            if (!DISABLE_MOTTO)
+            {
+                mottoData->motto = getPlayerMotto(mottoData->record->bzID.c_str());
+            }
+        }
+        break;
+
+        case bz_ePlayerDieEvent:
+        {
+            bz_PlayerDieEventData_V1 *dieData = (bz_PlayerDieEventData_V1*)eventData;
+
+            // Use the roster's slot index instead of a player record so a death doesn't allocate anything
+            MatchParticipant *player = (currentMatch != NULL) ? currentMatch->findParticipant(dieData->playerID) : NULL;
+
+            if (player)
+            {
+                player->lastDeathTime = bz_getCurrentTime();
+                player->checkpointDirty = true;
+            }
+
+            if (currentMatch != NULL)
+            {
+                currentMatch->heatmap.add(MatchHeatmap::eDeaths, dieData->state.pos);
+            }
+        }
+        break;
+
+        case bz_ePlayerJoinEvent: // This event is called each time a player joins the game
+        {
+            bz_PlayerJoinPartEventData_V1* joinData = (bz_PlayerJoinPartEventData_V1*)eventData;
+
+            teamBalancer.add(joinData->playerID, joinData->record->team, matchHistory.getRating(joinData->record->bzID.c_str()));
+
+            // We stop watching for file changes while the server is empty, so catch up on anything we missed
+            if (!timers.isScheduled(watcherTimer))
+            {
+                checkWatchers();
+                startWatcherTimer();
+            }
+
+            // Only notify a player if they exist, have joined the observer team, and there is a match in progress
+            if ((bz_isCountDownActive() || bz_isCountDownInProgress()) && isValidPlayerID(joinData->playerID) && joinData->record->team == eObservers)
+            {
+                bz_sendTextMessagef(BZ_SERVER, joinData->playerID, "*** There is currently %s match in progress, please be respectful. ***",
+                                    ((currentMatch->isOfficialMatch) ? "an official" : "a fun"));
+            }
+
+            // Let referees know there's an interrupted match waiting for them to review
+            if (recoveredMatch && bz_hasPerm(joinData->playerID, "ban"))
+            {
+                bz_sendTextMessage(BZ_SERVER, joinData->playerID, "A match interrupted by a server restart was recovered. Use /lorecover to review it.");
+            }
+
+            if (!DISABLE_MOTTO)
+            {
+                uint32_t bzID;
+
+                // Only send a URL job if the user is verified and we haven't recently asked about them
+                if (joinData->record->verified && parseBZID(joinData->record->bzID.c_str(), bzID) && !mottoCache.lookup(bzID, bz_getCurrentTime()))
+                {
+                    requestTeamName(joinData->record->callsign.c_str(), joinData->record->bzID.c_str());
+                }
+            }
+
+            if (bz_isCountDownActive() && joinData->record->team != eObservers && currentMatch->matchRoster.count(joinData->record->bzID))
+            {
+                // A participant has come back to the match, so pick up their playing time where they left off
+                MatchParticipant &player = currentMatch->matchRoster[joinData->record->bzID];
+
+                player.slotID = joinData->playerID;
+                player.resumePlaying();
+                currentMatch->setParticipantSlot(joinData->playerID, &player);
+
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s has rejoined the match with %.0f seconds of playing time",
+                                 player.callsign.c_str(), player.totalPlayTime);
+            }
+            else if (bz_isCountDownActive() && joinData->record->team != eObservers)
+            {
+                MatchParticipant player(joinData->record);
+
+                player.startTime = player.lastDeathTime = bz_getCurrentTime();
+                player.teamName  = getTeamMotto(joinData->record->bzID);
+
+                currentMatch->addParticipant(player);
+
+                // Some helpful debug messages
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Adding player '%s' to roll call...", player.callsign.c_str());
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   BZID       : %s", player.bzID.c_str());
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   IP Address : %s", player.ipAddress.c_str());
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Name  : %s", player.teamName.c_str());
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Team Color : %s", formatTeam(player.teamColor).c_str());
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer ::   Start Time : %0.f", player.startTime);
+            }
+
+            if (currentMatch && getMatchProgress() >= 30)
+            {
+                bz_setPlayerSpawnAtBase(joinData->playerID, false);
+            }
+        }
+        break;
+
+        case bz_ePlayerPartEvent:
+        {
+            bz_PlayerJoinPartEventData_V1 *partData = (bz_PlayerJoinPartEventData_V1*)eventData;
+            MatchParticipant *participant = (currentMatch != NULL) ? currentMatch->findParticipant(partData->playerID) : NULL;
+
+            teamBalancer.remove(partData->playerID);
+
+            if (currentMatch != NULL)
+            {
+                currentMatch->finishFlagCarry(partData->playerID, bz_getCurrentTime());
+            }
+
+            if (participant && partData->record->team != eObservers)
+            {
+                participant->updatePlayingTime(partData->record->team);
+
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s has left with %.0f seconds of playing time",
+                                 participant->callsign.c_str(), participant->totalPlayTime);
+            }
+
+            // This slot may be handed to someone else, so it no longer belongs to the participant
+            if (currentMatch != NULL)
+            {
+                currentMatch->setParticipantSlot(partData->playerID, NULL);
+            }
+        }
+        break;
+
+        case bz_ePlayerSpawnEvent:
+        {
+            bz_PlayerSpawnEventData_V1 *spawnData = (bz_PlayerSpawnEventData_V1*)eventData;
+
+            // Catch a player who has switched teams since we last saw them
+            teamBalancer.move(spawnData->playerID, spawnData->team);
+
+            // Use the roster's slot index instead of a player record so a spawn doesn't allocate anything
+            MatchParticipant *player = (currentMatch != NULL) ? currentMatch->findParticipant(spawnData->playerID) : NULL;
+
+            if (player)
+            {
+                if (!player->hasSpawned)
+                {
+                    currentMatch->invalidateStatus();
+                }
+
+                player->hasSpawned = true;
+                player->totalIdleTime += std::max(0.0, (bz_getCurrentTime() - player->lastDeathTime - (bzdb.explodeTime * 1.5)));
+                player->checkpointDirty = true;
+            }
+
+            if (currentMatch != NULL)
+            {
+                currentMatch->heatmap.add(MatchHeatmap::eSpawns, spawnData->state.pos);
+            }
+        }
+        break;
+
+        case bz_eTeamScoreChanged:
+        {
+            bz_TeamScoreChangeEventData_V1* teamScoreChange = (bz_TeamScoreChangeEventData_V1*)eventData;
+
+            // We only need to keep track of the store if it's a match
+            if (currentMatch != NULL && teamScoreChange->element == bz_eLosses)
+            {
+                (teamScoreChange->team == TEAM_ONE) ? currentMatch->teamTwoPoints++ : currentMatch->teamOnePoints++;
+                currentMatch->invalidateStatus();
+
+                // Don't bother formatting messages that won't be shown
+                if (bz_getDebugLevel() >= VERBOSE_LEVEL)
+                {
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s team scored.", formatTeam(teamScoreChange->team).c_str());
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s Match Score %s [%i] vs %s [%i]",
+                                     (currentMatch->isOfficialMatch) ? "Official" : "Fun",
+                                     formatTeam(TEAM_ONE).c_str(), currentMatch->teamOnePoints,
+                                     formatTeam(TEAM_TWO).c_str(), currentMatch->teamTwoPoints);
+                }
+            }
+        }
+        break;
+
+        case bz_eTickEvent: // This event is called once for each BZFS main loop, but only while we have something to do
+        {
+            // Apply whatever the worker thread has finished since the last tick
+            worker.runCompletions();
+
+            // Move our own requests to the league website along, if we're the ones sending them
+            httpClient.poll();
+            sidecar.poll(bz_getCurrentTime());
+            urlJobsFinished.clear();
+
+            // Hand the next queued request to bzfs once the previous one has been answered. This isn't done from
+            // the URL callbacks themselves since bzfs is in the middle of walking its own job list then
+            dispatchURLJobs();
+
+            timers.advance(bz_getCurrentTime());
+        }
+        break;
+
+        default: break;
+    }
+
+    updateTickEvent();
+}
+
+bool LeagueOverseer::SlashCommand (int playerID, bz_ApiString command, bz_ApiString /*message*/, bz_APIStringList *params)
+{
+    ASSERT_MAIN_THREAD();
+
+    ProfileScope profile(slashCommandProfile);
+
+    std::unique_ptr<bz_BasePlayerRecord> playerData(bz_getPlayerByIndex(playerID));
+
+    // For some reason, the player record could not be created
+    if (!playerData)
+    {
+        return true;
+    }
+
+    // Anyone may look at the score, including observers who aren't allowed to play
+    if (command == "matchstatus")
+    {
+        if (currentMatch == NULL)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is no match in progress.");
+            return true;
+        }
+
+        // Only rebuild the status when something it shows has changed since it was last asked for
+        if (currentMatch->statusExpires <= bz_getCurrentTime())
+        {
+            buildMatchStatus();
+        }
+
+        for (auto &line : currentMatch->statusLines)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, line.c_str());
+        }
+
+        // The clock is the one thing that changes all the time, so it's never cached
+        if (bz_isCountDownActive() && !bz_isCountDownPaused())
+        {
+            bz_sendTextMessagef(BZ_SERVER, playerID, "  Time left : %s", getMatchTime().c_str());
+        }
+
+        return true;
+    }
+
+    // If the player is not verified and does not have the spawn permission, they can't use any of the commands
+    if (!playerData->verified || !bz_hasPerm(playerID, "spawn"))
+    {
+        bz_sendTextMessagef(BZ_SERVER, playerID, "You do not have permission to run the /%s command.", command.c_str());
+        return true;
+    }
+
+    if (command == "cancel")
+    {
+        if (playerData->team == eObservers) // Observers can't cancel matches
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to cancel matches.");
+        }
+        else if (bz_isCountDownInProgress()) // Cancel the countdown if it's in progress
+        {
+            bz_cancelCountdown(playerID);
+
+            currentMatch = NULL;
+        }
+        else if (bz_isCountDownActive()) // We can only cancel a match if the countdown is active
+        {
+            // We're canceling an official match
+            if (currentMatch->isOfficialMatch)
+            {
+                currentMatch->canceled = true;
+                currentMatch->cancelationReason = "Official match cancellation requested by " + std::string(playerData->callsign.c_str());
+            }
+            else // Cancel the fun match like normal
+            {
+                bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Fun match ended by %s", playerData->callsign.c_str());
+            }
+
+            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Match ended by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+            bz_gameOver(253, eObservers);
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is no match in progress to cancel.");
+        }
+
+        return true;
+    }
+    else if (command == "countdown")
+    {
+        if (params->size() > 0)
+        {
+            if (params->get(0) == "pause")
+            {
+                bz_sendTextMessagef(BZ_SERVER, playerID, "** '/countdown pause' is disabled, please use /pause instead **");
+            }
+            else if (params->get(0) == "resume")
+            {
+                bz_sendTextMessagef(BZ_SERVER, playerID, "** '/countdown resume' is disabled, please use /resume instead **");
+            }
+            else if (params->get(0) == "cancel")
+            {
+                bz_sendTextMessagef(BZ_SERVER, playerID, "** '/countdown cancel' is disabled, please use /cancel instead **");
+            }
+            else
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "** '/countdown TIME' is disabled, please use /official or /fm instead **");
+            }
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "** '/countdown' is disabled, please use /official or /fm instead **");
+        }
+
+        return true;
+    }
+    else if (command == "finish")
+    {
+        if (playerData->team == eObservers) // Observers can't cancel matches
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to finish matches.");
+        }
+        else if (bz_isCountDownInProgress()) // Refer them to the /cancel command to stop a countdown
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "Use the /cancel command to cancel the countdown.");
+        }
+        else if (bz_isCountDownActive()) // Only finish if the countdown is active
+        {
+            // We can only '/finish' official matches because I wanted to have a command only dedicated to
+            // reporting partially completed matches
+            if (currentMatch->isOfficialMatch)
+            {
+                // Let's check if we can report the match, in other words, at least half of the match has been reported
+                if (getMatchProgress() >= currentMatch->duration / 2)
+                {
+                    bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Official match ended early by %s (%s)", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+                    bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Official match ended early by %s", playerData->callsign.c_str());
+
+                    bz_gameOver(253, eObservers);
+                }
+                else
+                {
+                    bz_sendTextMessage(BZ_SERVER, playerID, "Sorry, I cannot automatically report a match less than half way through.");
+                    bz_sendTextMessage(BZ_SERVER, playerID, "Please use the /cancel command and message a referee for review of this match.");
+                }
+            }
+            else
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "You cannot /finish a fun match. Use /cancel instead.");
+            }
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is no match in progress to end.");
+        }
+
+        return true;
+    }
+    else if (command == "fm")
+    {
+        if (playerData->team == eObservers) // Observers can't start matches
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to start matches.");
+        }
+        else if (currentMatch != NULL || bz_isCountDownActive() || bz_isCountDownInProgress()) // There is already a countdown
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is already a game in progress; you cannot start another.");
+        }
+        else // They are verified, not an observer, there is no match. So start one
+        {
+            currentMatch.reset(new CurrentMatch());
+            startMatchTimer();
+
+            // We signify an FM whenever the 'currentMatch' variable is set to NULL so set it to null
+            currentMatch->isOfficialMatch = false;
+
+            // Log the actions
+            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Fun match started by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+            bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Fun match started by %s.", playerData->callsign.c_str());
+
+            // The amount of seconds the countdown should take
+            int timeToStart = (params->size() == 1) ? atoi(params->get(0).c_str()) : 10;
+
+            // Sanity check...
+            if (timeToStart <= 60 && timeToStart >= 10)
+            {
+                bz_startCountdown(timeToStart, bz_getTimeLimit(), "Server"); // Start the countdown with a custom countdown time limit under 1 minute
+            }
+            else
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "Holy sanity check, Batman! Let's not have a countdown last longer than 60 seconds or less than 10.");
+                bz_startCountdown(10, bz_getTimeLimit(), "Server"); // Start the countdown for the official match
+            }
+        }
+
+        return true;
+    }
+    else if (command == "gameover")
+    {
+        bz_sendTextMessagef(BZ_SERVER, playerID, "** '/gameover' is disabled, please use /finish or /cancel instead **");
+
+        return true;
+    }
+    else if (command == "history")
+    {
+        if (!matchHistory.isOpen())
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "This server does not keep a match history.");
+            return true;
+        }
+
+        // Look the player up among the players on the server first, then by BZID and finally by the callsign they
+        // last played a match under
+        std::string target = (params->size() > 0) ? params->get(0).c_str() : playerData->callsign.c_str();
+        std::string bzID;
+
+        std::unique_ptr<bz_BasePlayerRecord> targetData(bz_getPlayerBySlotOrCallsign(target.c_str()));
+        uint32_t parsedBZID;
+
+        if (targetData && !targetData->bzID.empty())
+        {
+            bzID = targetData->bzID.c_str();
+        }
+        else if (parseBZID(target, parsedBZID))
+        {
+            bzID = target;
+        }
+        else
+        {
+            bzID = matchHistory.findCallsign(target);
+        }
+
+        std::vector<const MatchHistory::Match*> matches = matchHistory.findPlayer(bzID, 5);
+
+        if (matches.empty() || !parseBZID(bzID, parsedBZID))
+        {
+            bz_sendTextMessagef(BZ_SERVER, playerID, "No matches found for %s.", target.c_str());
+            return true;
+        }
+
+        bz_sendTextMessagef(BZ_SERVER, playerID, "Last %d matches of %s [%s]", (int)matches.size(), target.c_str(), bzID.c_str());
+
+        for (auto match : matches)
+        {
+            const MatchHistory::Player *player = &match->players.front();
+
+            // The index only lists matches the player was in, so this always finds them
+            for (auto &entry : match->players)
+            {
+                uint32_t entryBZID;
+
+                if (parseBZID(entry.bzID, entryBZID) && entryBZID == parsedBZID)
+                {
+                    player = &entry;
+                    break;
+                }
+            }
+
+            char matchDate[20];
+            time_t finishedAt = (time_t)match->finishedAt;
+            strftime(matchDate, sizeof(matchDate), "%Y-%m-%d %H:%M", gmtime(&finishedAt));
+
+            bz_sendTextMessagef(BZ_SERVER, playerID, "  #%-5u %s  %-8s %s %d - %d %s  played %s for %.0f seconds, %s", match->id, matchDate,
+                                (match->official) ? "official" : "fun",
+                                formatTeam((bz_eTeamType)match->teamOneColor).c_str(), match->teamOnePoints,
+                                match->teamTwoPoints, formatTeam((bz_eTeamType)match->teamTwoColor).c_str(),
+                                formatTeam((bz_eTeamType)player->team).c_str(), player->playTime, REPORT_STATUS_NAMES[match->status]);
+        }
+
+        return true;
+    }
+    else if (command == "lastmatch")
+    {
+        const MatchHistory::Match *match = matchHistory.last();
+
+        if (!matchHistory.isOpen())
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "This server does not keep a match history.");
+        }
+        else if (match == NULL)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "No matches have been played on this server yet.");
+        }
+        else
+        {
+            sendMatchSummary(playerID, *match);
+        }
+
+        return true;
+    }
+    else if (command == "replays")
+    {
+        int type = -1;
+
+        if (!replayCatalog.isOpen())
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "This server does not keep a replay catalog.");
+            return true;
+        }
+
+        if (params->size() > 0)
+        {
+            type = (params->get(0) == "official") ? ReplayCatalog::eOfficialReplay : (params->get(0) == "fun") ? ReplayCatalog::eFunReplay : -2;
+
+            if (type == -2)
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "Usage: /replays [official|fun]");
+                return true;
+            }
+        }
+
+        // Everything shown here comes from the catalog in memory; the recording directory is never looked at
+        std::vector<const ReplayCatalog::Replay*> replays = replayCatalog.list(10, type);
+
+        if (replays.empty())
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "No replays found.");
+            return true;
+        }
+
+        bz_sendTextMessagef(BZ_SERVER, playerID, "Last %d of %d replays (%.1f MB in total)", (int)replays.size(), (int)replayCatalog.size(),
+                            replayCatalog.totalSize() / (1024.0 * 1024.0));
+
+        for (auto replay : replays)
+        {
+            char savedDate[20];
+            time_t savedAt = (time_t)replay->savedAt;
+            strftime(savedDate, sizeof(savedDate), "%Y-%m-%d %H:%M", gmtime(&savedAt));
+
+            std::string teams;
+
+            if (replay->type == ReplayCatalog::eOfficialReplay)
+            {
+                teams = replay->teamOneName + " vs " + replay->teamTwoName;
+            }
+            else if (replay->type == ReplayCatalog::eFunReplay)
+            {
+                teams = formatTeam((bz_eTeamType)replay->teamOneColor) + " vs " + formatTeam((bz_eTeamType)replay->teamTwoColor);
+            }
+
+            bz_sendTextMessagef(BZ_SERVER, playerID, "  %s  %-8s %6.1f MB  %s  %s", savedDate, ReplayCatalog::TYPE_NAMES[replay->type],
+                                replay->size / (1024.0 * 1024.0), replay->fileName.c_str(), teams.c_str());
+        }
+
+        return true;
+    }
+    else if (command == "loprofile")
+    {
+        if (!playerData->admin)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "You do not have permission to use the /loprofile command.");
+        }
+        else if (params->size() > 0 && params->get(0) == "reset")
+        {
+            for (int i = 0; i < bz_eLastEvent; i++)
+            {
+                eventProfiles[i].reset();
+            }
+
+            for (int i = 0; i < URL_JOB_TYPE_COUNT; i++)
+            {
+                urlCallbackProfiles[i].reset();
+            }
+
+            slashCommandProfile.reset();
+
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s has reset the handler profiles.", playerData->callsign.c_str());
+            bz_sendTextMessage(BZ_SERVER, playerID, "League Overseer handler profiles have been reset.");
+        }
+        else if (params->size() > 0)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "/loprofile [reset]");
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "League Overseer handler timings (nanoseconds)");
+            bz_sendTextMessage(BZ_SERVER, playerID, "Handler                    Calls        p50        p99        max");
+
+            for (int i = 0; i < bz_eLastEvent; i++)
+            {
+                if (eventTypeName(i))
+                {
+                    sendProfile(playerID, eventTypeName(i), eventProfiles[i]);
+                }
+            }
+
+            for (int i = 0; i < URL_JOB_TYPE_COUNT; i++)
+            {
+                sendProfile(playerID, (std::string("URL ") + URL_JOB_NAMES[i]).c_str(), urlCallbackProfiles[i]);
+            }
+
+            sendProfile(playerID, "SlashCommand", slashCommandProfile);
+        }
+
+        return true;
+    }
+    else if (command == "lorecover")
+    {
+        if (!bz_hasPerm(playerID, "ban"))
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "You do not have permission to use the /lorecover command.");
+        }
+        else if (!recoveredMatch)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is no interrupted match to recover.");
+        }
+        else if (params->size() > 0 && params->get(0) == "discard")
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Recovered match discarded by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+            bz_sendTextMessage(BZ_SERVER, playerID, "The recovered match has been discarded.");
+
+            recoveredMatch = NULL;
+            std::remove((CHECKPOINT_PATH + ".recovered").c_str());
+        }
+        else if (params->size() > 0 && params->get(0) == "report")
+        {
+            if (currentMatch != NULL || bz_isCountDownActive() || bz_isCountDownInProgress())
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "A recovered match cannot be reported while another match is in progress.");
+            }
+            else
+            {
+                bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Partial report of a recovered match approved by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+                bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Partial report of an interrupted match approved by %s.", playerData->callsign.c_str());
+
+                // The match is reported as having ended at the time of its last checkpoint
+                struct tm *checkpointTime = gmtime(&recoveredAt);
+                bz_Time standardTime;
+
+                standardTime.year   = checkpointTime->tm_year + 1900;
+                standardTime.month  = checkpointTime->tm_mon + 1;
+                standardTime.day    = checkpointTime->tm_mday;
+                standardTime.hour   = checkpointTime->tm_hour;
+                standardTime.minute = checkpointTime->tm_min;
+                standardTime.second = checkpointTime->tm_sec;
+
+                currentMatch = std::move(recoveredMatch);
+                uint32_t historyID = recordMatch(recoveredAt, "", recoveredMapName, true);
+                reportMatch(standardTime, "", recoveredMapName, historyID);
+                currentMatch = NULL;
+
+                std::remove((CHECKPOINT_PATH + ".recovered").c_str());
+            }
+        }
+        else if (params->size() > 0)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "/lorecover [report|discard]");
+        }
+        else
+        {
+            char checkpointDate[20];
+            strftime(checkpointDate, sizeof(checkpointDate), "%Y-%m-%d %H:%M:%S", gmtime(&recoveredAt));
+
+            bz_sendTextMessagef(BZ_SERVER, playerID, "Interrupted %s match, last saved %s UTC", (recoveredMatch->isOfficialMatch) ? "official" : "fun", checkpointDate);
+            bz_sendTextMessagef(BZ_SERVER, playerID, "  Progress : %d of %.0f minutes", recoveredProgress / 60, recoveredMatch->duration / 60);
+            bz_sendTextMessagef(BZ_SERVER, playerID, "  Score    : %s %d - %d %s", formatTeam(TEAM_ONE).c_str(), recoveredMatch->teamOnePoints, recoveredMatch->teamTwoPoints, formatTeam(TEAM_TWO).c_str());
+
+            for (auto &kv : recoveredMatch->matchRoster)
+            {
+                MatchParticipant &player = kv.second;
+
+                bz_sendTextMessagef(BZ_SERVER, playerID, "  %-7s %s [%s] %.0f seconds", formatTeam(player.getLoyalty(TEAM_ONE, TEAM_TWO)).c_str(),
+                                    player.callsign.c_str(), player.bzID.c_str(), player.estimatedPlayTime());
+            }
+
+            bz_sendTextMessage(BZ_SERVER, playerID, "Use '/lorecover report' to report it as it stood or '/lorecover discard' to throw it away.");
+        }
+
+        return true;
+    }
+    else if (command == "loreload")
+    {
+        if (!playerData->admin)
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "You do not have permission to use the /loreload command.");
+        }
+        else
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: %s (%s) requested a configuration reload.", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+
+            if (reloadConfig())
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "League Overseer configuration reloaded.");
+            }
+            else
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "The configuration file contains errors and was not reloaded; see the server logs.");
+            }
+        }
+
+        return true;
+    }
+    else if (command == "offi" || command == "official")
+    {
+        if (playerData->team == eObservers) // Observers can't start matches
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "Observers are not allowed to start matches.");
+        }
+        else if (bz_getTeamCount(TEAM_ONE) < 2 || bz_getTeamCount(TEAM_TWO) < 2) // An official match cannot be 1v1 or 2v1
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "You may not have an official match with less than 2 players per team.");
+        }
+        else if (currentMatch != NULL || bz_isCountDownActive() || bz_isCountDownInProgress()) // A countdown is in progress already
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is already a game in progress; you cannot start another.");
+        }
+        else // They are verified non-observer with valid team sizes and no existing match. Start one!
+        {
+            currentMatch.reset(new CurrentMatch());
+            startMatchTimer();
+
+            // Log the actions so admins can bug brad to look at detailed information
+            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Official match started by %s (%s).", playerData->callsign.c_str(), playerData->ipAddress.c_str());
+            bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "Official match started by %s.", playerData->callsign.c_str());
+
+            // The amount of seconds the countdown should take
+            int timeToStart = (params->size() == 1) ? atoi(params->get(0).c_str()) : 10;
+
+            // Sanity check...
+            if (timeToStart <= 60 && timeToStart >= 10)
+            {
+                bz_startCountdown(timeToStart, bz_getTimeLimit(), "Server"); // Start the countdown with a custom countdown time limit under 1 minute
+            }
+            else
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "Holy sanity check, Batman! Let's not have a countdown last longer than 60 seconds or less than 10.");
+                bz_startCountdown(10, bz_getTimeLimit(), "Server"); // Start the countdown for the official match
+            }
+        }
+
+        return true;
+    }
+    else if (command == "pause")
+    {
+        if (bz_isCountDownPaused())
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "The match is already paused!");
+        }
+        else if (bz_isCountDownActive())
+        {
+            bz_pauseCountdown(playerData->callsign.c_str());
+
+            // We've paused an official match, so we need to delay the approxTimeProgress in order to calculate the roll call time properly
+            currentMatch->matchPaused = time(NULL);
+            currentMatch->invalidateStatus();
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match paused at %s by %s.", getMatchTime().c_str(), playerData->callsign.c_str());
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is no active match to pause right now.");
+        }
+
+        return true;
+    }
+    else if (command == "resume")
+    {
+        if (!bz_isCountDownPaused())
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "The match is not paused!");
+        }
+        else if (bz_isCountDownActive())
+        {
+            bz_resumeCountdown(playerData->callsign.c_str());
+
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match resumed by %s.", playerData->callsign.c_str());
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "There is no active match to resume right now.");
+        }
+
+        return true;
+    }
+    else if (command == "spawn")
+    {
+        if (bz_hasPerm(playerID, "ban"))
+        {
+            if (params->size() > 0)
+            {
+                bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: %s has executed the /spawn command.", playerData->callsign.c_str());
+
+                std::unique_ptr<bz_BasePlayerRecord> target(bz_getPlayerBySlotOrCallsign(params->get(0).c_str()));
+
+                if (target)
+                {
+                    bz_grantPerm(target->playerID, "spawn");
+                    bz_sendTextMessagef(BZ_SERVER, eAdministrators, "%s granted %s the ability to spawn.", playerData->callsign.c_str(), target->callsign.c_str());
+
+                }
+                else
+                {
+                    bz_sendTextMessagef(BZ_SERVER, playerID, "player %s not found", params->get(0).c_str());
+                }
+            }
+            else
+            {
+                bz_sendTextMessage(BZ_SERVER, playerID, "/spawn <player id or callsign>");
+            }
+        }
+        else
+        {
+            bz_sendTextMessage(BZ_SERVER, playerID, "You do not have permission to use the /spawn command.");
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+// We got a response from one of our URL jobs
+void LeagueOverseer::URLDone(const char* /*URL*/, const void* data, unsigned int /*size*/, bool /*complete*/)
+{
+    ASSERT_MAIN_THREAD();
+
+    // Convert the data we get from the URL job to a std::string
+    std::string siteData = (const char*)(data);
+    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: URL Job returned: %s", siteData.c_str());
+
+    // The returned data starts with a '{' and ends with a '}' so chances are it's JSON data
+    if (!siteData.empty() && siteData.at(0) == '{' && siteData.at(siteData.length() - 1) == '}')
+    {
+        // Parsing a team dump and publishing it to the shared cache is slow, so it's done on the worker thread
+        // and the result is applied to our tables once it comes back
+        std::shared_ptr<MottoResponse> response = std::make_shared<MottoResponse>();
+        std::string sharedPath = (sharedMottos.isOpen()) ? SHARED_MOTTO_CACHE : "";
+
+        response->data.swap(siteData);
+        response->keepMottos = (bz_getDebugLevel() >= VERBOSE_LEVEL);
+
+        worker.submit([response, sharedPath]()
+        {
+            // The team dump is parsed straight into a table so the main thread only has to swap it in
+            parseMottoResponse(*response);
+
+            // Publish a complete team dump to the shared cache through a mapping of our own so the worker doesn't
+            // share any state with the main thread
+            if (response->dumpedTable && !sharedPath.empty())
+            {
+                SharedMottoCache publisher;
+                response->published = publisher.open(sharedPath) && publisher.publish(*response->dumpedTable, time(NULL));
+
+                if (response->published)
+                {
+                    response->dumpedTable.reset();
+                }
+            }
+        },
+        [this, response]()
+        {
+            applyMottoResponse(*response);
+        });
+    }
+    else if (siteData.find("<html>") == std::string::npos)
+    {
+        std::vector<std::string> lines = tokenize(siteData.c_str(), "\n", 0, false);
+
+        for (auto line : lines)
+        {
+            bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "%s", line.c_str());
+            bz_debugMessagef(DEBUG_LEVEL, "%s", line.c_str());
+        }
+    }
+}
+
+// Store the team names from a response the worker thread has finished parsing
+void LeagueOverseer::applyMottoResponse(const MottoResponse &response)
+{
+    ASSERT_MAIN_THREAD();
+
+    if (!response.valid)
+    {
+        bz_debugMessage(DEBUG_LEVEL, "WARNING :: League Overseer :: The league website sent a team name response that could not be read.");
+        return;
+    }
+
+    if (response.dumpedMembers > 0)
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Team dump JSON data received with %d BZIDs.", (int)response.dumpedMembers);
+
+        // A team dump that was published to the shared cache is read from there, so our own copy of an older dump
+        // would only hide the newer entries; otherwise the new dump replaces ours as a whole
+        if (response.published)
+        {
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Team dump of %d BZIDs published to the shared motto cache.", (int)response.dumpedMembers);
+            replaceTeamMottos(std::make_shared<MottoTable>());
+        }
+        else if (response.dumpedTable)
+        {
+            replaceTeamMottos(response.dumpedTable);
+
+            if (bz_getDebugLevel() >= VERBOSE_LEVEL)
+            {
+                for (auto &kv : response.dumpedMottos)
+                {
+                    bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: BZID %s set to team %s.", kv.first.c_str(), kv.second.c_str());
+                }
+            }
+        }
+    }
+
+    // We have both a BZID and a team name so let's update our team motto map
+    // If the team name is an empty string, the player is teamless. We still keep their entry so it replaces the team
+    // they may have recently left in the team dump, and so we don't ask about them again on every join.
+    uint32_t bzID;
+
+    if (parseBZID(response.bzID, bzID))
+    {
+        double ttl = (response.teamName.empty()) ? MOTTO_CACHE_NEGATIVE_TTL : MOTTO_CACHE_TTL;
+        mottoCache.store(bzID, response.teamName, bz_getCurrentTime() + ttl);
+
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Motto saved for BZID %s.", response.bzID.c_str());
+    }
+}
+
+// Swap in a new generation of the team dump. Every reader is on the main thread, so a lookup sees either the
+// old table or the new one and never one that's half built. The old table is handed to the worker to be freed
+// since freeing a large one takes a while.
+void LeagueOverseer::replaceTeamMottos(std::shared_ptr<const MottoTable> table)
+{
+    ASSERT_MAIN_THREAD();
+
+    std::shared_ptr<const MottoTable> retired = std::move(teamMottos);
+    teamMottos = std::move(table);
+
+    worker.submit([retired]() mutable { retired.reset(); });
+}
+
+// The league website is down or is not responding, the request timed out
+void LeagueOverseer::URLTimeout(const char* /*URL*/, int /*errorCode*/)
+{
+    bz_debugMessage(DEBUG_LEVEL, "WARNING :: League Overseer :: The request to the league site has timed out.");
+}
+
+// The server owner must have set up the URLs wrong because this shouldn't happen
+void LeagueOverseer::URLError(const char* /*URL*/, int errorCode, const char *errorString)
+{
+    bz_debugMessage(DEBUG_LEVEL, "ERROR :: League Overseer :: Match report failed with the following error:");
+    bz_debugMessagef(DEBUG_LEVEL, "ERROR :: League Overseer :: Error code: %i - %s", errorCode, errorString);
+}
+
+// Identifies a match checkpoint file and the version of its layout
+const uint32_t CHECKPOINT_MAGIC = 0x4c4f4350; // "LOCP"
+const uint16_t CHECKPOINT_VERSION = 3;
+
+// Save everything we need to report the current match to CHECKPOINT_PATH. Each participant's record is
+// only rebuilt if they changed since the last checkpoint, and the file is replaced atomically so a crash
+// while writing leaves the previous checkpoint intact.
+void LeagueOverseer::writeCheckpoint()
+{
+    BinaryWriter writer;
+    bool paused = bz_isCountDownPaused();
+
+    writer.write(CHECKPOINT_MAGIC);
+    writer.write(CHECKPOINT_VERSION);
+    writer.write<int64_t>(time(NULL));
+    writer.write(bz_getCurrentTime());
+    writer.write<int32_t>(getMatchProgress());
+    writer.write<uint8_t>(currentMatch->isOfficialMatch);
+    writer.write<uint8_t>(paused);
+    writer.write<int64_t>(paused ? currentMatch->matchPaused : 0);
+    writer.write<int32_t>(TEAM_ONE);
+    writer.write<int32_t>(TEAM_TWO);
+    writer.write<int32_t>(currentMatch->teamOnePoints);
+    writer.write<int32_t>(currentMatch->teamTwoPoints);
+    writer.write(currentMatch->duration);
+    writer.writeString(currentMatch->teamOneName);
+    writer.writeString(currentMatch->teamTwoName);
+    writer.writeString(MAP_NAME);
+    writer.write<uint32_t>(currentMatch->matchRoster.size());
+
+    for (auto &kv : currentMatch->matchRoster)
+    {
+        writer.buffer += kv.second.getCheckpointRecord();
+    }
+
+    writeFileInBackground(CHECKPOINT_PATH, writer.buffer, "a match checkpoint");
+}
+
+// Look for a checkpoint left behind by a match that never ended, which means the server went down in the
+// middle of it. The match is kept around for a referee to report or discard with /lorecover.
+void LeagueOverseer::loadCheckpoint()
+{
+    if (CHECKPOINT_PATH.empty())
+    {
+        return;
+    }
+
+    // Move an orphaned checkpoint out of the way so the next match doesn't overwrite it
+    std::string recoveredPath = CHECKPOINT_PATH + ".recovered";
+    std::string contents;
+
+    if (getModificationTime(CHECKPOINT_PATH) != 0)
+    {
+        std::remove(recoveredPath.c_str());
+        std::rename(CHECKPOINT_PATH.c_str(), recoveredPath.c_str());
+    }
+
+    if (!readFile(recoveredPath, contents))
+    {
+        return;
+    }
+
+    BinaryReader reader(contents);
+    std::unique_ptr<CurrentMatch> match(new CurrentMatch());
+
+    // A checkpoint we can't read is set aside once so it isn't complained about every time the plugin is loaded
+    std::string corruptPath = CHECKPOINT_PATH + ".corrupt";
+
+    if (reader.read<uint32_t>() != CHECKPOINT_MAGIC || reader.read<uint16_t>() != CHECKPOINT_VERSION)
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: %s is not a match checkpoint this version can read, it has been moved to %s.", recoveredPath.c_str(), corruptPath.c_str());
+        std::remove(corruptPath.c_str());
+        std::rename(recoveredPath.c_str(), corruptPath.c_str());
+        return;
+    }
+
+    time_t checkpointTime    = (time_t)reader.read<int64_t>();
+    double checkpointClock   = reader.read<double>();
+    int    progress          = reader.read<int32_t>();
+    match->isOfficialMatch   = reader.read<uint8_t>() != 0;
+    bool   paused            = reader.read<uint8_t>() != 0;
+    time_t pausedAt          = (time_t)reader.read<int64_t>();
+    bz_eTeamType teamOne     = (bz_eTeamType)reader.read<int32_t>();
+    bz_eTeamType teamTwo     = (bz_eTeamType)reader.read<int32_t>();
+    match->teamOnePoints     = reader.read<int32_t>();
+    match->teamTwoPoints     = reader.read<int32_t>();
+    match->duration          = reader.read<double>();
+    match->teamOneName       = reader.readString();
+    match->teamTwoName       = reader.readString();
+    std::string mapName      = reader.readString();
+    uint32_t participants    = reader.read<uint32_t>();
+
+    for (uint32_t i = 0; i < participants && reader.good(); i++)
+    {
+        MatchParticipant player;
+
+        if (!player.readCheckpointRecord(reader))
+        {
+            break;
+        }
+
+        // Close out the session each player was in the middle of when the checkpoint was taken, leaving
+        // out the time the match had been paused for
+        if (player.hasSpawned && player.startTime >= 0)
+        {
+            double sessionPlaytime = std::max(0.0, checkpointClock - player.startTime - (paused ? difftime(checkpointTime, pausedAt) : 0));
+
+            player.totalPlayTime += sessionPlaytime;
+            player.startTime = -1;
+
+            if (isPlayingTeam(player.teamColor))
+            {
+                player.playTimeByTeam[player.teamColor] += sessionPlaytime;
+            }
+        }
+
+        match->matchRoster[player.bzID] = player;
+    }
+
+    if (!reader.good())
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The match checkpoint at %s is incomplete and cannot be recovered, it has been moved to %s.", recoveredPath.c_str(), corruptPath.c_str());
+        std::remove(corruptPath.c_str());
+        std::rename(recoveredPath.c_str(), corruptPath.c_str());
+        return;
+    }
+
+    if (teamOne != TEAM_ONE || teamTwo != TEAM_TWO)
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The match checkpoint at %s was played with different team colors and cannot be recovered.", recoveredPath.c_str());
+        return;
+    }
+
+    recoveredMatch    = std::move(match);
+    recoveredMapName  = mapName;
+    recoveredAt       = checkpointTime;
+    recoveredProgress = progress;
+
+    bz_debugMessagef(0, "WARNING :: League Overseer :: Recovered an interrupted %s match: %s %d - %d %s after %d seconds with %d participants.",
+                     (recoveredMatch->isOfficialMatch) ? "official" : "fun",
+                     formatTeam(TEAM_ONE).c_str(), recoveredMatch->teamOnePoints,
+                     recoveredMatch->teamTwoPoints, formatTeam(TEAM_TWO).c_str(),
+                     recoveredProgress, (int)recoveredMatch->matchRoster.size());
+    bz_debugMessage(0, "WARNING :: League Overseer :: A referee may report it with '/lorecover report' or discard it with '/lorecover discard'.");
+}
+
+// Report the current match to the league website, or explain why it can't be reported. The answer is recorded
+// against the match with the given history ID, if it has one
+void LeagueOverseer::reportMatch(bz_Time &standardTime, const std::string &replayFile, const std::string &mapPlayed, uint32_t historyID)
+{
+    if (currentMatch->canceled)
+    {
+        // The match was canceled for some reason so output the reason to both the players and the server logs
+
+        bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: %s", currentMatch->cancelationReason.c_str());
+        bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, currentMatch->cancelationReason.c_str());
+    }
+    else if (currentMatch->matchRoster.empty())
+    {
+        // Oops... I darn goofed. Somehow the players were not recorded properly
+
+        bz_debugMessage(DEBUG_LEVEL, "DEBUG :: League Overseer :: No recorded players for this official match.");
+        bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "Current match could not be reported due to not having a list of valid match participants.");
+    }
+    else
+    {
+        // This is a completed match (official or fm), so let's report it
+
+        // Format the date to -> year-month-day hour:minute:second
+        char matchDate[20];
+        sprintf(matchDate, "%02d-%02d-%02d %02d:%02d:%02d", standardTime.year, standardTime.month, standardTime.day, standardTime.hour, standardTime.minute, standardTime.second);
+
+        // Keep references to values for quick reference
+        std::string teamOnePointsFinal = intToString(currentMatch->teamOnePoints);
+        std::string teamTwoPointsFinal = intToString(currentMatch->teamTwoPoints);
+        std::string matchDuration      = intToString(currentMatch->duration/60);
+        std::string matchType          = (currentMatch->isOfficialMatch) ? "official" : "fm";
+
+        // Store match data in the logs
+        bz_debugMessagef(0, "Match Data :: League Overseer Match Report");
+        bz_debugMessagef(0, "Match Data :: -----------------------------");
+        bz_debugMessagef(0, "Match Data :: Match Time      : %s", matchDate);
+        bz_debugMessagef(0, "Match Data :: Duration        : %s", matchDuration.c_str());
+        bz_debugMessagef(0, "Match Data :: %s  Score  : %s", formatTeam(TEAM_ONE, true).c_str(), teamOnePointsFinal.c_str());
+        bz_debugMessagef(0, "Match Data :: %s  Score  : %s", formatTeam(TEAM_TWO, true).c_str(), teamTwoPointsFinal.c_str());
+
+        // Start building POST data to be sent to the league website
+        std::string matchToSend = "query=reportMatch";
+                    matchToSend += "&apiVersion="   + std::string(bz_urlEncode(intToString(API_VERSION).c_str()));
+                    matchToSend += "&matchType="    + std::string(bz_urlEncode(matchType.c_str()));
+                    matchToSend += "&teamOneColor=" + std::string(bz_urlEncode(formatTeam(TEAM_ONE).c_str()));
+                    matchToSend += "&teamTwoColor=" + std::string(bz_urlEncode(formatTeam(TEAM_TWO).c_str()));
+                    matchToSend += "&teamOneWins="  + std::string(bz_urlEncode(teamOnePointsFinal.c_str()));
+                    matchToSend += "&teamTwoWins="  + std::string(bz_urlEncode(teamTwoPointsFinal.c_str()));
+                    matchToSend += "&duration="     + std::string(bz_urlEncode(matchDuration.c_str()));
+                    matchToSend += "&matchTime="    + std::string(bz_urlEncode(matchDate));
+                    matchToSend += "&server="       + std::string(bz_urlEncode(bz_getPublicAddr().c_str()));
+                    matchToSend += "&port="         + std::string(bz_urlEncode(intToString(bz_getPublicPort()).c_str()));
+                    matchToSend += "&replayFile="   + std::string(bz_urlEncode(replayFile.c_str()));
+
+        // Only add this parameter if it's a rotational league such as Leagues United
+        if (ROTATION_LEAGUE)
+        {
+            matchToSend += "&mapPlayed=" + std::string(bz_urlEncode(mapPlayed.c_str()));
+        }
+
+        std::string teamOneBZIDs, teamOneIPs, teamOneFlagStats,
+                    teamTwoBZIDs, teamTwoIPs, teamTwoFlagStats;
+
+        buildPlayerStrings(TEAM_ONE, teamOneBZIDs, teamOneIPs, teamOneFlagStats);
+        buildPlayerStrings(TEAM_TWO, teamTwoBZIDs, teamTwoIPs, teamTwoFlagStats);
+
+        // Build a string of BZIDs and also output the BZIDs to the server logs while we're at it
+        matchToSend += "&teamOnePlayers=" + teamOneBZIDs;
+        matchToSend += "&teamTwoPlayers=" + teamTwoBZIDs;
+
+        // Send the IPs that players used during the match
+        matchToSend += "&teamOneIPs=" + teamOneIPs;
+        matchToSend += "&teamTwoIPs=" + teamTwoIPs;
+
+        // Send what each player did with the team flags, in the same order as their BZIDs
+        matchToSend += "&teamOneFlagStats=" + teamOneFlagStats;
+        matchToSend += "&teamTwoFlagStats=" + teamTwoFlagStats;
+
+        // Finish prettifying the server logs
+        bz_debugMessagef(0, "Match Data :: -----------------------------");
+        bz_debugMessagef(0, "Match Data :: End of Match Report");
+        bz_debugMessagef(0, "DEBUG :: League Overseer :: Reporting match data...");
+        bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "Reporting match...");
+
+        // Send the match data to the league website
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Post data submitted: %s", matchToSend.c_str());
+        addURLJob(eReportMatchJob, MATCH_REPORT_URL, matchToSend, historyID);
+    }
+}
+
+// Open the match history at MATCH_HISTORY_PATH, or close it if the option is empty
+void LeagueOverseer::openMatchHistory()
+{
+    // The IDs of reports still in flight belong to the history we're closing
+    for (auto &handler : urlJobsInFlight)
+    {
+        handler->matchID = 0;
+    }
+
+    for (auto &queue : urlJobQueues)
+    {
+        for (auto &job : queue)
+        {
+            job.matchID = 0;
+        }
+    }
+
+    matchHistory.close();
+
+    if (MATCH_HISTORY_PATH.empty())
+    {
+        return;
+    }
+
+    if (!matchHistory.open(MATCH_HISTORY_PATH))
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The match history at %s could not be opened.", MATCH_HISTORY_PATH.c_str());
+        return;
+    }
+
+    if (matchHistory.getSkipped() > 0)
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: %d records in the match history at %s could not be read and were skipped.", (int)matchHistory.getSkipped(), MATCH_HISTORY_PATH.c_str());
+    }
+
+    if (!matchHistory.isWritable())
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The match history at %s is damaged, only the matches before the damage were loaded and new matches will not be saved to it until it is repaired.", MATCH_HISTORY_PATH.c_str());
+    }
+}
+
+// Load the replay catalog, filling it with the replays already in REPLAY_PATH when it's new, and bring it
+// within its budgets
+void LeagueOverseer::openReplayCatalog()
+{
+    replayCatalog.close();
+
+    if (REPLAY_CATALOG_PATH.empty())
+    {
+        return;
+    }
+
+    if (!replayCatalog.open(REPLAY_CATALOG_PATH))
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The replay catalog at %s could not be opened.", REPLAY_CATALOG_PATH.c_str());
+        return;
+    }
+
+    if (replayCatalog.getSkipped() > 0)
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: %d records in the replay catalog at %s could not be read and were skipped.", (int)replayCatalog.getSkipped(), REPLAY_CATALOG_PATH.c_str());
+    }
+
+    // Replays can't be pruned without recording it, so a damaged catalog is only listed until it's repaired
+    if (!replayCatalog.isWritable())
+    {
+        bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The replay catalog at %s is damaged, only the replays before the damage were loaded and replays will not be cataloged or pruned until it is repaired.", REPLAY_CATALOG_PATH.c_str());
+        return;
+    }
+
+    // Replays that are gone are only dropped from the file when it's rewritten, so do it now rather than read
+    // them again on every start
+    if (replayCatalog.hasStaleRecords())
+    {
+        writeFileInBackground(replayCatalog.getPath(), replayCatalog.rewrite(), "the compacted replay catalog");
+    }
+
+    if (replayCatalog.size() == 0)
+    {
+        importReplays();
+    }
+    else
+    {
+        pruneReplays();
+    }
+}
+
+// Catalog the replays that were saved before there was a catalog. We know nothing about their matches, so they're
+// cataloged by the time they were last written to and pruned like fun match replays
+void LeagueOverseer::importReplays()
+{
+    std::string directory = REPLAY_PATH;
+    std::shared_ptr<std::vector<ReplayCatalog::Replay>> found = std::make_shared<std::vector<ReplayCatalog::Replay>>();
+
+    worker.submit([directory, found]()
+    {
+#ifndef _WIN32
+        DIR *dir = opendir(directory.c_str());
+
+        if (!dir)
+        {
+            return;
+        }
+
+        while (struct dirent *entry = readdir(dir))
+        {
+            std::string fileName = entry->d_name;
+
+            if (fileName.size() <= 4 || fileName.compare(fileName.size() - 4, 4, ".rec") != 0)
+            {
+                continue;
+            }
+
+            ReplayCatalog::Replay replay = ReplayCatalog::Replay();
+            std::string path = joinPath(directory, fileName);
+
+            replay.fileName     = fileName;
+            replay.savedAt      = getModificationTime(path);
+            replay.type         = ReplayCatalog::eUnknownReplay;
+            replay.teamOneColor = eNoTeam;
+            replay.teamTwoColor = eNoTeam;
+
+            if (hashFile(path, replay.size, replay.hash))
+            {
+                found->push_back(replay);
+            }
+        }
+
+        closedir(dir);
+
+        std::sort(found->begin(), found->end(), [](const ReplayCatalog::Replay &a, const ReplayCatalog::Replay &b)
+        {
+            return a.savedAt < b.savedAt;
+        });
+#endif
+    },
+    [this, found]()
+    {
+        if (!replayCatalog.isWritable())
+        {
+            return;
+        }
+
+        std::string records;
+
+        for (auto &replay : *found)
+        {
+            records += replayCatalog.add(replay);
+        }
+
+        if (!records.empty())
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Added %d existing replays to the replay catalog.", (int)found->size());
+            appendFileInBackground(replayCatalog.getPath(), records, "replays to the replay catalog");
+        }
+
+        pruneReplays();
+    });
+}
+
+// Add the replay of the match that just ended to the catalog once the worker has measured and hashed it
+void LeagueOverseer::catalogReplay(const std::string &fileName, time_t savedAt)
+{
+    if (!replayCatalog.isWritable() || currentMatch == NULL)
+    {
+        return;
+    }
+
+    std::shared_ptr<ReplayCatalog::Replay> replay = std::make_shared<ReplayCatalog::Replay>();
+    std::shared_ptr<bool> hashed = std::make_shared<bool>(false);
+    std::string path = joinPath(REPLAY_PATH, fileName);
+
+    replay->fileName     = fileName;
+    replay->savedAt      = savedAt;
+    replay->type         = (currentMatch->isOfficialMatch) ? ReplayCatalog::eOfficialReplay : ReplayCatalog::eFunReplay;
+    replay->teamOneColor = TEAM_ONE;
+    replay->teamTwoColor = TEAM_TWO;
+    replay->teamOneName  = currentMatch->teamOneName;
+    replay->teamTwoName  = currentMatch->teamTwoName;
+
+    worker.submit([path, replay, hashed]()
+    {
+        *hashed = hashFile(path, replay->size, replay->hash);
+    },
+    [this, path, replay, hashed]()
+    {
+        if (!*hashed)
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: Could not read the replay at %s to catalog it.", path.c_str());
+            return;
+        }
+
+        std::string record = (replayCatalog.isWritable()) ? replayCatalog.add(*replay) : "";
+
+        if (!record.empty())
+        {
+            appendFileInBackground(replayCatalog.getPath(), record, "a replay to the replay catalog");
+            pruneReplays();
+        }
+    });
+}
+
+// Delete the replays that no longer fit in the budgets. They're dropped from the catalog right away while the
+// worker deletes the files and then replaces the catalog file with one that only lists the replays that are left
+void LeagueOverseer::pruneReplays()
+{
+    if (!replayCatalog.isWritable())
+    {
+        return;
+    }
+
+    std::vector<std::string> expired = replayCatalog.findExpired(time(NULL), REPLAY_MAX_AGE * 86400, REPLAY_OFFICIAL_MAX_AGE * 86400,
+                                                                 (uint64_t)(REPLAY_MAX_SIZE * 1024 * 1024));
+
+    if (expired.empty())
+    {
+        return;
+    }
+
+    std::vector<std::string> paths;
+
+    for (auto &fileName : expired)
+    {
+        replayCatalog.remove(fileName);
+        paths.push_back(joinPath(REPLAY_PATH, fileName));
+    }
+
+    std::string catalog = replayCatalog.rewrite();
+    std::string catalogPath = replayCatalog.getPath();
+    std::shared_ptr<int> failed = std::make_shared<int>(0);
+    std::shared_ptr<bool> written = std::make_shared<bool>(false);
+
+    worker.submit([paths, catalog, catalogPath, failed, written]()
+    {
+        for (auto &path : paths)
+        {
+            if (std::remove(path.c_str()) != 0 && errno != ENOENT)
+            {
+                (*failed)++;
+            }
+        }
+
+        *written = writeFileAtomically(catalogPath, catalog);
+    },
+    [this, paths, catalogPath, failed, written]()
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Pruned %d replays to stay within the replay budgets.", (int)paths.size());
+
+        if (*failed > 0)
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: %d pruned replays could not be deleted from %s", *failed, REPLAY_PATH.c_str());
+        }
+
+        if (!*written)
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: Could not write the pruned replay catalog to %s", catalogPath.c_str());
+        }
+    });
+}
+
+// Add the current match to the match history. This must be called before the match is reported, and returns the
+// history ID the report should carry so it can find its way back to the match once the league website answers;
+// 0 when the match isn't waiting on a report.
+uint32_t LeagueOverseer::recordMatch(time_t finishedAt, const std::string &replayFile, const std::string &mapPlayed, bool reporting)
+{
+    if (!matchHistory.isOpen() || currentMatch == NULL)
+    {
+        return 0;
+    }
+
+    MatchHistory::Match match;
+
+    match.finishedAt    = finishedAt;
+    match.official      = currentMatch->isOfficialMatch;
+    match.teamOneColor  = TEAM_ONE;
+    match.teamTwoColor  = TEAM_TWO;
+    match.teamOnePoints = currentMatch->teamOnePoints;
+    match.teamTwoPoints = currentMatch->teamTwoPoints;
+    match.duration      = (int32_t)currentMatch->duration;
+    match.teamOneName   = currentMatch->teamOneName;
+    match.teamTwoName   = currentMatch->teamTwoName;
+    match.mapName       = mapPlayed;
+    match.replayFile    = replayFile;
+
+    // The same decisions reportMatch() makes about whether the match is sent at all
+    if (currentMatch->canceled)
+    {
+        match.status = eReportCanceled;
+    }
+    else if (!reporting || currentMatch->matchRoster.empty())
+    {
+        match.status = eReportSkipped;
+    }
+    else
+    {
+        match.status = eReportPending;
+    }
+
+    for (auto &kv : currentMatch->matchRoster)
+    {
+        MatchParticipant &participant = kv.second;
+        MatchHistory::Player player;
+
+        player.bzID     = participant.bzID;
+        player.callsign = participant.callsign;
+        player.team     = participant.getLoyalty(TEAM_ONE, TEAM_TWO);
+        player.playTime = participant.estimatedPlayTime();
+        player.counted  = participant.hasSpawned && participant.isEligible(currentMatch->isOfficialMatch, currentMatch->duration);
+
+        match.players.push_back(player);
+    }
+
+    appendMatchHistory(matchHistory.add(match));
+
+    // The match may have changed the ratings of players who are still on the server
+    for (int playerID = 0; playerID < MAX_PLAYER_SLOTS; playerID++)
+    {
+        MatchParticipant *participant = currentMatch->findParticipant(playerID);
+
+        if (participant)
+        {
+            teamBalancer.rate(playerID, matchHistory.getRating(participant->bzID.c_str()));
+        }
+    }
+
+    return (match.status == eReportPending) ? match.id : 0;
+}
+
+// Rebuild the team balancer from the players on the server and their current ratings, for when the plugin is
+// loaded on a server that already has players
+void LeagueOverseer::refreshTeamBalancer()
+{
+    std::unique_ptr<bz_APIIntList> playerList(bz_getPlayerIndexList());
+
+    teamBalancer.clear();
+
+    for (unsigned int i = 0; i < playerList->size(); i++)
+    {
+        std::unique_ptr<bz_BasePlayerRecord> playerRecord(bz_getPlayerByIndex(playerList->get(i)));
+
+        if (playerRecord)
+        {
+            teamBalancer.add(playerRecord->playerID, playerRecord->team, matchHistory.getRating(playerRecord->bzID.c_str()));
+        }
+    }
+}
+
+// A request has been answered or has failed; if it was the report of a match in the history, record how it went
+void LeagueOverseer::finishMatchReport(uint32_t matchID, MatchReportStatus status)
+{
+    if (matchID == 0)
+    {
+        return;
+    }
+
+    appendMatchHistory(matchHistory.setStatus(matchID, status));
+}
+
+// Append a record to the match history file on the worker thread so the main loop never waits on the disk
+void LeagueOverseer::appendMatchHistory(const std::string &record)
+{
+    if (record.empty() || !matchHistory.isWritable())
+    {
+        return;
+    }
+
+    appendFileInBackground(matchHistory.getPath(), record, "a match to the match history");
+}
+
+// Send a player the score, participants and report status of a match in the match history
+void LeagueOverseer::sendMatchSummary(int playerID, const MatchHistory::Match &match)
+{
+    char matchDate[20];
+    time_t finishedAt = (time_t)match.finishedAt;
+    strftime(matchDate, sizeof(matchDate), "%Y-%m-%d %H:%M:%S", gmtime(&finishedAt));
+
+    bz_sendTextMessagef(BZ_SERVER, playerID, "%s match #%u, finished %s UTC", (match.official) ? "Official" : "Fun", match.id, matchDate);
+    bz_sendTextMessagef(BZ_SERVER, playerID, "  Score    : %s %d - %d %s", formatTeam((bz_eTeamType)match.teamOneColor).c_str(), match.teamOnePoints,
+                        match.teamTwoPoints, formatTeam((bz_eTeamType)match.teamTwoColor).c_str());
+
+    if (match.official)
+    {
+        bz_sendTextMessagef(BZ_SERVER, playerID, "  Teams    : %s vs %s", match.teamOneName.c_str(), match.teamTwoName.c_str());
+    }
+
+    bz_sendTextMessagef(BZ_SERVER, playerID, "  Duration : %d minutes%s%s", match.duration / 60, (match.mapName.empty()) ? "" : " on ", match.mapName.c_str());
+
+    if (!match.replayFile.empty())
+    {
+        bz_sendTextMessagef(BZ_SERVER, playerID, "  Replay   : %s", match.replayFile.c_str());
+    }
+
+    bz_sendTextMessagef(BZ_SERVER, playerID, "  Report   : %s", REPORT_STATUS_NAMES[match.status]);
+
+    for (auto &player : match.players)
+    {
+        bz_sendTextMessagef(BZ_SERVER, playerID, "  %-7s %s [%s] %.0f seconds%s", formatTeam((bz_eTeamType)player.team).c_str(),
+                            player.callsign.c_str(), player.bzID.c_str(), player.playTime, (player.counted) ? "" : " (not counted)");
+    }
+}
+
+// Send a player a single line of the /loprofile table
+void LeagueOverseer::sendProfile(int playerID, const char *handler, const HandlerProfile &profile)
+{
+    if (profile.samples() == 0)
+    {
+        return;
+    }
+
+    bz_sendTextMessagef(BZ_SERVER, playerID, "%-22s %9llu %10llu %10llu %10llu", handler,
+                        (unsigned long long)profile.samples(),
+                        (unsigned long long)profile.percentile(0.50),
+                        (unsigned long long)profile.percentile(0.99),
+                        (unsigned long long)profile.max());
+}
+
+// Queue a request to the league website behind any others of the same priority. Low priority requests are
+// dropped instead when their queue is full or an identical request is already waiting to be sent
+void LeagueOverseer::addURLJob(URLJobType type, const std::string &url, const std::string &postData, uint32_t matchID)
+{
+    URLJobPriority priority = URL_JOB_PRIORITIES[type];
+    std::deque<QueuedURLJob> &queue = urlJobQueues[priority];
+
+    if (priority == eLowPriority)
+    {
+        for (auto &job : queue)
+        {
+            if (job.type == type && job.url == url && job.postData == postData)
+            {
+                return;
+            }
+        }
+
+        if (queue.size() >= (size_t)MOTTO_QUEUE_LIMIT)
+        {
+            PluginMetrics::increment(metrics.urlJobsShed[type]);
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Too many requests are waiting to be sent, the '%s' request was dropped.", URL_JOB_NAMES[type]);
+            return;
+        }
+    }
+
+    QueuedURLJob job;
+    job.type     = type;
+    job.url      = url;
+    job.postData = postData;
+    job.matchID  = matchID;
+    job.queuedAt = std::chrono::steady_clock::now();
+
+    queue.push_back(job);
+
+    dispatchURLJobs();
+    updateTickEvent();
+}
+
+// Send as many queued requests as we're allowed to, highest priority first
+void LeagueOverseer::dispatchURLJobs()
+{
+    double now = bz_getCurrentTime();
+
+    mottoRequestTokens = std::min((double)MOTTO_REQUEST_BURST, mottoRequestTokens + (now - lastTokenRefill) * MOTTO_REQUEST_RATE);
+    lastTokenRefill = now;
+
+    while (true)
+    {
+        std::chrono::steady_clock::time_point clock = std::chrono::steady_clock::now();
+        size_t inFlight = 0,
+               inFlightOfType[URL_JOB_TYPE_COUNT] = {};
+
+        for (auto &handler : urlJobsInFlight)
+        {
+            if (std::chrono::duration<double>(clock - handler->startTime).count() < URL_JOB_STALL_TIMEOUT)
+            {
+                inFlight++;
+                inFlightOfType[handler->type]++;
+            }
+        }
+
+        bool multiplexed = (HTTP_TRANSPORT == "sidecar" && sidecar.isConnected());
+
+        if (inFlight >= (multiplexed ? MAX_SIDECAR_JOBS_IN_FLIGHT : MAX_URL_JOBS_IN_FLIGHT))
+        {
+            return;
+        }
+
+        // A sidecar may answer in any order, which only team name queries don't care about. Match reports and
+        // team dumps are still sent one at a time so their responses are matched up with the right request
+        int priority = 0;
+
+        while (priority < URL_JOB_PRIORITY_COUNT && (urlJobQueues[priority].empty() ||
+               (priority != eLowPriority && inFlightOfType[urlJobQueues[priority].front().type] > 0)))
+        {
+            priority++;
+        }
+
+        if (priority == URL_JOB_PRIORITY_COUNT)
+        {
+            return;
+        }
+
+        if (priority == eLowPriority)
+        {
+            if (mottoRequestTokens < 1)
+            {
+                return;
+            }
+
+            mottoRequestTokens -= 1;
+        }
+
+        QueuedURLJob job = urlJobQueues[priority].front();
+        urlJobQueues[priority].pop_front();
+
+        metrics.urlJobQueueWait[job.type].observe(std::chrono::duration<double>(clock - job.queuedAt).count());
+
+        sendURLJob(job.type, job.url, job.postData, job.matchID);
+    }
+}
+
+// Hand a request over to bzfs, or to our own HTTP client, to send to the league website
+void LeagueOverseer::sendURLJob(URLJobType type, const std::string &url, const std::string &postData, uint32_t matchID)
+{
+    PluginMetrics::increment(metrics.urlJobsSent[type]);
+
+    // The handler is in our list before the request is sent in case it's called right away
+    URLJobHandler *handler = new URLJobHandler(this, type, matchID);
+    urlJobsInFlight.push_back(std::unique_ptr<URLJobHandler>(handler));
+
+    bool queued;
+
+    if (HTTP_TRANSPORT == "curl" && httpClient.isStarted())
+    {
+        queued = httpClient.send(url, postData, URL_JOB_TIMEOUTS[type], handler);
+    }
+    else if (HTTP_TRANSPORT == "sidecar" && sidecar.send(url, postData, URL_JOB_TIMEOUTS[type], bz_getCurrentTime(), handler))
+    {
+        queued = true;
+    }
+    else
+    {
+        // This is also where requests end up while the sidecar can't be reached
+        queued = bz_addURLJob(url.c_str(), handler, postData.c_str());
+    }
+
+    if (!queued)
+    {
+        urlJobsInFlight.erase(std::find_if(urlJobsInFlight.begin(), urlJobsInFlight.end(),
+                                           [handler](const std::unique_ptr<URLJobHandler> &h) { return h.get() == handler; }));
+
+        PluginMetrics::increment(metrics.urlJobErrors[type]);
+        finishMatchReport(matchID, eReportFailed);
+        bz_debugMessagef(DEBUG_LEVEL, "ERROR :: League Overseer :: The '%s' request could not be queued.", URL_JOB_NAMES[type]);
+    }
+}
+
+// A request to the league website has finished, record how it finished and how long it took. Its handler is
+// still running, so it's only set aside here and freed on the next tick
+void LeagueOverseer::finishURLJob(URLJobHandler *handler, std::atomic<uint64_t> &outcome)
+{
+    PluginMetrics::increment(outcome);
+
+    std::chrono::duration<double> latency = std::chrono::steady_clock::now() - handler->startTime;
+    metrics.urlJobLatency[handler->type].observe(latency.count());
+
+    for (auto it = urlJobsInFlight.begin(); it != urlJobsInFlight.end(); ++it)
+    {
+        if (it->get() == handler)
+        {
+            urlJobsFinished.push_back(std::move(*it));
+            urlJobsInFlight.erase(it);
+            break;
+        }
+    }
+}
+
+// Write all of our metrics to METRICS_PATH in the Prometheus text format so that a textfile
+// collector, such as node_exporter's, can pick them up without the plugin listening on a port
+void LeagueOverseer::writeMetrics()
+{
+    if (METRICS_PATH.empty())
+    {
+        return;
+    }
+
+    std::ostringstream out;
+    std::string labels = "server=\"" + std::string(bz_getPublicAddr().c_str()) + "\"";
+
+    metrics.write(out, labels);
+
+    size_t pendingJobs = urlJobsInFlight.size();
+
+    out << "# HELP leagueoverseer_roster_size Number of players recorded for the current match.\n";
+    out << "# TYPE leagueoverseer_roster_size gauge\n";
+    out << "leagueoverseer_roster_size{" << labels << "} " << ((currentMatch) ? currentMatch->matchRoster.size() : 0) << "\n";
+
+    out << "# HELP leagueoverseer_match_arena_bytes Bytes allocated from the current match's arena.\n";
+    out << "# TYPE leagueoverseer_match_arena_bytes gauge\n";
+    out << "leagueoverseer_match_arena_bytes{" << labels << "} " << ((currentMatch) ? currentMatch->arena.used() : 0) << "\n";
+
+    out << "# HELP leagueoverseer_motto_table_size Number of BZIDs with a known team name.\n";
+    out << "# TYPE leagueoverseer_motto_table_size gauge\n";
+    out << "leagueoverseer_motto_table_size{" << labels << "} " << (teamMottos->size() + sharedMottos.size()) << "\n";
+
+    out << "# HELP leagueoverseer_motto_cache_size Number of players whose team name query answer is cached.\n";
+    out << "# TYPE leagueoverseer_motto_cache_size gauge\n";
+    out << "leagueoverseer_motto_cache_size{" << labels << "} " << mottoCache.size() << "\n";
+
+    out << "# HELP leagueoverseer_url_jobs_pending Number of requests waiting on a response from the league website.\n";
+    out << "# TYPE leagueoverseer_url_jobs_pending gauge\n";
+    out << "leagueoverseer_url_jobs_pending{" << labels << "} " << pendingJobs << "\n";
+
+    out << "# HELP leagueoverseer_url_jobs_queued Number of requests waiting in the plugin's queue to be sent.\n";
+    out << "# TYPE leagueoverseer_url_jobs_queued gauge\n";
+
+    for (int i = 0; i < URL_JOB_PRIORITY_COUNT; i++)
+    {
+        static const char* PRIORITY_NAMES[URL_JOB_PRIORITY_COUNT] = { "high", "normal", "low" };
+        out << "leagueoverseer_url_jobs_queued{" << labels << ",priority=\"" << PRIORITY_NAMES[i] << "\"} " << urlJobQueues[i].size() << "\n";
+    }
+
+    writeFileInBackground(METRICS_PATH, out.str(), "metrics");
+}
+
+// Hand a file to the worker thread to be written atomically, and complain if it couldn't be
+void LeagueOverseer::writeFileInBackground(const std::string &path, const std::string &contents, const char *description)
+{
+    std::shared_ptr<bool> written = std::make_shared<bool>(false);
+
+    worker.submit([path, contents, written]()
+    {
+        *written = writeFileAtomically(path, contents);
+    },
+    [this, path, description, written]()
+    {
+        if (!*written)
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: Could not write %s to %s", description, path.c_str());
+        }
+    });
+}
+
+// Append to a file on the worker thread, the way writeFileInBackground() replaces one
+void LeagueOverseer::appendFileInBackground(const std::string &path, const std::string &contents, const char *description)
+{
+    std::shared_ptr<bool> written = std::make_shared<bool>(false);
+
+    worker.submit([path, contents, written]()
+    {
+        *written = appendFile(path, contents);
+    },
+    [this, path, description, written]()
+    {
+        if (!*written)
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: Could not append %s at %s", description, path.c_str());
+        }
+    });
+}
+
+// Only listen to the tick event while there's something for it to do, so a server with nothing going on
+// doesn't call into the plugin on every pass through its main loop
+void LeagueOverseer::updateTickEvent()
+{
+    size_t ownRequests = httpClient.inFlight() + sidecar.inFlight();
+    bool needed = !timers.empty() || worker.pendingTasks() > 0 || ownRequests > 0;
+
+    for (int i = 0; i < URL_JOB_PRIORITY_COUNT && !needed; i++)
+    {
+        needed = !urlJobQueues[i].empty();
+    }
+
+    // bzfs may otherwise sleep for several seconds on an empty server, which our requests would spend waiting
+    MaxWaitTime = (ownRequests > 0) ? 0.05f : -1;
+
+    if (needed && !tickRegistered)
+    {
+        tickRegistered = Register(bz_eTickEvent);
+    }
+    else if (!needed && tickRegistered)
+    {
+        Remove(bz_eTickEvent);
+        tickRegistered = false;
+    }
+}
+
+// Start our own HTTP client when it's been asked for. It's only stopped when the plugin is unloaded so any
+// requests it still has in flight after switching back to bzfs are answered as usual, unlike the sidecar's
+// requests, which fail as soon as the sidecar is no longer used
+void LeagueOverseer::startHTTPTransport()
+{
+    if (HTTP_TRANSPORT == "curl" && !httpClient.start())
+    {
+#ifdef HAVE_LIBCURL
+        bz_debugMessage(0, "WARNING :: League Overseer :: The libcurl HTTP client could not be started, requests will be sent by bzfs.");
+#else
+        bz_debugMessage(0, "WARNING :: League Overseer :: This plugin was built without libcurl, requests will be sent by bzfs.");
+#endif
+    }
+
+    // The sidecar is only connected to once there is something to send
+    sidecar.setPath((HTTP_TRANSPORT == "sidecar") ? SIDECAR_SOCKET : "");
+}
+
+// Schedule a timer and make sure we're listening to the tick event that drives it
+TimerWheel::TimerID LeagueOverseer::scheduleTimer(double delay, double interval, TimerWheel::Callback callback)
+{
+    TimerWheel::TimerID id = timers.schedule(bz_getCurrentTime(), delay, interval, callback);
+    updateTickEvent();
+
+    return id;
+}
+
+// Check the configuration and mapchange files every second, but only while someone is around to notice
+void LeagueOverseer::startWatcherTimer()
+{
+    if (!timers.isScheduled(watcherTimer))
+    {
+        watcherTimer = scheduleTimer(1, 1, [this]() { checkWatchers(); return bz_getPlayerCount() > 0; });
+    }
+}
+
+// Keep an eye on the current match, or a countdown started without one, for as long as there is one
+void LeagueOverseer::startMatchTimer()
+{
+    if (!timers.isScheduled(matchTimer))
+    {
+        matchTimer = scheduleTimer(1, 1, [this]() { return checkMatch(); });
+    }
+}
+
+// Checkpoint the current match right away and then every CHECKPOINT_INTERVAL seconds until it ends
+void LeagueOverseer::startCheckpointTimer()
+{
+    timers.cancel(checkpointTimer);
+
+    if (CHECKPOINT_PATH.empty())
+    {
+        return;
+    }
+
+    checkpointTimer = scheduleTimer(0, CHECKPOINT_INTERVAL, [this]()
+    {
+        if (currentMatch == NULL || !bz_isCountDownActive())
+        {
+            return false;
+        }
+
+        writeCheckpoint();
+        return true;
+    });
+}
+
+void LeagueOverseer::startMetricsTimer()
+{
+    timers.cancel(metricsTimer);
+
+    if (!METRICS_PATH.empty())
+    {
+        metricsTimer = scheduleTimer(0, METRICS_INTERVAL, [this]() { writeMetrics(); return true; });
+    }
+}
+
+void LeagueOverseer::startLiveStateTimer()
+{
+    timers.cancel(liveStateTimer);
+    lastLiveState.clear();
+
+    if (!LIVE_STATE_PATH.empty())
+    {
+        liveStateTimer = scheduleTimer(0, LIVE_STATE_INTERVAL, [this]() { publishLiveState(); return true; });
+    }
+}
+
+// Publish the state of the current match to LIVE_STATE_PATH for overlays and bots. The clock is published as the
+// time the match started along with its duration so the file doesn't change every second; it's only replaced
+// when something else has changed, and it's replaced atomically so readers never see half of it.
+void LeagueOverseer::publishLiveState()
+{
+    json_object *state = json_object_new_object();
+    json_object *match = NULL;
+
+    if (currentMatch != NULL)
+    {
+        bool paused = bz_isCountDownPaused();
+        json_object *teams = json_object_new_array();
+
+        match = json_object_new_object();
+
+        json_object_object_add(match, "type", json_object_new_string((currentMatch->isOfficialMatch) ? "official" : "fm"));
+        json_object_object_add(match, "state", json_object_new_string((!bz_isCountDownActive()) ? "countdown" : (paused) ? "paused" : "playing"));
+        json_object_object_add(match, "startedAt", json_object_new_int64((bz_isCountDownActive()) ? (int64_t)currentMatch->matchStart : 0));
+        json_object_object_add(match, "pausedAt", json_object_new_int64((paused) ? (int64_t)currentMatch->matchPaused : 0));
+        json_object_object_add(match, "duration", json_object_new_int((int)currentMatch->duration));
+
+        bz_eTeamType colors[2] = { TEAM_ONE, TEAM_TWO };
+        std::string names[2]   = { currentMatch->teamOneName, currentMatch->teamTwoName };
+        int points[2]          = { currentMatch->teamOnePoints, currentMatch->teamTwoPoints };
+        json_object *players[2];
+
+        for (int i = 0; i < 2; i++)
+        {
+            json_object *team = json_object_new_object();
+            players[i] = json_object_new_array();
+
+            json_object_object_add(team, "color", json_object_new_string(formatTeam(colors[i]).c_str()));
+            json_object_object_add(team, "name", json_object_new_string((currentMatch->isOfficialMatch) ? names[i].c_str() : ""));
+            json_object_object_add(team, "score", json_object_new_int(points[i]));
+            json_object_object_add(team, "players", players[i]);
+            json_object_array_add(teams, team);
+        }
+
+        // Only the participants who are on the server right now, listed under the team they're playing for
+        for (auto &kv : currentMatch->matchRoster)
         {
-            teamMottos[urlJobBZID] = urlJobTeamName;
+            MatchParticipant &participant = kv.second;
 
-            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Motto saved for BZID %s.", urlJobBZID.c_str());
+            if (currentMatch->findParticipant(participant.slotID) != &participant)
+            {
+                continue;
+            }
 
-            // If the team name is equal to an empty string that means a player is teamless and if they are in our motto
-            // map, that means they recently left a team so remove their entry in the map
-            if (urlJobTeamName == "" && teamMottos.count(urlJobBZID))
+            bz_eTeamType team = bz_getPlayerTeam(participant.slotID);
+            int index = (team == TEAM_ONE) ? 0 : (team == TEAM_TWO) ? 1 : -1;
+
+            if (index >= 0)
             {
-                teamMottos.erase(urlJobBZID);
+                json_object *player = json_object_new_object();
+
+                json_object_object_add(player, "callsign", json_object_new_string(participant.callsign.c_str()));
+                json_object_object_add(player, "bzID", json_object_new_string(participant.bzID.c_str()));
+                json_object_array_add(players[index], player);
             }
         }
+
+        json_object_object_add(match, "teams", teams);
     }
-    else if (siteData.find("<html>") == std::string::npos)
-    {
-        std::vector<std::string> lines = tokenize(siteData.c_str(), "\n", 0, false);
 
-        for (auto line : lines)
-        {
-            bz_sendTextMessagef(BZ_SERVER, BZ_ALLUSERS, "%s", line.c_str());
-            bz_debugMessagef(DEBUG_LEVEL, "%s", line.c_str());
-        }
+    json_object_object_add(state, "map", json_object_new_string(MAP_NAME.c_str()));
+    json_object_object_add(state, "match", match);
+
+    std::string contents = std::string(json_object_to_json_string(state)) + "\n";
+    json_object_put(state);
+
+    if (contents != lastLiveState)
+    {
+        lastLiveState.swap(contents);
+        writeFileInBackground(LIVE_STATE_PATH, lastLiveState, "the live match state");
     }
 }
 
-// The league website is down or is not responding, the request timed out
-void LeagueOverseer::URLTimeout(const char* /*URL*/, int /*errorCode*/)
+void LeagueOverseer::checkWatchers()
 {
-    bz_debugMessage(DEBUG_LEVEL, "WARNING :: League Overseer :: The request to the league site has timed out.");
+    // Reload the configuration file if it has been changed since we last loaded it
+    if (configWatcher.changed())
+    {
+        bz_debugMessage(DEBUG_LEVEL, "DEBUG :: League Overseer :: Configuration file change detected.");
+        reloadConfig();
+    }
 
-    if (MATCH_INFO_SENT)
+    // mapchange has rotated the map, so update the map we'll report
+    if (mapChangeWatcher.changed())
     {
-        MATCH_INFO_SENT = false;
-        bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "The match could not be reported due to the connection to the league site timing out.");
-        bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "If the league site is not down, please notify the server owner to reconfigure this plugin.");
+        readMapName();
     }
 }
 
-// The server owner must have set up the URLs wrong because this shouldn't happen
-void LeagueOverseer::URLError(const char* /*URL*/, int errorCode, const char *errorString)
+// Clean up after a match everyone has left. Returns whether there's still a match to keep an eye on
+bool LeagueOverseer::checkMatch()
 {
-    bz_debugMessage(DEBUG_LEVEL, "ERROR :: League Overseer :: Match report failed with the following error:");
-    bz_debugMessagef(DEBUG_LEVEL, "ERROR :: League Overseer :: Error code: %i - %s", errorCode, errorString);
+    // Get the total number of tanks playing
+    int totaltanks = bz_getTeamCount(eRedTeam) + bz_getTeamCount(eGreenTeam) + bz_getTeamCount(eBlueTeam) + bz_getTeamCount(ePurpleTeam);
 
-    if (MATCH_INFO_SENT)
+    // If there are no tanks playing, then we need to do some clean up
+    if (totaltanks == 0)
     {
-        MATCH_INFO_SENT = false;
-        bz_sendTextMessage(BZ_SERVER, BZ_ALLUSERS, "An unknown error has occurred, please notify the server owner to reconfigure this plugin.");
+        // If there is an official match and no tanks playing, we need to cancel it
+        if (currentMatch != NULL && !currentMatch->canceled)
+        {
+            currentMatch->canceled = true;
+            currentMatch->cancelationReason = "Current match automatically canceled due to all players leaving the match.";
+        }
+
+        // If there is a countdown active an no tanks are playing, then cancel it
+        if (bz_isCountDownActive())
+        {
+            bz_gameOver(253, eObservers);
+            bz_debugMessage(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Game ended because no players were found playing with an active countdown.");
+        }
     }
+
+    return (currentMatch != NULL || bz_isCountDownActive() || bz_isCountDownInProgress());
 }
 
-void LeagueOverseer::buildPlayerStrings(bz_eTeamType team, std::string &bzidString, std::string &ipString)
+void LeagueOverseer::buildPlayerStrings(bz_eTeamType team, std::string &bzidString, std::string &ipString, std::string &flagString)
 {
     if (currentMatch == NULL)
     {
@@ -1259,6 +7228,9 @@ void LeagueOverseer::buildPlayerStrings(bz_eTeamType team, std::string &bzidStri
     // Send a debug message of the players on the specified team
     bz_debugMessagef(0, "Match Data :: %s Team Players", formatTeam(team).c_str());
 
+    int teamGrabs = 0, teamCaptures = 0, teamReturns = 0;
+    double teamCarryTime = 0;
+
     for (auto &kv : currentMatch->matchRoster)
     {
         MatchParticipant &player = kv.second;
@@ -1272,12 +7244,26 @@ void LeagueOverseer::buildPlayerStrings(bz_eTeamType team, std::string &bzidStri
                 // Add the BZID of the player to string with a comma at the end
                 bzidString += std::string(bz_urlEncode(player.bzID.c_str())) + ",";
                 ipString   += std::string(bz_urlEncode(player.ipAddress.c_str())) + ",";
+
+                char flagStats[64];
+                snprintf(flagStats, sizeof(flagStats), "%d:%d:%d:%.0f", player.flagGrabs, player.flagCaptures, player.flagReturns, player.flagCarryTime);
+                flagString += std::string(bz_urlEncode(flagStats)) + ",";
             }
 
+            teamGrabs     += player.flagGrabs;
+            teamCaptures  += player.flagCaptures;
+            teamReturns   += player.flagReturns;
+            teamCarryTime += player.flagCarryTime;
+
             // Output their information to the server logs
             bz_debugMessagef(0, "Match Data ::   %s [%s] (%s)", player.callsign.c_str(), player.bzID.c_str(), player.ipAddress.c_str());
             bz_debugMessagef(0, "Match Data ::     %.0f seconds of estimated play time", player.estimatedPlayTime());
 
+            if (player.flagGrabs || player.flagReturns)
+            {
+                bz_debugMessagef(0, "Match Data ::     %d flag grabs, %d captures, %d returns, %.0f seconds carrying", player.flagGrabs, player.flagCaptures, player.flagReturns, player.flagCarryTime);
+            }
+
             if (!player.hasSpawned)
             {
                 bz_debugMessagef(0, "Match Data ::     Player never spawned");
@@ -1301,6 +7287,12 @@ void LeagueOverseer::buildPlayerStrings(bz_eTeamType team, std::string &bzidStri
     {
         ipString = ipString.erase(ipString.size() - 1);
     }
+    if (!flagString.empty())
+    {
+        flagString = flagString.erase(flagString.size() - 1);
+    }
+
+    bz_debugMessagef(0, "Match Data ::   Team flags: %d grabs, %d captures, %d returns, %.0f seconds carrying", teamGrabs, teamCaptures, teamReturns, teamCarryTime);
 }
 
 bz_ApiString LeagueOverseer::buildReplayName(bz_Time &standardTime)
@@ -1352,6 +7344,64 @@ bz_ApiString LeagueOverseer::buildReplayName(bz_Time &standardTime)
     return replayFileName;
 }
 
+// Build the /matchstatus lines for the current match: the score, the team names and every participant along
+// with whether they have played enough to be counted so far. Eligibility is the only part that changes without
+// an event telling us, so the lines are also marked to expire the moment the next player becomes eligible
+void LeagueOverseer::buildMatchStatus()
+{
+    std::vector<std::string> &lines = currentMatch->statusLines;
+    double now = bz_getCurrentTime();
+    bool paused = bz_isCountDownPaused();
+    char line[128];
+
+    lines.clear();
+    currentMatch->statusExpires = std::numeric_limits<double>::max();
+
+    snprintf(line, sizeof(line), "%s match: %s %d - %d %s", (currentMatch->isOfficialMatch) ? "Official" : "Fun",
+             formatTeam(TEAM_ONE).c_str(), currentMatch->teamOnePoints, currentMatch->teamTwoPoints, formatTeam(TEAM_TWO).c_str());
+    lines.push_back(line);
+
+    if (currentMatch->isOfficialMatch)
+    {
+        snprintf(line, sizeof(line), "  Teams     : %s vs %s", currentMatch->teamOneName.c_str(), currentMatch->teamTwoName.c_str());
+        lines.push_back(line);
+    }
+
+    if (!bz_isCountDownActive())
+    {
+        lines.push_back("  The match is about to start.");
+        return;
+    }
+
+    // The clock stands still while the match is paused, so it can be cached along with everything else
+    if (paused)
+    {
+        snprintf(line, sizeof(line), "  Time left : %s (paused)", getMatchTime((int)difftime(currentMatch->matchPaused, currentMatch->matchStart)).c_str());
+        lines.push_back(line);
+    }
+
+    double requiredTime = (currentMatch->isOfficialMatch) ? OFFI_MIN_TIME : currentMatch->duration * FM_MIN_RATIO;
+
+    for (auto &kv : currentMatch->matchRoster)
+    {
+        MatchParticipant &player = kv.second;
+
+        // Count the session the player is in the middle of, which is only added to their total when it ends
+        bool playing = player.startTime >= 0 && !paused;
+        double playTime = player.estimatedPlayTime() + ((playing) ? now - player.startTime : 0);
+        bool eligible = player.hasSpawned && playTime >= requiredTime;
+
+        if (playing && player.hasSpawned && !eligible)
+        {
+            currentMatch->statusExpires = std::min(currentMatch->statusExpires, now + (requiredTime - playTime));
+        }
+
+        snprintf(line, sizeof(line), "  %-7s %s%s", formatTeam(player.getLoyalty(TEAM_ONE, TEAM_TWO)).c_str(), player.callsign.c_str(),
+                 (eligible) ? "" : " (not yet eligible)");
+        lines.push_back(line);
+    }
+}
+
 // Return the progress of a match in seconds. For example, 20:00 minutes remaining would return 600
 int LeagueOverseer::getMatchProgress()
 {
@@ -1368,8 +7418,12 @@ int LeagueOverseer::getMatchProgress()
 // Get the literal time remaining in a match in the format of MM:SS
 std::string LeagueOverseer::getMatchTime()
 {
-    int time = getMatchProgress();
+    return getMatchTime(getMatchProgress());
+}
 
+// Get the literal time remaining in a match that's a number of seconds in, in the format of MM:SS
+std::string LeagueOverseer::getMatchTime(int time)
+{
     // Let's covert the seconds of a match's progress into minutes and seconds
     int minutes = (currentMatch->duration/60) - ceil(time / 60.0);
     int seconds = 60 - (time % 60);
@@ -1396,22 +7450,44 @@ std::string LeagueOverseer::getMatchTime()
     return minutesLiteral + ":" + secondsLiteral;
 }
 
-// Load the plugin configuration file
+// Load the plugin configuration file when the plugin is loaded
 void LeagueOverseer::loadConfig(const char* cmdLine)
+{
+    PluginSettings settings;
+
+    CONFIG_PATH = cmdLine;
+    configWatcher.watch(CONFIG_PATH);
+
+    // Shutdown the server if the configuration file has errors because we can't do anything
+    // with a broken config
+    if (!parseConfig(cmdLine, settings))
+    {
+        bz_debugMessage(0, "ERROR :: League Overseer :: Your configuration file contains errors. Shutting down...");
+        bz_shutdown();
+    }
+
+    static_cast<PluginSettings&>(*this) = settings;
+    mottoCache.setCapacity(MOTTO_CACHE_SIZE);
+
+    printConfig();
+}
+
+// Read and validate the configuration file into a set of settings without touching the ones in use.
+// Returns false if the configuration file contains errors that would leave the plugin unusable.
+bool LeagueOverseer::parseConfig(const char* cmdLine, PluginSettings &settings)
 {
 	// Setup to read the configuration file
     PluginConfig config = PluginConfig(cmdLine);
     std::string section = "leagueOverSeer";
+    bool valid = true;
 
     // Set a default value
-    VERBOSE_LEVEL  = -1;
+    settings.VERBOSE_LEVEL = -1;
 
-    // Shutdown the server if the configuration file has errors because we can't do anything
-    // with a broken config
     if (config.errors)
     {
-        bz_debugMessage(0, "ERROR :: League Overseer :: Your configuration file contains errors. Shutting down...");
-        bz_shutdown();
+        bz_debugMessage(0, "ERROR :: League Overseer :: Your configuration file could not be read.");
+        return false;
     }
 
     // Deprecated configuration file options
@@ -1420,78 +7496,249 @@ void LeagueOverseer::loadConfig(const char* cmdLine)
         bz_debugMessage(0, "WARNING :: League Overseer :: The 'DEBUG_ALL' configuration file option has been deprecated.");
         bz_debugMessage(0, "WARNING :: League Overseer :: Please use the 'VERBOSE_LEVEL' option instead.");
 
-        VERBOSE_LEVEL = atoi((config.item(section, "DEBUG_ALL")).c_str());
+        settings.VERBOSE_LEVEL = atoi((config.item(section, "DEBUG_ALL")).c_str());
     }
     if (!config.item(section, "LEAGUE_OVER_SEER_URL").empty())
     {
         bz_debugMessage(0, "WARNING :: League Overseer :: The 'LEAGUE_OVER_SEER_URL' configuration file option has been deprecated.");
         bz_debugMessage(0, "WARNING :: League Overseer :: Please use the 'LEAGUE_OVERSEER_URL' option instead.");
 
-        MATCH_REPORT_URL = config.item(section, "LEAGUE_OVER_SEER_URL");
-        TEAM_NAME_URL    = config.item(section, "LEAGUE_OVER_SEER_URL");
+        settings.MATCH_REPORT_URL = config.item(section, "LEAGUE_OVER_SEER_URL");
+        settings.TEAM_NAME_URL    = config.item(section, "LEAGUE_OVER_SEER_URL");
     }
 
     // Extract all the data in the configuration file and assign it to plugin variables
-    ROTATION_LEAGUE = toBool(config.item(section, "ROTATIONAL_LEAGUE"));
-    MAPCHANGE_PATH  = config.item(section, "MAPCHANGE_PATH");
-    DISABLE_REPORT  = toBool(config.item(section, "DISABLE_MATCH_REPORT"));
-    DISABLE_MOTTO   = toBool(config.item(section, "DISABLE_TEAM_MOTTO"));
-    DEBUG_LEVEL     = atoi((config.item(section, "DEBUG_LEVEL")).c_str());
-    VERBOSE_LEVEL   = (VERBOSE_LEVEL < 0) ? atoi((config.item(section, "VERBOSE_LEVEL")).c_str()) : VERBOSE_LEVEL;
+    settings.ROTATION_LEAGUE      = toBool(config.item(section, "ROTATIONAL_LEAGUE"));
+    settings.MAPCHANGE_PATH       = config.item(section, "MAPCHANGE_PATH");
+    settings.DISABLE_REPORT       = toBool(config.item(section, "DISABLE_MATCH_REPORT"));
+    settings.DISABLE_MOTTO        = toBool(config.item(section, "DISABLE_TEAM_MOTTO"));
+    settings.DEBUG_LEVEL          = atoi((config.item(section, "DEBUG_LEVEL")).c_str());
+    settings.METRICS_PATH         = config.item(section, "METRICS_PATH");
+    settings.METRICS_INTERVAL     = atof((config.item(section, "METRICS_INTERVAL")).c_str());
+    settings.SHARED_MOTTO_CACHE   = config.item(section, "SHARED_MOTTO_CACHE");
+    settings.CHECKPOINT_PATH      = config.item(section, "CHECKPOINT_PATH");
+    settings.CHECKPOINT_INTERVAL  = atof((config.item(section, "CHECKPOINT_INTERVAL")).c_str());
+    settings.MATCH_HISTORY_PATH   = config.item(section, "MATCH_HISTORY_PATH");
+    settings.HEATMAP_PATH         = config.item(section, "HEATMAP_PATH");
+    settings.REPLAY_PATH          = config.item(section, "REPLAY_PATH");
+    settings.REPLAY_CATALOG_PATH  = config.item(section, "REPLAY_CATALOG_PATH");
+    settings.REPLAY_MAX_SIZE      = atof((config.item(section, "REPLAY_MAX_SIZE")).c_str());
+    settings.REPLAY_MAX_AGE       = atof((config.item(section, "REPLAY_MAX_AGE")).c_str());
+    settings.REPLAY_OFFICIAL_MAX_AGE = atof((config.item(section, "REPLAY_OFFICIAL_MAX_AGE")).c_str());
+    settings.HEATMAP_CELL_SIZE    = (config.item(section, "HEATMAP_CELL_SIZE").empty()) ? 10 : atof((config.item(section, "HEATMAP_CELL_SIZE")).c_str());
+    settings.LIVE_STATE_PATH      = config.item(section, "LIVE_STATE_PATH");
+    settings.LIVE_STATE_INTERVAL  = (config.item(section, "LIVE_STATE_INTERVAL").empty()) ? 1 : atof((config.item(section, "LIVE_STATE_INTERVAL")).c_str());
+    settings.HTTP_TRANSPORT       = (config.item(section, "HTTP_TRANSPORT").empty()) ? "bzfs" : config.item(section, "HTTP_TRANSPORT");
+    settings.SIDECAR_SOCKET       = config.item(section, "SIDECAR_SOCKET");
+    settings.SHARED_MOTTO_MAX_AGE = (config.item(section, "SHARED_MOTTO_MAX_AGE").empty()) ? 3600 : atof((config.item(section, "SHARED_MOTTO_MAX_AGE")).c_str());
+    settings.MOTTO_CACHE_SIZE     = (config.item(section, "MOTTO_CACHE_SIZE").empty()) ? 4096 : atoi((config.item(section, "MOTTO_CACHE_SIZE")).c_str());
+    settings.MOTTO_CACHE_TTL      = (config.item(section, "MOTTO_CACHE_TTL").empty()) ? 1800 : atof((config.item(section, "MOTTO_CACHE_TTL")).c_str());
+    settings.MOTTO_CACHE_NEGATIVE_TTL = (config.item(section, "MOTTO_CACHE_NEGATIVE_TTL").empty()) ? 600 : atof((config.item(section, "MOTTO_CACHE_NEGATIVE_TTL")).c_str());
+    settings.MOTTO_REQUEST_RATE   = (config.item(section, "MOTTO_REQUEST_RATE").empty()) ? 2 : atof((config.item(section, "MOTTO_REQUEST_RATE")).c_str());
+    settings.MOTTO_REQUEST_BURST  = (config.item(section, "MOTTO_REQUEST_BURST").empty()) ? 5 : atoi((config.item(section, "MOTTO_REQUEST_BURST")).c_str());
+    settings.MOTTO_QUEUE_LIMIT    = (config.item(section, "MOTTO_QUEUE_LIMIT").empty()) ? 32 : atoi((config.item(section, "MOTTO_QUEUE_LIMIT")).c_str());
+    settings.VERBOSE_LEVEL        = (settings.VERBOSE_LEVEL < 0) ? atoi((config.item(section, "VERBOSE_LEVEL")).c_str()) : settings.VERBOSE_LEVEL;
 
     if (!config.item(section, "LEAGUE_OVERSEER_URL").empty())
     {
-        MATCH_REPORT_URL = config.item(section, "LEAGUE_OVERSEER_URL");
-        TEAM_NAME_URL    = config.item(section, "LEAGUE_OVERSEER_URL");
+        settings.MATCH_REPORT_URL = config.item(section, "LEAGUE_OVERSEER_URL");
+        settings.TEAM_NAME_URL    = config.item(section, "LEAGUE_OVERSEER_URL");
     }
     else
     {
-        if (!DISABLE_REPORT)
+        if (!settings.DISABLE_REPORT)
         {
             if (!config.item(section, "MATCH_REPORT_URL").empty())
             {
-                MATCH_REPORT_URL = config.item(section, "MATCH_REPORT_URL");
+                settings.MATCH_REPORT_URL = config.item(section, "MATCH_REPORT_URL");
             }
-            else
+            else if (settings.MATCH_REPORT_URL.empty())
             {
                 bz_debugMessage(0, "ERROR :: League Overseer :: You are requesting to report matches but you have not specified a URL to report to.");
                 bz_debugMessage(0, "ERROR :: League Overseer :: Please set the 'MATCH_REPORT_URL' or 'LEAGUE_OVERSEER_URL' option respectively.");
                 bz_debugMessage(0, "ERROR :: League Overseer :: If you do not wish to report matches, set 'DISABLE_MATCH_REPORT' to true.");
-                bz_shutdown();
+                valid = false;
             }
         }
 
-        if (!DISABLE_MOTTO)
+        if (!settings.DISABLE_MOTTO)
         {
             if (!config.item(section, "MOTTO_FETCH_URL").empty())
             {
-                TEAM_NAME_URL = config.item(section, "MOTTO_FETCH_URL");
+                settings.TEAM_NAME_URL = config.item(section, "MOTTO_FETCH_URL");
             }
-            else
+            else if (settings.TEAM_NAME_URL.empty())
             {
                 bz_debugMessage(0, "ERROR :: League Overseer :: You have requested to fetch team names but have not specified a URL to fetch them from.");
                 bz_debugMessage(0, "ERROR :: League Overseer :: Please set the 'MOTTO_FETCH_URL' or 'LEAGUE_OVERSEER_URL' option respectively.");
                 bz_debugMessage(0, "ERROR :: League Overseer :: If you do not wish to team names for mottos, set 'DISABLE_TEAM_MOTTO' to true.");
-                bz_shutdown();
+                valid = false;
             }
         }
     }
 
     // Sanity check for our debug level, if it doesn't pass the check then set the debug level to 1
-    if (DEBUG_LEVEL > 4 || DEBUG_LEVEL < 0)
+    if (settings.DEBUG_LEVEL > 4 || settings.DEBUG_LEVEL < 0)
     {
         bz_debugMessage(0, "WARNING :: League Overseer :: Invalid debug level in the configuration file.");
         bz_debugMessage(0, "WARNING :: League Overseer :: Debug level set to the default: 1.");
-        DEBUG_LEVEL = 1;
+        settings.DEBUG_LEVEL = 1;
+    }
+
+    // Don't let the metrics file be rewritten on every single tick
+    if (settings.METRICS_INTERVAL < 1)
+    {
+        settings.METRICS_INTERVAL = 15;
+    }
+
+    if (settings.CHECKPOINT_INTERVAL < 1)
+    {
+        settings.CHECKPOINT_INTERVAL = 15;
+    }
+
+    if (settings.HEATMAP_CELL_SIZE <= 0)
+    {
+        settings.HEATMAP_CELL_SIZE = 10;
+    }
+
+    if (settings.HTTP_TRANSPORT != "bzfs" && settings.HTTP_TRANSPORT != "curl" && settings.HTTP_TRANSPORT != "sidecar")
+    {
+        bz_debugMessagef(0, "WARNING :: League Overseer :: Unknown HTTP transport '%s' in the configuration file.", settings.HTTP_TRANSPORT.c_str());
+        bz_debugMessage(0, "WARNING :: League Overseer :: HTTP transport set to the default: bzfs.");
+        settings.HTTP_TRANSPORT = "bzfs";
+    }
+
+    if (!settings.REPLAY_CATALOG_PATH.empty() && settings.REPLAY_PATH.empty())
+    {
+        bz_debugMessage(0, "WARNING :: League Overseer :: You have asked for a replay catalog but have not specified where bzfs saves replays.");
+        bz_debugMessage(0, "WARNING :: League Overseer :: Please set the 'REPLAY_PATH' option to the server's recording directory.");
+        settings.REPLAY_CATALOG_PATH = "";
+    }
+
+    // Negative budgets make no sense, treat them as no limit
+    settings.REPLAY_MAX_SIZE         = std::max(0.0, settings.REPLAY_MAX_SIZE);
+    settings.REPLAY_MAX_AGE          = std::max(0.0, settings.REPLAY_MAX_AGE);
+    settings.REPLAY_OFFICIAL_MAX_AGE = std::max(0.0, settings.REPLAY_OFFICIAL_MAX_AGE);
+
+    if (settings.HTTP_TRANSPORT == "sidecar" && settings.SIDECAR_SOCKET.empty())
+    {
+        bz_debugMessage(0, "WARNING :: League Overseer :: You have asked for requests to be sent to a sidecar but have not specified its socket.");
+        bz_debugMessage(0, "WARNING :: League Overseer :: Please set the 'SIDECAR_SOCKET' option, requests will be sent by bzfs until then.");
+        settings.HTTP_TRANSPORT = "bzfs";
+    }
+
+    // Anything faster than the timer resolution would be checked on every tick
+    if (settings.LIVE_STATE_INTERVAL < TimerWheel::RESOLUTION)
+    {
+        settings.LIVE_STATE_INTERVAL = 1;
+    }
+
+    if (settings.MOTTO_CACHE_SIZE < 1)
+    {
+        settings.MOTTO_CACHE_SIZE = 4096;
+    }
+
+    settings.MOTTO_CACHE_TTL          = std::max(0.0, settings.MOTTO_CACHE_TTL);
+    settings.MOTTO_CACHE_NEGATIVE_TTL = std::max(0.0, settings.MOTTO_CACHE_NEGATIVE_TTL);
+
+    // A rate of zero would keep team name queries waiting forever
+    if (settings.MOTTO_REQUEST_RATE <= 0)
+    {
+        settings.MOTTO_REQUEST_RATE = 2;
     }
 
+    settings.MOTTO_REQUEST_BURST = std::max(1, settings.MOTTO_REQUEST_BURST);
+    settings.MOTTO_QUEUE_LIMIT   = std::max(1, settings.MOTTO_QUEUE_LIMIT);
+
     // We don't need to advertise that VERBOSE_LEVEL failed so let's set it to 4, which is the default
-    if (VERBOSE_LEVEL > 4 || VERBOSE_LEVEL < 0 || config.item(section, "VERBOSE_LEVEL").empty())
+    if (settings.VERBOSE_LEVEL > 4 || settings.VERBOSE_LEVEL < 0 || config.item(section, "VERBOSE_LEVEL").empty())
+    {
+        settings.VERBOSE_LEVEL = 4;
+    }
+
+    return valid;
+}
+
+// Re-read the configuration file while the plugin is running. The current match, its roster, and
+// the team mottos are left untouched; only the settings are swapped out if the new file is valid.
+bool LeagueOverseer::reloadConfig()
+{
+    PluginSettings settings;
+
+    if (!parseConfig(CONFIG_PATH.c_str(), settings))
+    {
+        bz_debugMessage(0, "WARNING :: League Overseer :: The configuration file was not reloaded because it contains errors.");
+        return false;
+    }
+
+    PluginSettings previous = *this;
+    static_cast<PluginSettings&>(*this) = settings;
+
+    bz_debugMessage(DEBUG_LEVEL, "DEBUG :: League Overseer :: Configuration file reloaded.");
+    printConfig();
+
+    // Only redo the work that depends on the settings that actually changed
+    if (MAPCHANGE_PATH != previous.MAPCHANGE_PATH || ROTATION_LEAGUE != previous.ROTATION_LEAGUE)
+    {
+        mapChangeWatcher.stop();
+        readMapName();
+    }
+
+    if (SHARED_MOTTO_CACHE != previous.SHARED_MOTTO_CACHE)
+    {
+        sharedMottos.close();
+
+        if (!SHARED_MOTTO_CACHE.empty() && !sharedMottos.open(SHARED_MOTTO_CACHE))
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: The shared motto cache at %s could not be opened.", SHARED_MOTTO_CACHE.c_str());
+        }
+
+        refreshTeamMottos();
+    }
+
+    if (METRICS_PATH != previous.METRICS_PATH || METRICS_INTERVAL != previous.METRICS_INTERVAL)
+    {
+        startMetricsTimer();
+    }
+
+    if (LIVE_STATE_PATH != previous.LIVE_STATE_PATH || LIVE_STATE_INTERVAL != previous.LIVE_STATE_INTERVAL)
     {
-        VERBOSE_LEVEL = 4;
+        startLiveStateTimer();
     }
 
-    // Output the configuration settings
+    if ((CHECKPOINT_PATH != previous.CHECKPOINT_PATH || CHECKPOINT_INTERVAL != previous.CHECKPOINT_INTERVAL) && currentMatch != NULL && bz_isCountDownActive())
+    {
+        startCheckpointTimer();
+    }
+
+    if (MATCH_HISTORY_PATH != previous.MATCH_HISTORY_PATH)
+    {
+        openMatchHistory();
+    }
+
+    if (REPLAY_CATALOG_PATH != previous.REPLAY_CATALOG_PATH || REPLAY_PATH != previous.REPLAY_PATH)
+    {
+        openReplayCatalog();
+    }
+    else if (REPLAY_MAX_SIZE != previous.REPLAY_MAX_SIZE || REPLAY_MAX_AGE != previous.REPLAY_MAX_AGE ||
+             REPLAY_OFFICIAL_MAX_AGE != previous.REPLAY_OFFICIAL_MAX_AGE)
+    {
+        pruneReplays();
+    }
+
+    if (HTTP_TRANSPORT != previous.HTTP_TRANSPORT || SIDECAR_SOCKET != previous.SIDECAR_SOCKET)
+    {
+        startHTTPTransport();
+    }
+
+    mottoCache.setCapacity(MOTTO_CACHE_SIZE);
+
+    return true;
+}
+
+// Output the configuration settings
+void LeagueOverseer::printConfig()
+{
     bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Configuration File Settings");
     bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: ---------------------------");
     bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Rotational league set to  : %s", (ROTATION_LEAGUE) ? "true" : "false");
@@ -1511,10 +7758,96 @@ void LeagueOverseer::loadConfig(const char* cmdLine)
         bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Fetching Team Names from  : %s", TEAM_NAME_URL.c_str());
     }
 
+    if (!DISABLE_REPORT || !DISABLE_MOTTO)
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Requests sent by          : %s%s%s", HTTP_TRANSPORT.c_str(),
+                         (HTTP_TRANSPORT == "sidecar") ? " at " : "", (HTTP_TRANSPORT == "sidecar") ? SIDECAR_SOCKET.c_str() : "");
+    }
+
+    if (!METRICS_PATH.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Writing metrics to        : %s (every %.0f seconds)", METRICS_PATH.c_str(), METRICS_INTERVAL);
+    }
+
+    if (!SHARED_MOTTO_CACHE.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Sharing team mottos via   : %s", SHARED_MOTTO_CACHE.c_str());
+    }
+
+    if (!DISABLE_MOTTO)
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Caching team names of   : %d players (%.0f/%.0f seconds)", MOTTO_CACHE_SIZE, MOTTO_CACHE_TTL, MOTTO_CACHE_NEGATIVE_TTL);
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Team name queries limited : %.1f per second (burst of %d, queue of %d)", MOTTO_REQUEST_RATE, MOTTO_REQUEST_BURST, MOTTO_QUEUE_LIMIT);
+    }
+
+    if (!CHECKPOINT_PATH.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Checkpointing matches to  : %s (every %.0f seconds)", CHECKPOINT_PATH.c_str(), CHECKPOINT_INTERVAL);
+    }
+
+    if (!HEATMAP_PATH.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Saving heatmaps to        : %s (%.0f unit cells)", HEATMAP_PATH.c_str(), HEATMAP_CELL_SIZE);
+    }
+
+    if (!LIVE_STATE_PATH.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Publishing live state to  : %s (every %.1f seconds)", LIVE_STATE_PATH.c_str(), LIVE_STATE_INTERVAL);
+    }
+
+    if (!REPLAY_CATALOG_PATH.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Cataloging replays in     : %s (%d replays, %.0f MB)", REPLAY_CATALOG_PATH.c_str(),
+                         (int)replayCatalog.size(), replayCatalog.totalSize() / (1024.0 * 1024.0));
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Replays kept for at most  : %.0f MB, %.0f days (%.0f for officials)",
+                         REPLAY_MAX_SIZE, REPLAY_MAX_AGE, REPLAY_OFFICIAL_MAX_AGE);
+    }
+
+    if (!MATCH_HISTORY_PATH.empty())
+    {
+        bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Match history kept in     : %s (%d matches)", MATCH_HISTORY_PATH.c_str(), (int)matchHistory.size());
+    }
+
     bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Debug level set to        : %d", DEBUG_LEVEL);
     bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Verbose level set to      : %d", VERBOSE_LEVEL);
 }
 
+// Read the name of the map currently being played from the file mapchange writes and keep watching
+// the file so the name is only read again when mapchange rotates the map
+void LeagueOverseer::readMapName()
+{
+    // Check to see if the plugin is for a rotational league
+    if (MAPCHANGE_PATH != "" && ROTATION_LEAGUE)
+    {
+        if (!mapChangeWatcher.isWatching())
+        {
+            mapChangeWatcher.watch(MAPCHANGE_PATH);
+        }
+
+        // Open the mapchange.out file to see what map is being used
+        std::ifstream infile;
+        infile.open(MAPCHANGE_PATH.c_str());
+
+        if (!infile)
+        {
+            bz_debugMessagef(DEBUG_LEVEL, "WARNING :: League Overseer :: Could not read the current map from %s", MAPCHANGE_PATH.c_str());
+            return;
+        }
+
+        getline(infile, MAP_NAME);
+        infile.close();
+
+        // mapchange may leave a trailing carriage return or whitespace behind
+        MAP_NAME.erase(MAP_NAME.find_last_not_of(" \t\r\n") + 1);
+
+        bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Current map being played: %s", MAP_NAME.c_str());
+    }
+    else
+    {
+        mapChangeWatcher.stop();
+    }
+}
+
 // Request a team name update for all the members of a team
 void LeagueOverseer::requestTeamName (bz_eTeamType team)
 {
@@ -1550,7 +7883,7 @@ void LeagueOverseer::requestTeamName (std::string callsign, std::string bzID)
     bz_debugMessagef(DEBUG_LEVEL, "DEBUG :: League Overseer :: Sending motto request for '%s'", callsign.c_str());
 
     // Send the team update request to the league website
-    bz_addURLJob(TEAM_NAME_URL.c_str(), this, teamMotto.c_str());
+    addURLJob(eTeamNameJob, TEAM_NAME_URL, teamMotto);
 }
 
 void LeagueOverseer::updateTeamNames ()
@@ -1559,5 +7892,85 @@ void LeagueOverseer::updateTeamNames ()
     std::string teamNameDump = "query=teamDump&apiVersion=" + intToString(API_VERSION);
     bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Updating Team name database...");
 
-    bz_addURLJob(TEAM_NAME_URL.c_str(), this, teamNameDump.c_str()); //Send the team update request to the league website
+    addURLJob(eTeamDumpJob, TEAM_NAME_URL, teamNameDump); //Send the team update request to the league website
+}
+
+// Make sure we have a team dump to use, either one shared by another server on this host or our own
+void LeagueOverseer::refreshTeamMottos ()
+{
+    timers.cancel(sharedMottoTimer);
+
+    if (sharedMottos.isOpen())
+    {
+        time_t now = time(NULL);
+
+        // Another server has recently published a team dump, so there's no need to download our own
+        if (sharedMottos.generation() > 0 && difftime(now, sharedMottos.publishedAt()) < SHARED_MOTTO_MAX_AGE)
+        {
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Using the shared team dump of %u BZIDs.", sharedMottos.size());
+            return;
+        }
+
+        // Another server is already downloading the team dump, so wait for it to publish it
+        if (!sharedMottos.claimRefresh(now, 60))
+        {
+            bz_debugMessagef(VERBOSE_LEVEL, "DEBUG :: League Overseer :: Waiting for another server to publish the shared team dump...");
+            sharedMottoTimer = scheduleTimer(5, 0, [this]() { refreshTeamMottos(); return false; });
+            return;
+        }
+    }
+
+    updateTeamNames();
+}
+
+// Get the team name of a BZID, or an empty string if they don't belong to a team
+std::string LeagueOverseer::getTeamMotto (const std::string &bzID)
+{
+    uint32_t key;
+    const std::string *motto = NULL;
+
+    if (parseBZID(bzID, key))
+    {
+        motto = mottoCache.lookup(key, bz_getCurrentTime());
+        motto = (motto) ? motto : teamMottos->lookup(key);
+    }
+
+    if (motto)
+    {
+        return *motto;
+    }
+
+    std::string teamName;
+    sharedMottos.lookup(bzID, teamName);
+
+    return teamName;
+}
+
+// The motto a player gets when they join. Most players are found in the team dump, which has their motto ready;
+// the few team names that come from elsewhere are encoded as they're used
+std::string LeagueOverseer::getPlayerMotto (const std::string &bzID)
+{
+    uint32_t key;
+
+    if (parseBZID(bzID, key))
+    {
+        const std::string *teamName = mottoCache.lookup(key, bz_getCurrentTime());
+
+        if (teamName)
+        {
+            return encodeMotto(*teamName);
+        }
+
+        const std::string *motto = teamMottos->lookupMotto(key);
+
+        if (motto)
+        {
+            return *motto;
+        }
+    }
+
+    std::string teamName;
+    sharedMottos.lookup(bzID, teamName);
+
+    return encodeMotto(teamName);
 }
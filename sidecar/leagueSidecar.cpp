@@ -0,0 +1,304 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// A minimal sidecar for HTTP_TRANSPORT = sidecar, meant as a reference for the protocol described in the README
+// rather than as the fastest way to speak it. It listens on a Unix domain socket and forwards every request it
+// reads to the league website with libcurl, each on a thread of its own so a slow match report doesn't hold up
+// the team name queries behind it, and writes the responses back in whatever order they finish.
+//
+//     leagueSidecar <socket path> <league URL> [match report URL]
+//
+// Match reports go to the match report URL when one is given, like MATCH_REPORT_URL, and everything else goes to
+// the league URL.
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <curl/curl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// The largest request we accept, anything bigger means the other end is speaking another protocol
+static const unsigned int MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+// The plug-in gives up on a match report after 60 seconds, so there's no point in waiting any longer than that
+static const long REQUEST_TIMEOUT = 60;
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void interrupt (int)
+{
+    interrupted = 1;
+}
+
+// A connection from the plug-in. It's shared by the threads forwarding its requests and only closed once the last
+// of them is done with it, so a response that finishes after the plug-in hung up can't end up on another connection
+class Connection
+{
+public:
+    Connection (int _fd) :
+        fd(_fd)
+    {}
+
+    ~Connection ()
+    {
+        close(fd);
+    }
+
+    int getFD () const { return fd; }
+
+    // Write a response frame in one piece, since requests finishing at the same time must not interleave them
+    void respond (unsigned int id, bool ok, const std::string &body)
+    {
+        char header[64];
+        snprintf(header, sizeof(header), "%u %s %u\n", id, (ok) ? "ok" : "error", (unsigned int)body.size());
+
+        std::string frame = header + body;
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t written = 0;
+
+        while (written < frame.size())
+        {
+            ssize_t result = send(fd, frame.data() + written, frame.size() - written, MSG_NOSIGNAL);
+
+            if (result < 0)
+            {
+                // The plug-in hung up and has already failed the request on its end
+                if (errno != EINTR)
+                {
+                    return;
+                }
+            }
+            else
+            {
+                written += result;
+            }
+        }
+    }
+
+private:
+    int        fd;
+    std::mutex mutex;
+};
+
+static size_t collectResponse (char *data, size_t size, size_t count, void *userdata)
+{
+    static_cast<std::string*>(userdata)->append(data, size * count);
+
+    return size * count;
+}
+
+// POST a request to the league website and answer the plug-in with what came back. Like bzfs, an HTTP error
+// status is an error
+static void forward (std::shared_ptr<Connection> connection, unsigned int id, std::string url, std::string postData)
+{
+    CURL *easy = curl_easy_init();
+
+    if (!easy)
+    {
+        connection->respond(id, false, "the request could not be set up");
+        return;
+    }
+
+    std::string response;
+
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)postData.size());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, postData.data());
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, REQUEST_TIMEOUT);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &collectResponse);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &response);
+
+    CURLcode result = curl_easy_perform(easy);
+    curl_easy_cleanup(easy);
+
+    if (result == CURLE_OK)
+    {
+        connection->respond(id, true, response);
+    }
+    else
+    {
+        connection->respond(id, false, curl_easy_strerror(result));
+    }
+}
+
+// Whether the POST data of a request is a match report, i.e. it has a query=reportMatch field
+static bool isMatchReport (const std::string &postData)
+{
+    static const std::string FIELD = "query=reportMatch";
+
+    for (size_t position = postData.find(FIELD); position != std::string::npos; position = postData.find(FIELD, position + 1))
+    {
+        size_t end = position + FIELD.size();
+
+        if ((position == 0 || postData[position - 1] == '&') && (end == postData.size() || postData[end] == '&'))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Read the requests of one connection until the plug-in hangs up or stops making sense
+static void serve (int fd, std::string leagueURL, std::string reportURL)
+{
+    std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+    std::string input;
+    char buffer[16384];
+
+    while (true)
+    {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (received <= 0)
+        {
+            return;
+        }
+
+        input.append(buffer, received);
+
+        size_t position = 0;
+
+        while (true)
+        {
+            size_t newline = input.find('\n', position);
+
+            if (newline == std::string::npos)
+            {
+                break;
+            }
+
+            std::string header = input.substr(position, newline - position);
+            unsigned int id = 0, length = 0;
+
+            if (sscanf(header.c_str(), "%u %u", &id, &length) != 2 || length > MAX_FRAME_SIZE)
+            {
+                fprintf(stderr, "Dropping a connection that sent a malformed request header: %s\n", header.c_str());
+                return;
+            }
+
+            if (input.size() - newline - 1 < length)
+            {
+                break;
+            }
+
+            std::string postData = input.substr(newline + 1, length);
+            std::string url = (!reportURL.empty() && isMatchReport(postData)) ? reportURL : leagueURL;
+
+            std::thread(forward, connection, id, url, postData).detach();
+
+            position = newline + 1 + length;
+        }
+
+        input.erase(0, position);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s <socket path> <league URL> [match report URL]\n", argv[0]);
+        return 1;
+    }
+
+    std::string path      = argv[1],
+                leagueURL = argv[2],
+                reportURL = (argc > 3) ? argv[3] : "";
+
+    struct sockaddr_un address;
+
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "The socket path %s is too long.\n", path.c_str());
+        return 1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    // A socket left behind by a sidecar that didn't shut down cleanly would keep us from listening
+    struct stat fileInfo;
+
+    if (stat(path.c_str(), &fileInfo) == 0 && S_ISSOCK(fileInfo.st_mode))
+    {
+        unlink(path.c_str());
+    }
+
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0)
+    {
+        perror("The socket could not be opened");
+        return 1;
+    }
+
+    // Without SA_RESTART, accept() is interrupted so we can clean up after ourselves
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = interrupt;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Forwarding requests from %s to %s\n", path.c_str(), leagueURL.c_str());
+    fflush(stdout);
+
+    while (!interrupted)
+    {
+        int fd = accept(listener, NULL, NULL);
+
+        if (fd >= 0)
+        {
+            std::thread(serve, fd, leagueURL, reportURL).detach();
+        }
+        else if (errno != EINTR)
+        {
+            perror("accept");
+            break;
+        }
+    }
+
+    close(listener);
+    unlink(path.c_str());
+
+    return 0;
+}
@@ -0,0 +1,317 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Loads the plugin into the bzfs stand-in, plays a few matches and counts the heap allocations the plugin makes while
+// handling each type of event. Once every handler has run a few times, the handlers that run during play must
+// not allocate at all. Joining is allowed a small budget since it may have to ask the league website for a team
+// name, and so are the start and end of a match, which set up and report the match.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unistd.h>
+
+#include "mockBzfs.h"
+
+// Only allocations made by the thread that is playing the match are counted, and only while we're measuring
+static thread_local bool countAllocations = false;
+static size_t allocations = 0;
+
+void* operator new (size_t size)
+{
+    if (countAllocations)
+    {
+        allocations++;
+    }
+
+    void *p = malloc(size ? size : 1);
+
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void* operator new[] (size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete (void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[] (void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete (void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[] (void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// The number of allocations a single event of each type may make once the plugin has warmed up
+struct EventBudget
+{
+    const char* name;
+    size_t      budget;
+    size_t      calls;
+    size_t      allocations;
+    size_t      most;
+};
+
+enum EventType
+{
+    eJoin = 0,
+    ePart,
+    eGameStart,
+    eGameEnd,
+    eAnswer,
+    eSpawn,
+    eDie,
+    eFlagGrab,
+    eFlagDrop,
+    eCapture,
+    eTick,
+    EVENT_TYPE_COUNT
+};
+
+static EventBudget budgets[EVENT_TYPE_COUNT] =
+{
+    { "join",       16,  0, 0, 0 },
+    { "part",       0,   0, 0, 0 },
+    { "game start", 12,  0, 0, 0 },
+    { "game end",   168, 0, 0, 0 },
+    { "answer",     12,  0, 0, 0 },
+    { "spawn",      0,   0, 0, 0 },
+    { "die",        0,   0, 0, 0 },
+    { "flag grab",  0,   0, 0, 0 },
+    { "flag drop",  0,   0, 0, 0 },
+    { "capture",    0,   0, 0, 0 },
+    { "tick",       0,   0, 0, 0 }
+};
+
+static bool measuring = false;
+
+// Count what an event allocated if we're past the warm up
+static void record (EventType type, size_t made)
+{
+    if (measuring)
+    {
+        budgets[type].calls++;
+        budgets[type].allocations += made;
+        budgets[type].most = std::max(budgets[type].most, made);
+    }
+}
+
+// Run an event and count what it allocates
+template <typename Function>
+static void measure (EventType type, Function function)
+{
+    size_t before = allocations;
+
+    countAllocations = measuring;
+    function();
+    countAllocations = false;
+
+    record(type, allocations - before);
+}
+
+// bzfs starts and ends matches and answers requests from its main loop, so a tick that starts or ends a match or
+// hands us the league website's answer is counted as that instead
+static void tick ()
+{
+    bool wasInProgress = bz_isCountDownActive();
+    size_t before = allocations,
+           answered = mockBzfs::finishedURLJobs();
+
+    mockBzfs::advanceTime(0.05);
+
+    countAllocations = measuring;
+    mockBzfs::tick();
+    countAllocations = false;
+
+    bool inProgress = bz_isCountDownActive();
+    EventType type = eTick;
+
+    if (!wasInProgress && inProgress)
+    {
+        type = eGameStart;
+    }
+    else if (wasInProgress && !inProgress)
+    {
+        type = eGameEnd;
+    }
+    else if (mockBzfs::finishedURLJobs() != answered)
+    {
+        type = eAnswer;
+    }
+
+    record(type, allocations - before);
+}
+
+// A second of a 2 vs 2 capture the flag match
+static void playRound (int players[4])
+{
+    for (int i = 0; i < 4; i++)
+    {
+        measure(eSpawn, [&]() { mockBzfs::spawnPlayer(players[i]); });
+    }
+
+    measure(eFlagGrab, [&]() { mockBzfs::grabFlag(players[0], "B*"); });
+    measure(eFlagGrab, [&]() { mockBzfs::grabFlag(players[2], "R*"); });
+    measure(eDie, [&]() { mockBzfs::killPlayer(players[2], players[1]); });
+    measure(eFlagDrop, [&]() { mockBzfs::dropFlag(players[2], "R*"); });
+    measure(eFlagGrab, [&]() { mockBzfs::grabFlag(players[1], "R*"); });
+    measure(eCapture, [&]() { mockBzfs::captureFlag(players[0], eBlueTeam); });
+    measure(eDie, [&]() { mockBzfs::killPlayer(players[3], players[0]); });
+    measure(eDie, [&]() { mockBzfs::killPlayer(players[0], players[3]); });
+    measure(eDie, [&]() { mockBzfs::killPlayer(players[1], players[2]); });
+
+    // Ticks come a lot more often than anything else
+    for (int i = 0; i < 20; i++)
+    {
+        tick();
+    }
+}
+
+// Play a fun match from its countdown until it runs out of time. Every so often one of the players leaves and
+// somebody new takes their place
+static void playMatch (int players[4], int &newcomers)
+{
+    mockBzfs::runCommand(players[0], "/fm 10");
+
+    while (!bz_isCountDownActive())
+    {
+        tick();
+    }
+
+    for (int round = 1; bz_isCountDownActive(); round++)
+    {
+        playRound(players);
+
+        if (round % 10 == 0)
+        {
+            int leaving = round / 10 % 4;
+            char callsign[32], bzID[32];
+
+            snprintf(callsign, sizeof(callsign), "newcomer %d", newcomers);
+            snprintf(bzID, sizeof(bzID), "%d", 2000 + newcomers);
+            newcomers++;
+
+            measure(ePart, [&]() { mockBzfs::partPlayer(players[leaving]); });
+            measure(eJoin, [&]() { players[leaving] = mockBzfs::joinPlayer(callsign, bzID, (leaving < 2) ? eRedTeam : eBlueTeam); });
+        }
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    char directory[] = "/tmp/leagueOverSeer-allocationCheck-XXXXXX";
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    std::string config = std::string(directory) + "/leagueOverSeer.cfg";
+    std::string matchHistory = std::string(directory) + "/matches.dat";
+    FILE *file = fopen(config.c_str(), "w");
+
+    if (!file)
+    {
+        perror("fopen");
+        return 1;
+    }
+
+    fprintf(file, "[leagueOverSeer]\n");
+    fprintf(file, "  LEAGUE_OVERSEER_URL = http://localhost/leagueOverSeer.php\n");
+    fprintf(file, "  DEBUG_LEVEL = 1\n");
+    fprintf(file, "  MATCH_HISTORY_PATH = %s\n", matchHistory.c_str());
+    fprintf(file, "  HEATMAP_PATH = %s\n", directory);
+    fclose(file);
+
+    mockBzfs::setDebugLevel((argc > 1) ? atoi(argv[1]) : -1);
+
+    // Two minute matches, so a few of them are played in full
+    bz_setTimeLimit(120);
+
+    if (!mockBzfs::loadPlugin(config))
+    {
+        fprintf(stderr, "The plugin could not be loaded.\n");
+        return 1;
+    }
+
+    int players[4], newcomers = 0;
+
+    players[0] = mockBzfs::joinPlayer("alice", "1001", eRedTeam);
+    players[1] = mockBzfs::joinPlayer("bob", "1002", eRedTeam);
+    players[2] = mockBzfs::joinPlayer("carol", "1003", eBlueTeam);
+    players[3] = mockBzfs::joinPlayer("dave", "1004", eBlueTeam);
+
+    // Warm up: every handler gets to size whatever it keeps around
+    playMatch(players, newcomers);
+
+    measuring = true;
+
+    for (int i = 0; i < 3; i++)
+    {
+        playMatch(players, newcomers);
+    }
+
+    measuring = false;
+
+    mockBzfs::unloadPlugin();
+
+    bool failed = false;
+
+    printf("%-10s %8s %12s %8s %8s\n", "Event", "Calls", "Allocations", "Most", "Budget");
+
+    for (int i = 0; i < EVENT_TYPE_COUNT; i++)
+    {
+        bool overBudget = budgets[i].most > budgets[i].budget;
+
+        printf("%-10s %8zu %12zu %8zu %8zu%s\n", budgets[i].name, budgets[i].calls, budgets[i].allocations, budgets[i].most,
+               budgets[i].budget, (overBudget) ? "  <-- over budget" : "");
+
+        failed = failed || overBudget;
+    }
+
+    std::string cleanup = std::string("rm -rf ") + directory;
+
+    if (system(cleanup.c_str()) != 0)
+    {
+        fprintf(stderr, "%s could not be removed.\n", directory);
+    }
+
+    return (failed) ? 1 : 0;
+}
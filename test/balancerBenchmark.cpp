@@ -0,0 +1,402 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Simulates thousands of players joining and leaving a server that picks their team automatically, and prints how
+// even the teams the plug-in picked were and how long each pick took.
+//
+// Every simulated player has a hidden skill. A few hundred short matches are played first, each won by the side
+// with more skill give or take some luck, so the plug-in's match history learns a rating for everyone. Players then
+// come and go at random and the plug-in picks the team of everyone who joins. The same joins and parts are also
+// played out with bzfs' own rule of putting a player on the smaller team, so the two can be compared.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "mockBzfs.h"
+
+struct BenchmarkOptions
+{
+    BenchmarkOptions () :
+        pool(200),
+        ratingMatches(300),
+        events(10000),
+        minPlayers(8),
+        maxPlayers(32),
+        seed(1),
+        verbose(-1)
+    {}
+
+    int      pool;          // The number of different players who come and go
+    int      ratingMatches; // The number of matches played to rate them
+    int      events;        // The number of joins and parts to simulate
+    int      minPlayers,    // The server never has fewer or more players than this
+             maxPlayers;
+    unsigned seed;          // Seed for everything picked at random
+    int      verbose;       // The bzfs debug level to print messages at
+};
+
+static void usage (const char* program)
+{
+    printf("Usage: %s [option value]...\n\n", program);
+    printf("  --pool <n>                different players coming and going (200)\n");
+    printf("  --rating-matches <n>      matches played to rate them first (300)\n");
+    printf("  --events <n>              joins and parts to simulate (10000)\n");
+    printf("  --min-players <n>         fewest players on the server (8)\n");
+    printf("  --max-players <n>         most players on the server (32)\n");
+    printf("  --seed <n>                seed for everything picked at random (1)\n");
+    printf("  --verbose <level>         print bzfs messages up to this debug level\n");
+}
+
+static bool parseOptions (int argc, char *argv[], BenchmarkOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string name = argv[i];
+
+        if (i + 1 >= argc || name.compare(0, 2, "--") != 0)
+        {
+            return false;
+        }
+
+        const char* value = argv[++i];
+
+        if      (name == "--pool")           options.pool          = atoi(value);
+        else if (name == "--rating-matches") options.ratingMatches = atoi(value);
+        else if (name == "--events")         options.events        = atoi(value);
+        else if (name == "--min-players")    options.minPlayers    = atoi(value);
+        else if (name == "--max-players")    options.maxPlayers    = atoi(value);
+        else if (name == "--seed")           options.seed          = strtoul(value, NULL, 10);
+        else if (name == "--verbose")        options.verbose       = atoi(value);
+        else return false;
+    }
+
+    return options.pool >= 8 && options.minPlayers >= 0 && options.maxPlayers > options.minPlayers &&
+           options.maxPlayers <= options.pool && options.maxPlayers <= 64;
+}
+
+struct SimulatedPlayer
+{
+    std::string  callsign,
+                 bzID;
+    double       skill;
+    int          slot;          // The player's slot on the server; -1 while they're away
+    bz_eTeamType team,          // The team the plug-in picked
+                 smallerTeam;   // The team bzfs' own rule would have picked
+};
+
+// How even two teams are, by number of players and, whenever they have as many players, by the sum of their hidden
+// skills. A player more on one side outweighs any difference in skill, so uneven teams would only hide it
+struct Imbalance
+{
+    Imbalance () :
+        samples(0),
+        evenSamples(0),
+        sizeTotal(0),
+        sizeWorst(0),
+        skillTotal(0),
+        skillWorst(0)
+    {}
+
+    void add (int size, double skill)
+    {
+        samples++;
+        sizeTotal += size;
+        sizeWorst  = std::max(sizeWorst, size);
+
+        if (size == 0)
+        {
+            evenSamples++;
+            skillTotal += skill;
+            skillWorst  = std::max(skillWorst, skill);
+        }
+    }
+
+    size_t samples,
+           evenSamples;
+    double sizeTotal;
+    int    sizeWorst;
+    double skillTotal,
+           skillWorst;
+};
+
+static double randomUnit (unsigned &state)
+{
+    return rand_r(&state) / ((double)RAND_MAX + 1);
+}
+
+// Let the game clock run, a tick every half second
+static void runFor (double seconds)
+{
+    for (double t = 0; t < seconds; t += 0.5)
+    {
+        mockBzfs::advanceTime(0.5);
+        mockBzfs::tick();
+    }
+}
+
+// Play a short fun match between two random teams of four. The side with more skill is more likely to capture
+static void playRatingMatch (std::vector<SimulatedPlayer> &pool, unsigned &state)
+{
+    std::vector<int> picked;
+
+    while (picked.size() < 8)
+    {
+        int i = rand_r(&state) % pool.size();
+
+        if (std::find(picked.begin(), picked.end(), i) == picked.end())
+        {
+            picked.push_back(i);
+        }
+    }
+
+    double skill[2] = { 0, 0 };
+
+    for (size_t i = 0; i < picked.size(); i++)
+    {
+        SimulatedPlayer &player = pool[picked[i]];
+
+        player.team = (i < 4) ? eRedTeam : eBlueTeam;
+        player.slot = mockBzfs::joinPlayer(player.callsign.c_str(), player.bzID.c_str(), player.team);
+        skill[i / 4] += player.skill;
+    }
+
+    mockBzfs::runCommand(pool[picked[0]].slot, "/fm 10");
+
+    while (!bz_isCountDownActive())
+    {
+        runFor(0.5);
+    }
+
+    for (int i : picked)
+    {
+        mockBzfs::spawnPlayer(pool[i].slot);
+    }
+
+    // Red's chance of winning each capture, the way an Elo rating would predict it
+    double redOdds = 1.0 / (1.0 + pow(10.0, (skill[1] - skill[0]) / 4 / 400.0));
+
+    while (bz_isCountDownActive())
+    {
+        bool redCaptures = randomUnit(state) < redOdds;
+        int capper = picked[(redCaptures ? 0 : 4) + rand_r(&state) % 4];
+
+        mockBzfs::captureFlag(pool[capper].slot, (redCaptures) ? eBlueTeam : eRedTeam);
+        runFor(5);
+    }
+
+    runFor(0.5);
+
+    for (int i : picked)
+    {
+        mockBzfs::partPlayer(pool[i].slot);
+        pool[i].slot = -1;
+    }
+}
+
+// Add up how even the teams are, for the teams the plug-in picked and for the ones bzfs would have
+static void measureTeams (const std::vector<SimulatedPlayer> &pool, Imbalance &picked, Imbalance &smaller)
+{
+    int    pickedSize[2]   = { 0, 0 },  smallerSize[2]  = { 0, 0 };
+    double pickedSkill[2]  = { 0, 0 },  smallerSkill[2] = { 0, 0 };
+
+    for (auto &player : pool)
+    {
+        if (player.slot < 0)
+        {
+            continue;
+        }
+
+        int side = (player.team == eRedTeam) ? 0 : 1;
+        pickedSize[side]++;
+        pickedSkill[side] += player.skill;
+
+        side = (player.smallerTeam == eRedTeam) ? 0 : 1;
+        smallerSize[side]++;
+        smallerSkill[side] += player.skill;
+    }
+
+    picked.add(std::abs(pickedSize[0] - pickedSize[1]), std::fabs(pickedSkill[0] - pickedSkill[1]));
+    smaller.add(std::abs(smallerSize[0] - smallerSize[1]), std::fabs(smallerSkill[0] - smallerSkill[1]));
+}
+
+int main (int argc, char *argv[])
+{
+    BenchmarkOptions options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char directory[] = "/tmp/leagueOverSeer-balancerBenchmark-XXXXXX";
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    std::string config = std::string(directory) + "/leagueOverSeer.cfg";
+    std::string matchHistory = std::string(directory) + "/matches.dat";
+    FILE *file = fopen(config.c_str(), "w");
+
+    if (!file)
+    {
+        perror("fopen");
+        return 1;
+    }
+
+    fprintf(file, "[leagueOverSeer]\n");
+    fprintf(file, "  LEAGUE_OVERSEER_URL = http://localhost/leagueOverSeer.php\n");
+    fprintf(file, "  DEBUG_LEVEL = 1\n");
+    fprintf(file, "  DISABLE_MATCH_REPORT = true\n");
+    fprintf(file, "  DISABLE_TEAM_MOTTO = true\n");
+    fprintf(file, "  MATCH_HISTORY_PATH = %s\n", matchHistory.c_str());
+    fclose(file);
+
+    mockBzfs::setDebugLevel(options.verbose);
+    bz_setTimeLimit(30);
+
+    if (!mockBzfs::loadPlugin(config, eRedTeam, eBlueTeam, options.maxPlayers))
+    {
+        fprintf(stderr, "The plugin could not be loaded.\n");
+        return 1;
+    }
+
+    unsigned state = options.seed;
+    std::vector<SimulatedPlayer> pool(options.pool);
+
+    // Skills are spread roughly like a normal distribution around 1500
+    for (int i = 0; i < options.pool; i++)
+    {
+        double spread = 0;
+
+        for (int j = 0; j < 6; j++)
+        {
+            spread += randomUnit(state) - 0.5;
+        }
+
+        pool[i].callsign    = "player" + std::to_string(i);
+        pool[i].bzID        = std::to_string(1001 + i);
+        pool[i].skill       = 1500 + spread * 250;
+        pool[i].slot        = -1;
+        pool[i].team        = eNoTeam;
+        pool[i].smallerTeam = eNoTeam;
+    }
+
+    for (int i = 0; i < options.ratingMatches; i++)
+    {
+        playRatingMatch(pool, state);
+    }
+
+    Imbalance picked, smaller;
+    std::vector<double> pickTimes;
+    int online = 0, smallerCount[2] = { 0, 0 };
+
+    for (int event = 0; event < options.events; event++)
+    {
+        bool join = (online < options.minPlayers) || (online < options.maxPlayers && rand_r(&state) % 2 == 0);
+        int i;
+
+        // Someone who isn't on the server joins, or someone who is leaves
+        do
+        {
+            i = rand_r(&state) % options.pool;
+        }
+        while ((pool[i].slot < 0) != join);
+
+        SimulatedPlayer &player = pool[i];
+
+        if (join)
+        {
+            player.slot = mockBzfs::joinPlayer(player.callsign.c_str(), player.bzID.c_str(), eRogueTeam);
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            player.team = mockBzfs::pickTeam(player.slot);
+            pickTimes.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+
+            if (player.team == eNoTeam)
+            {
+                fprintf(stderr, "The plug-in didn't pick a team for %s.\n", player.callsign.c_str());
+                return 1;
+            }
+
+            mockBzfs::changeTeam(player.slot, player.team);
+            mockBzfs::spawnPlayer(player.slot);
+
+            player.smallerTeam = (smallerCount[0] <= smallerCount[1]) ? eRedTeam : eBlueTeam;
+            smallerCount[(player.smallerTeam == eRedTeam) ? 0 : 1]++;
+            online++;
+        }
+        else
+        {
+            mockBzfs::partPlayer(player.slot);
+            smallerCount[(player.smallerTeam == eRedTeam) ? 0 : 1]--;
+            player.slot = -1;
+            online--;
+        }
+
+        mockBzfs::advanceTime(0.5);
+        mockBzfs::tick();
+
+        measureTeams(pool, picked, smaller);
+    }
+
+    mockBzfs::unloadPlugin();
+
+    std::sort(pickTimes.begin(), pickTimes.end());
+
+    double total = 0;
+
+    for (double t : pickTimes)
+    {
+        total += t;
+    }
+
+    printf("%d players rated in %d matches, then %d joins and parts with %d to %d players on the server\n\n",
+           options.pool, options.ratingMatches, options.events, options.minPlayers, options.maxPlayers);
+    printf("Teams          Size difference   Skill difference when even\n");
+    printf("                   avg     max        avg     max   of the time\n");
+    printf("%-14s %7.2f %7d %10.0f %7.0f %12.0f%%\n", "picked", picked.sizeTotal / picked.samples, picked.sizeWorst,
+           picked.skillTotal / std::max((size_t)1, picked.evenSamples), picked.skillWorst, 100.0 * picked.evenSamples / picked.samples);
+    printf("%-14s %7.2f %7d %10.0f %7.0f %12.0f%%\n", "smaller team", smaller.sizeTotal / smaller.samples, smaller.sizeWorst,
+           smaller.skillTotal / std::max((size_t)1, smaller.evenSamples), smaller.skillWorst, 100.0 * smaller.evenSamples / smaller.samples);
+
+    if (!pickTimes.empty())
+    {
+        printf("\n%zu team picks: %.0f ns on average, %.0f ns at the median, %.0f ns at the 99th percentile\n", pickTimes.size(),
+               total / pickTimes.size(), pickTimes[pickTimes.size() / 2], pickTimes[pickTimes.size() * 99 / 100]);
+    }
+
+    std::string cleanup = std::string("rm -rf ") + directory;
+
+    if (system(cleanup.c_str()) != 0)
+    {
+        fprintf(stderr, "%s could not be removed.\n", directory);
+    }
+
+    return 0;
+}
@@ -0,0 +1,608 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Plays matches on the bzfs stand-in while players come and go, with the plug-in talking to a mock league website
+// that is slow and unreliable on purpose. At the end it prints what became of the plug-in's requests according to
+// both the plug-in's metrics and the mock league, and fails if a match report or any other request went missing.
+//
+// The game clock runs up to --speed times faster than the wall clock so a few matches don't take all afternoon; the
+// league website and the timeouts of the requests sent to it run on the wall clock like they would on a server. The
+// game clock moves by the same step every 10 milliseconds however long the step really took, so the same seed plays
+// the same matches, and once they're over the server keeps running until every request the plug-in sent has been
+// answered, has timed out or has failed.
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#include "mockBzfs.h"
+#include "mockLeague.h"
+
+struct LoadTestOptions
+{
+    LoadTestOptions () :
+        transport("bzfs"),
+        sidecar("./leagueSidecar"),
+        matches(3),
+        matchLength(60),
+        players(40),
+        speed(4),
+        timeout(2),
+        mottoRate(20),
+        mottoCacheTTL(10),
+        verbose(-1)
+    {}
+
+    std::string transport;     // HTTP_TRANSPORT; with bzfs, the stand-in sends the requests like bzfs would
+    std::string sidecar;       // The sidecar program started for HTTP_TRANSPORT = sidecar
+    int         matches;       // The number of matches to play
+    double      matchLength;   // The length of a match in seconds of game time
+    int         players;       // The number of different players who come and go
+    double      speed;         // How much faster the game clock runs than the wall clock, at most
+    double      timeout;       // The wall clock seconds the stand-in for bzfs gives a request before timing out
+    double      mottoRate;     // MOTTO_REQUEST_RATE
+    double      mottoCacheTTL; // MOTTO_CACHE_TTL and MOTTO_CACHE_NEGATIVE_TTL
+    int         verbose;       // The bzfs debug level to print messages at
+
+    MockLeague::Settings league;
+};
+
+static void usage (const char* program)
+{
+    printf("Usage: %s [option value]...\n\n", program);
+    printf("  --transport <bzfs|curl|sidecar>\n");
+    printf("                            who sends the requests to the league website (bzfs)\n");
+    printf("  --sidecar <program>       the sidecar to start for --transport sidecar (./leagueSidecar)\n");
+    printf("  --matches <n>             matches to play (3)\n");
+    printf("  --match-length <s>        length of a match in game seconds (60)\n");
+    printf("  --players <n>             different players coming and going (40)\n");
+    printf("  --speed <x>               game seconds per wall clock second, at most (4)\n");
+    printf("  --timeout <s>             seconds bzfs gives a request before it times out (2)\n");
+    printf("  --motto-rate <n>          team name queries allowed per second (20)\n");
+    printf("  --motto-ttl <s>           seconds a team name is cached for (10)\n");
+    printf("  --latency <s>             seconds the league takes to answer (0.02)\n");
+    printf("  --jitter <s>              up to this many seconds more at random (0.01)\n");
+    printf("  --error-rate <share>      share of requests the league fails (0)\n");
+    printf("  --stall-rate <share>      share of requests the league never answers (0)\n");
+    printf("  --teams <n>               teams in the league (50)\n");
+    printf("  --team-size <n>           players on each team (6)\n");
+    printf("  --report-size <bytes>     size of the answer to a match report (64)\n");
+    printf("  --seed <n>                seed for everything picked at random (1)\n");
+    printf("  --verbose <level>         print bzfs messages up to this debug level\n");
+}
+
+static bool parseOptions (int argc, char *argv[], LoadTestOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string name = argv[i];
+
+        if (i + 1 >= argc || name.compare(0, 2, "--") != 0)
+        {
+            return false;
+        }
+
+        const char* value = argv[++i];
+
+        if      (name == "--transport")    options.transport          = value;
+        else if (name == "--sidecar")      options.sidecar            = value;
+        else if (name == "--matches")      options.matches            = atoi(value);
+        else if (name == "--match-length") options.matchLength        = atof(value);
+        else if (name == "--players")      options.players            = atoi(value);
+        else if (name == "--speed")        options.speed              = atof(value);
+        else if (name == "--timeout")      options.timeout            = atof(value);
+        else if (name == "--motto-rate")   options.mottoRate          = atof(value);
+        else if (name == "--motto-ttl")    options.mottoCacheTTL      = atof(value);
+        else if (name == "--latency")      options.league.latency     = atof(value);
+        else if (name == "--jitter")       options.league.jitter      = atof(value);
+        else if (name == "--error-rate")   options.league.errorRate   = atof(value);
+        else if (name == "--stall-rate")   options.league.stallRate   = atof(value);
+        else if (name == "--teams")        options.league.teams       = atoi(value);
+        else if (name == "--team-size")    options.league.teamSize    = atoi(value);
+        else if (name == "--report-size")  options.league.reportSize  = strtoul(value, NULL, 10);
+        else if (name == "--seed")         options.league.seed        = strtoul(value, NULL, 10);
+        else if (name == "--verbose")      options.verbose            = atoi(value);
+        else return false;
+    }
+
+    return options.matches > 0 && options.players >= 4 && options.speed > 0 && options.timeout > 0;
+}
+
+// Send a request the way bzfs would with libcurl: a POST on a connection of its own that is given up on after a
+// timeout, and an HTTP error status is an error
+static mockBzfs::URLResult postToLeague (const mockBzfs::URLJob &job, double timeout)
+{
+    mockBzfs::URLResult result;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(timeout * 1e6));
+
+    // We only ever talk to the mock league, so the URL is always http://127.0.0.1:<port>/<path>
+    std::string host, path = "/";
+    int port = 80;
+    size_t hostStart = job.url.find("://");
+    hostStart = (hostStart == std::string::npos) ? 0 : hostStart + 3;
+    size_t pathStart = job.url.find('/', hostStart);
+    std::string authority = job.url.substr(hostStart, (pathStart == std::string::npos) ? std::string::npos : pathStart - hostStart);
+    size_t colon = authority.find(':');
+
+    host = authority.substr(0, colon);
+    port = (colon == std::string::npos) ? 80 : atoi(authority.c_str() + colon + 1);
+    path = (pathStart == std::string::npos) ? "/" : job.url.substr(pathStart);
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port   = htons(port);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0 || inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+
+        result.status    = mockBzfs::URLResult::eError;
+        result.errorCode = 7;
+        result.error     = "Couldn't connect to server";
+        return result;
+    }
+
+    std::ostringstream request;
+    request << "POST " << path << " HTTP/1.1\r\n"
+            << "Host: " << authority << "\r\n"
+            << "Content-Type: application/x-www-form-urlencoded\r\n"
+            << "Content-Length: " << job.postData.size() << "\r\n"
+            << "Connection: close\r\n"
+            << "\r\n"
+            << job.postData;
+
+    std::string data = request.str(), response;
+    bool sent = (send(fd, data.data(), data.size(), MSG_NOSIGNAL) == (ssize_t)data.size());
+    bool timedOut = false;
+    char chunk[4096];
+
+    // The league closes the connection once it has answered
+    while (sent)
+    {
+        int remaining = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+        if (remaining <= 0)
+        {
+            timedOut = true;
+            break;
+        }
+
+        pollfd pfd = { fd, POLLIN, 0 };
+
+        if (poll(&pfd, 1, remaining) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+
+        if (n <= 0)
+        {
+            break;
+        }
+
+        response.append(chunk, n);
+    }
+
+    close(fd);
+
+    size_t headerEnd = response.find("\r\n\r\n");
+    int status = (response.compare(0, 5, "HTTP/") == 0) ? atoi(response.c_str() + response.find(' ') + 1) : 0;
+
+    if (timedOut)
+    {
+        result.status    = mockBzfs::URLResult::eTimeout;
+        result.errorCode = 28;
+    }
+    else if (!sent || headerEnd == std::string::npos || status == 0)
+    {
+        result.status    = mockBzfs::URLResult::eError;
+        result.errorCode = 52;
+        result.error     = "Server returned nothing (no headers, no data)";
+    }
+    else if (status >= 400)
+    {
+        std::ostringstream error;
+        error << "The requested URL returned error: " << status;
+
+        result.status    = mockBzfs::URLResult::eError;
+        result.errorCode = 22;
+        result.error     = error.str();
+    }
+    else
+    {
+        result.body = response.substr(headerEnd + 4);
+    }
+
+    return result;
+}
+
+// Read the counters the plug-in wrote to its metrics file, keyed by name and the type of request, the number of
+// requests that were still waiting on an answer when it was written and the number still waiting to be sent
+static std::map<std::string, double> readMetrics (const std::string &path, double &pending, double &queued)
+{
+    static const char* PENDING_METRIC = "leagueoverseer_url_jobs_pending{";
+    static const char* QUEUED_METRIC = "leagueoverseer_url_jobs_queued{";
+
+    std::map<std::string, double> metrics;
+    std::ifstream file(path.c_str());
+
+    pending = queued = 0;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#' || line.find("_bucket{") != std::string::npos)
+        {
+            continue;
+        }
+
+        if (line.compare(0, strlen(PENDING_METRIC), PENDING_METRIC) == 0)
+        {
+            pending = atof(line.c_str() + line.rfind(' ') + 1);
+            continue;
+        }
+
+        if (line.compare(0, strlen(QUEUED_METRIC), QUEUED_METRIC) == 0)
+        {
+            queued += atof(line.c_str() + line.rfind(' ') + 1);
+            continue;
+        }
+
+        size_t brace = line.find('{'), type = line.find("type=\""), space = line.rfind(' ');
+
+        if (brace == std::string::npos || type == std::string::npos || space == std::string::npos)
+        {
+            continue;
+        }
+
+        std::string typeName = line.substr(type + 6, line.find('"', type + 6) - type - 6);
+        metrics[line.substr(0, brace) + "/" + typeName] = atof(line.c_str() + space + 1);
+    }
+
+    return metrics;
+}
+
+// Start a sidecar that forwards requests from a socket to the league and wait for it to listen. Returns its process
+// ID, or -1 if it didn't come up
+static pid_t startSidecar (const std::string &program, const std::string &socketPath, const std::string &url)
+{
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        execl(program.c_str(), program.c_str(), socketPath.c_str(), url.c_str(), (char*)NULL);
+        _exit(127);
+    }
+
+    for (int i = 0; pid > 0 && i < 500; i++)
+    {
+        struct stat fileInfo;
+
+        if (stat(socketPath.c_str(), &fileInfo) == 0)
+        {
+            return pid;
+        }
+
+        if (waitpid(pid, NULL, WNOHANG) == pid)
+        {
+            return -1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (pid > 0)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+
+    return -1;
+}
+
+static const char* QUERIES[] = { "reportMatch", "teamDump", "teamNameQuery" };
+
+// Whether the metrics the plug-in last wrote show every match report sent and nothing left to send or waiting on
+// an answer
+static bool requestsSettled (const std::string &metricsPath, int matchesStarted)
+{
+    double pending, queued;
+    std::map<std::string, double> metrics = readMetrics(metricsPath, pending, queued);
+
+    if (metrics["leagueoverseer_url_jobs_total/reportMatch"] < matchesStarted || pending > 0 || queued > 0)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string type = std::string("/") + QUERIES[i];
+
+        if (metrics["leagueoverseer_url_jobs_total" + type] != metrics["leagueoverseer_url_jobs_completed_total" + type] +
+            metrics["leagueoverseer_url_job_timeouts_total" + type] + metrics["leagueoverseer_url_job_errors_total" + type])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main (int argc, char *argv[])
+{
+    LoadTestOptions options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    MockLeague league;
+
+    if (!league.start(options.league))
+    {
+        perror("The mock league could not be started");
+        return 1;
+    }
+
+    char directory[] = "/tmp/leagueOverSeer-loadTest-XXXXXX";
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    std::string config = std::string(directory) + "/leagueOverSeer.cfg";
+    std::string metricsPath = std::string(directory) + "/metrics.prom";
+    std::string sidecarSocket = std::string(directory) + "/sidecar.sock";
+    pid_t sidecar = -1;
+
+    if (options.transport == "sidecar")
+    {
+        sidecar = startSidecar(options.sidecar, sidecarSocket, league.url());
+
+        if (sidecar < 0)
+        {
+            fprintf(stderr, "The sidecar %s could not be started.\n", options.sidecar.c_str());
+            return 1;
+        }
+    }
+
+    std::ofstream configFile(config.c_str());
+
+    configFile << "[leagueOverSeer]\n"
+               << "  LEAGUE_OVERSEER_URL = " << league.url() << "\n"
+               << "  HTTP_TRANSPORT = " << options.transport << "\n"
+               << "  DEBUG_LEVEL = 1\n"
+               << "  METRICS_PATH = " << metricsPath << "\n"
+               << "  METRICS_INTERVAL = 1\n"
+               << "  MOTTO_REQUEST_RATE = " << options.mottoRate << "\n"
+               << "  MOTTO_CACHE_TTL = " << options.mottoCacheTTL << "\n"
+               << "  MOTTO_CACHE_NEGATIVE_TTL = " << options.mottoCacheTTL << "\n";
+
+    if (sidecar > 0)
+    {
+        configFile << "  SIDECAR_SOCKET = " << sidecarSocket << "\n";
+    }
+
+    configFile.close();
+
+    double requestTimeout = options.timeout;
+
+    mockBzfs::setDebugLevel(options.verbose);
+    mockBzfs::setURLJobRunner([requestTimeout](const mockBzfs::URLJob &job) { return postToLeague(job, requestTimeout); });
+
+    if (!mockBzfs::loadPlugin(config))
+    {
+        fprintf(stderr, "The plugin could not be loaded.\n");
+
+        if (sidecar > 0)
+        {
+            kill(sidecar, SIGTERM);
+        }
+
+        return 1;
+    }
+
+    bz_setTimeLimit((float)options.matchLength);
+
+    // Player i has BZID i + 1; a quarter of them don't belong to any team in the league
+    int bzIDRange = std::max(options.players, options.league.teams * options.league.teamSize * 4 / 3);
+    std::vector<int> slots(options.players, -1);
+    unsigned randomState = options.league.seed;
+    int matchesStarted = 0, joins = 0;
+    bool matchWasInProgress = false;
+
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+    // Run the server until the last match is over, then until the plug-in has heard back about every request. Should
+    // a request never be resolved, we give up on it long after any timeout would have gone off
+    std::chrono::steady_clock::time_point drainStarted = std::chrono::steady_clock::time_point::max();
+    const std::chrono::seconds DRAIN_LIMIT(120);
+    bool draining = false;
+    int step = 0;
+
+    while (!draining || std::chrono::steady_clock::now() - drainStarted < DRAIN_LIMIT)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        mockBzfs::advanceTime(0.01 * options.speed);
+        step++;
+
+        // Every so often a player comes or goes, and players on the field die and spawn
+        int player = rand_r(&randomState) % options.players;
+
+        if (rand_r(&randomState) % 4 == 0 && !draining)
+        {
+            if (slots[player] < 0)
+            {
+                std::string callsign = "player" + std::to_string(player);
+                std::string bzID = std::to_string(rand_r(&randomState) % bzIDRange + 1);
+                bz_eTeamType team = (bz_getTeamCount(eRedTeam) <= bz_getTeamCount(eBlueTeam)) ? eRedTeam : eBlueTeam;
+
+                slots[player] = mockBzfs::joinPlayer(callsign.c_str(), bzID.c_str(), (rand_r(&randomState) % 10 == 0) ? eObservers : team);
+                joins++;
+            }
+            else if (bz_getTeamCount(eRedTeam) > 2 && bz_getTeamCount(eBlueTeam) > 2)
+            {
+                mockBzfs::partPlayer(slots[player]);
+                slots[player] = -1;
+            }
+        }
+        else if (slots[player] >= 0)
+        {
+            mockBzfs::spawnPlayer(slots[player]);
+            mockBzfs::killPlayer(slots[player], -1);
+        }
+
+        bool matchInProgress = mockBzfs::isMatchInProgress();
+
+        if (!matchInProgress && matchesStarted < options.matches)
+        {
+            for (int i = 0; i < options.players; i++)
+            {
+                if (slots[i] >= 0 && bz_getPlayerTeam(slots[i]) != eObservers && bz_getTeamCount(eRedTeam) > 0 && bz_getTeamCount(eBlueTeam) > 0)
+                {
+                    mockBzfs::runCommand(slots[i], "/fm 10");
+                    matchesStarted += (mockBzfs::isMatchInProgress()) ? 1 : 0;
+                    break;
+                }
+            }
+        }
+        else if (!matchInProgress && matchWasInProgress && matchesStarted >= options.matches)
+        {
+            draining = true;
+            drainStarted = std::chrono::steady_clock::now();
+        }
+
+        matchWasInProgress = matchInProgress;
+
+        mockBzfs::tick();
+
+        // Nothing left to wait for. The metrics are rewritten every second of game time
+        if (draining && step % 25 == 0 && mockBzfs::pendingURLJobs() == 0 && requestsSettled(metricsPath, matchesStarted))
+        {
+            break;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    for (int i = 0; i < options.players; i++)
+    {
+        if (slots[i] >= 0)
+        {
+            mockBzfs::partPlayer(slots[i]);
+        }
+    }
+
+    // Unloading the plug-in writes its metrics one last time
+    mockBzfs::unloadPlugin();
+    league.stop();
+
+    if (sidecar > 0)
+    {
+        kill(sidecar, SIGTERM);
+        waitpid(sidecar, NULL, 0);
+    }
+
+    double pending, queued;
+    std::map<std::string, double> metrics = readMetrics(metricsPath, pending, queued);
+    bool failed = false;
+    double answered = 0, unanswered = 0;
+
+    printf("%d matches played in %.1f seconds with %d joins, %s sending the requests\n\n", matchesStarted, elapsed, joins, options.transport.c_str());
+    printf("%-14s %8s %8s %8s %8s %8s %12s %8s %8s %8s\n", "Request", "Sent", "Answered", "Timeouts", "Errors", "Shed",
+           "Latency (s)", "Received", "Failed", "Stalled");
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string type = std::string("/") + QUERIES[i];
+        double sent     = metrics["leagueoverseer_url_jobs_total" + type];
+        double done     = metrics["leagueoverseer_url_jobs_completed_total" + type];
+        double timeouts = metrics["leagueoverseer_url_job_timeouts_total" + type];
+        double errors   = metrics["leagueoverseer_url_job_errors_total" + type];
+        double shed     = metrics["leagueoverseer_url_jobs_shed_total" + type];
+        double count    = metrics["leagueoverseer_url_job_duration_seconds_count" + type];
+        double sum      = metrics["leagueoverseer_url_job_duration_seconds_sum" + type];
+
+        printf("%-14s %8.0f %8.0f %8.0f %8.0f %8.0f %12.3f %8zu %8zu %8zu\n", QUERIES[i], sent, done, timeouts, errors, shed,
+               (count > 0) ? sum / count : 0.0, league.received((MockLeague::Query)i), league.failed((MockLeague::Query)i),
+               league.stalled((MockLeague::Query)i));
+
+        answered   += done;
+        unanswered += sent - done - timeouts - errors;
+    }
+
+    // Every request the plug-in sent has to have been answered, timed out or failed by now, unless it was still
+    // waiting on an answer when the plug-in was unloaded
+    if (unanswered != pending)
+    {
+        fprintf(stderr, "%.0f request(s) were never accounted for.\n", unanswered - pending);
+        failed = true;
+    }
+
+    printf("\n%.1f requests answered per second, %.0f still waiting when the plug-in was unloaded, %zu bytes received from the league\n",
+           answered / elapsed, pending, league.bytesSent());
+
+    // Every match that was played has to have been reported, one way or another
+    if (metrics["leagueoverseer_url_jobs_total/reportMatch"] < matchesStarted)
+    {
+        fprintf(stderr, "Only %.0f of %d matches were reported.\n", metrics["leagueoverseer_url_jobs_total/reportMatch"], matchesStarted);
+        failed = true;
+    }
+
+    std::string cleanup = std::string("rm -rf ") + directory;
+
+    if (system(cleanup.c_str()) != 0)
+    {
+        fprintf(stderr, "%s could not be removed.\n", directory);
+    }
+
+    return (failed) ? 1 : 0;
+}
@@ -0,0 +1,416 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// A stand-in for bzfs' bzfsAPI.h that only declares the parts of the plugin API League Overseer uses. The
+// plugin is compiled against this header by the test programs so it can be loaded and driven without bzfs;
+// everything declared here is implemented by mockBzfs.cpp.
+
+#ifndef _MOCK_BZFS_API_H_
+#define _MOCK_BZFS_API_H_
+
+#include <string>
+#include <vector>
+
+#define BZF_API
+
+#define BZ_SERVER   -2
+#define BZ_ALLUSERS -1
+
+typedef enum
+{
+    eNoTeam = -1,
+    eRogueTeam = 0,
+    eRedTeam,
+    eGreenTeam,
+    eBlueTeam,
+    ePurpleTeam,
+    eRabbitTeam,
+    eHunterTeam,
+    eObservers,
+    eAdministrators
+} bz_eTeamType;
+
+typedef enum
+{
+    bz_eNullEvent = 0,
+    bz_eCaptureEvent,
+    bz_ePlayerDieEvent,
+    bz_ePlayerSpawnEvent,
+    bz_eZoneEntryEvent,
+    bz_eZoneExitEvent,
+    bz_ePlayerJoinEvent,
+    bz_ePlayerPartEvent,
+    bz_eRawChatMessageEvent,
+    bz_eFilteredChatMessageEvent,
+    bz_eUnknownSlashCommand,
+    bz_eGetPlayerSpawnPosEvent,
+    bz_eGetAutoTeamEvent,
+    bz_eAllowPlayer,
+    bz_eTickEvent,
+    bz_eGetWorldEvent,
+    bz_eGetPlayerInfoEvent,
+    bz_eAllowSpawn,
+    bz_eListServerUpdateEvent,
+    bz_eBanEvent,
+    bz_eHostBanModifyEvent,
+    bz_eKickEvent,
+    bz_eKillEvent,
+    bz_ePlayerPausedEvent,
+    bz_eMessageFilteredEvent,
+    bz_eGamePauseEvent,
+    bz_eGameResumeEvent,
+    bz_ePlayerAuthEvent,
+    bz_eReportFiledEvent,
+    bz_eGameStartEvent,
+    bz_eGameEndEvent,
+    bz_eSlashCommandEvent,
+    bz_eTeamScoreChanged,
+    bz_eFlagGrabbedEvent,
+    bz_eFlagDroppedEvent,
+    bz_eBZDBChange,
+    bz_eGetPlayerMotto,
+    bz_eLastEvent
+} bz_eEventType;
+
+typedef enum
+{
+    bz_eWins,
+    bz_eLosses,
+    bz_eTKs
+} bz_eTeamScoreElement;
+
+class bz_ApiString
+{
+public:
+    bz_ApiString () {}
+    bz_ApiString (const char* c) : str(c ? c : "") {}
+    bz_ApiString (const std::string &s) : str(s) {}
+
+    bz_ApiString& operator = (const char* c) { str = (c ? c : ""); return *this; }
+    bz_ApiString& operator = (const std::string &s) { str = s; return *this; }
+
+    bool operator == (const char* c) const { return str == (c ? c : ""); }
+    bool operator == (const std::string &s) const { return str == s; }
+    bool operator == (const bz_ApiString &s) const { return str == s.str; }
+    bool operator != (const char* c) const { return !(*this == c); }
+    bool operator != (const std::string &s) const { return str != s; }
+    bool operator != (const bz_ApiString &s) const { return str != s.str; }
+
+    operator std::string () const { return str; }
+
+    const char*  c_str () const { return str.c_str(); }
+    unsigned int size () const { return (unsigned int)str.size(); }
+    bool         empty () const { return str.empty(); }
+
+    void format (const char* fmt, ...);
+    void replaceAll (const char* target, const char* with);
+    void tolower ();
+    void toupper ();
+
+private:
+    std::string str;
+};
+
+class bz_APIIntList
+{
+public:
+    unsigned int size () const { return (unsigned int)list.size(); }
+    int get (unsigned int i) const { return list[i]; }
+    void push_back (int value) { list.push_back(value); }
+
+private:
+    std::vector<int> list;
+};
+
+class bz_APIStringList
+{
+public:
+    unsigned int size () const { return (unsigned int)list.size(); }
+    const bz_ApiString& get (unsigned int i) const { return list[i]; }
+    void push_back (const bz_ApiString &value) { list.push_back(value); }
+
+private:
+    std::vector<bz_ApiString> list;
+};
+
+typedef struct
+{
+    int  year, month, day, hour, minute, second, dayofweek;
+    bool daylightSavings;
+} bz_Time;
+
+typedef struct
+{
+    int   status;
+    bool  falling, crossingWall, inPhantomZone;
+    float pos[3];
+    float velocity[3];
+    float rotation;
+    float angVel;
+    int   phydrv;
+} bz_PlayerUpdateState;
+
+class bz_BasePlayerRecord
+{
+public:
+    bz_BasePlayerRecord () :
+        version(1), playerID(-1), team(eNoTeam), lastKnownState(), spawned(false), verified(false),
+        globalUser(false), admin(false), op(false), wins(0), losses(0), teamKills(0)
+    {}
+
+    int                  version;
+    int                  playerID;
+    bz_ApiString         callsign;
+    bz_eTeamType         team;
+    bz_PlayerUpdateState lastKnownState;
+    bz_ApiString         ipAddress;
+    bz_ApiString         currentFlag;
+    bool                 spawned, verified, globalUser, admin, op;
+    bz_ApiString         bzID;
+    int                  wins, losses, teamKills;
+};
+
+class bz_EventData
+{
+public:
+    bz_EventData (bz_eEventType type = bz_eNullEvent) : eventType(type), eventTime(0) {}
+    virtual ~bz_EventData () {}
+
+    bz_eEventType eventType;
+    double        eventTime;
+};
+
+class bz_PlayerJoinPartEventData_V1 : public bz_EventData
+{
+public:
+    bz_PlayerJoinPartEventData_V1 () : playerID(-1), record(NULL) {}
+
+    int                  playerID;
+    bz_BasePlayerRecord* record;
+    bz_ApiString         reason;
+};
+
+class bz_PlayerDieEventData_V1 : public bz_EventData
+{
+public:
+    bz_PlayerDieEventData_V1 () : bz_EventData(bz_ePlayerDieEvent), playerID(-1), team(eNoTeam), killerID(-1), killerTeam(eNoTeam), shotID(-1), state() {}
+
+    int                  playerID;
+    bz_eTeamType         team;
+    int                  killerID;
+    bz_eTeamType         killerTeam;
+    bz_ApiString         flagKilledWith;
+    int                  shotID;
+    bz_PlayerUpdateState state;
+};
+
+class bz_PlayerSpawnEventData_V1 : public bz_EventData
+{
+public:
+    bz_PlayerSpawnEventData_V1 () : bz_EventData(bz_ePlayerSpawnEvent), playerID(-1), team(eNoTeam), state() {}
+
+    int                  playerID;
+    bz_eTeamType         team;
+    bz_PlayerUpdateState state;
+};
+
+class bz_TeamScoreChangeEventData_V1 : public bz_EventData
+{
+public:
+    bz_TeamScoreChangeEventData_V1 () : bz_EventData(bz_eTeamScoreChanged), team(eNoTeam), element(bz_eWins), lastValue(0), thisValue(0) {}
+
+    bz_eTeamType         team;
+    bz_eTeamScoreElement element;
+    int                  lastValue, thisValue;
+};
+
+class bz_GetAutoTeamEventData_V1 : public bz_EventData
+{
+public:
+    bz_GetAutoTeamEventData_V1 () : bz_EventData(bz_eGetAutoTeamEvent), playerID(-1), team(eNoTeam), handled(false) {}
+
+    int          playerID;
+    bz_ApiString callsign;
+    bz_eTeamType team;
+    bool         handled;
+};
+
+class bz_GetPlayerMottoData_V2 : public bz_EventData
+{
+public:
+    bz_GetPlayerMottoData_V2 () : bz_EventData(bz_eGetPlayerMotto), record(NULL) {}
+
+    bz_ApiString         motto;
+    bz_BasePlayerRecord* record;
+};
+
+class bz_BZDBChangeData_V1 : public bz_EventData
+{
+public:
+    bz_BZDBChangeData_V1 () : bz_EventData(bz_eBZDBChange) {}
+
+    bz_ApiString key, value;
+};
+
+class bz_FlagGrabbedEventData_V1 : public bz_EventData
+{
+public:
+    bz_FlagGrabbedEventData_V1 () : bz_EventData(bz_eFlagGrabbedEvent), playerID(-1), flagID(-1), flagType(NULL) {}
+
+    int         playerID;
+    int         flagID;
+    const char* flagType;
+    float       pos[3];
+};
+
+class bz_FlagDroppedEventData_V1 : public bz_EventData
+{
+public:
+    bz_FlagDroppedEventData_V1 () : bz_EventData(bz_eFlagDroppedEvent), playerID(-1), flagID(-1), flagType(NULL) {}
+
+    int         playerID;
+    int         flagID;
+    const char* flagType;
+    float       pos[3];
+};
+
+class bz_CTFCaptureEventData_V1 : public bz_EventData
+{
+public:
+    bz_CTFCaptureEventData_V1 () : bz_EventData(bz_eCaptureEvent), teamCapped(eNoTeam), teamCapping(eNoTeam), playerCapping(-1), rot(0) {}
+
+    bz_eTeamType teamCapped;
+    bz_eTeamType teamCapping;
+    int          playerCapping;
+    float        pos[3];
+    float        rot;
+};
+
+class bz_GameStartEndEventData_V2 : public bz_EventData
+{
+public:
+    bz_GameStartEndEventData_V2 (bz_eEventType type) : bz_EventData(type), duration(0), playerID(-1), gameOver(0) {}
+
+    double duration;
+    int    playerID;
+    int    gameOver;
+};
+
+class bz_Plugin
+{
+public:
+    bz_Plugin ();
+    virtual ~bz_Plugin () {}
+
+    virtual const char* Name () = 0;
+    virtual void Init (const char* config) = 0;
+    virtual void Cleanup () {}
+    virtual void Event (bz_EventData* eventData) = 0;
+
+    bool Register (bz_eEventType eventType);
+    bool Remove (bz_eEventType eventType);
+    void Flush ();
+
+    float MaxWaitTime;
+    bool  Unloadable;
+
+    bool registered[bz_eLastEvent];
+};
+
+class bz_CustomSlashCommandHandler
+{
+public:
+    virtual ~bz_CustomSlashCommandHandler () {}
+    virtual bool SlashCommand (int playerID, bz_ApiString command, bz_ApiString message, bz_APIStringList* params) = 0;
+};
+
+class bz_BaseURLHandler
+{
+public:
+    bz_BaseURLHandler () : version(1) {}
+    virtual ~bz_BaseURLHandler () {}
+
+    virtual void URLDone (const char* URL, const void* data, unsigned int size, bool complete) = 0;
+    virtual void URLTimeout (const char* /*URL*/, int /*errorCode*/) {}
+    virtual void URLError (const char* /*URL*/, int /*errorCode*/, const char* /*errorString*/) {}
+
+    int version;
+};
+
+#define BZ_PLUGIN(n) bz_Plugin* bz_GetPlugin (void) { return new n; }
+
+bz_Plugin* bz_GetPlugin (void);
+
+BZF_API void bz_debugMessage (int level, const char* message);
+BZF_API void bz_debugMessagef (int level, const char* fmt, ...);
+BZF_API int  bz_getDebugLevel ();
+
+BZF_API bool bz_sendTextMessage (int from, int to, const char* message);
+BZF_API bool bz_sendTextMessagef (int from, int to, const char* fmt, ...);
+BZF_API bool bz_sendTextMessage (int from, bz_eTeamType to, const char* message);
+BZF_API bool bz_sendTextMessagef (int from, bz_eTeamType to, const char* fmt, ...);
+
+BZF_API bz_BasePlayerRecord* bz_getPlayerByIndex (int playerID);
+BZF_API bz_BasePlayerRecord* bz_getPlayerBySlotOrCallsign (const char* name);
+BZF_API bz_APIIntList*       bz_getPlayerIndexList ();
+BZF_API bz_eTeamType         bz_getPlayerTeam (int playerID);
+BZF_API int                  bz_getPlayerCount ();
+BZF_API bool                 bz_setPlayerSpawnAtBase (int playerID, bool spawnAtBase);
+
+BZF_API bool bz_hasPerm (int playerID, const char* perm);
+BZF_API bool bz_grantPerm (int playerID, const char* perm);
+
+BZF_API bool bz_registerCustomSlashCommand (const char* command, bz_CustomSlashCommandHandler* handler);
+BZF_API bool bz_removeCustomSlashCommand (const char* command);
+
+BZF_API bool        bz_addURLJob (const char* URL, bz_BaseURLHandler* handler = NULL, const char* postData = NULL);
+BZF_API bool        bz_removeURLJob (const char* URL);
+BZF_API const char* bz_urlEncode (const char* string);
+
+BZF_API double bz_getCurrentTime ();
+BZF_API void   bz_getUTCtime (bz_Time* ts);
+BZF_API void   bz_getLocaltime (bz_Time* ts);
+
+BZF_API double       bz_getBZDBDouble (const char* variable);
+BZF_API int          bz_getBZDBInt (const char* variable);
+BZF_API bz_ApiString bz_getBZDBString (const char* variable);
+
+BZF_API bool bz_startRecBuf ();
+BZF_API bool bz_stopRecBuf ();
+BZF_API bool bz_saveRecBuf (const char* filename, int seconds);
+
+BZF_API int bz_getTeamCount (bz_eTeamType team);
+BZF_API int bz_getTeamPlayerLimit (bz_eTeamType team);
+
+BZF_API bool   bz_isCountDownActive ();
+BZF_API bool   bz_isCountDownInProgress ();
+BZF_API bool   bz_isCountDownPaused ();
+BZF_API void   bz_startCountdown (int delay, float limit, const char* byWho);
+BZF_API void   bz_pauseCountdown (const char* pausedBy);
+BZF_API void   bz_resumeCountdown (const char* resumedBy);
+BZF_API void   bz_cancelCountdown (int playerID);
+BZF_API void   bz_gameOver (int playerID, bz_eTeamType team = eNoTeam);
+BZF_API double bz_getTimeLimit ();
+BZF_API bool   bz_setTimeLimit (float timeLimit);
+
+BZF_API bz_ApiString bz_getPublicAddr ();
+BZF_API int          bz_getPublicPort ();
+BZF_API void         bz_shutdown ();
+
+#endif
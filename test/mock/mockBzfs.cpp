@@ -0,0 +1,1168 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <strings.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "bzfsAPI.h"
+#include "plugin_utils.h"
+#include "mockBzfs.h"
+
+// Everything the mock knows about the game lives in here. Nothing on the paths the plugin's event handlers call
+// allocates memory, so a test can count the plugin's allocations without counting ours
+
+namespace
+{
+    const int MAX_SLOTS = 256;
+
+    struct Player
+    {
+        Player () :
+            inUse(false),
+            referee(false)
+        {}
+
+        bool                inUse;
+        bool                referee;
+        bz_BasePlayerRecord record;
+    };
+
+    struct QueuedURLJob
+    {
+        QueuedURLJob () :
+            handler(NULL),
+            canceled(false)
+        {}
+
+        mockBzfs::URLJob    job;
+        bz_BaseURLHandler  *handler;
+        bool                canceled;
+        mockBzfs::URLResult result;
+    };
+
+    enum CountdownState
+    {
+        eIdle,
+        eCountingDown,
+        eActive
+    };
+
+    bz_Plugin *plugin = NULL;
+
+    int    debugLevel = 0;
+    double clockTime  = 1000.0;
+    size_t textMessages = 0;
+
+    Player players[MAX_SLOTS];
+    int    teamLimits[eAdministrators + 1];
+
+    std::map<std::string, bz_CustomSlashCommandHandler*> slashCommands;
+
+    CountdownState countdown = eIdle;
+    bool           countdownPaused = false;
+    double         countdownStart = 0, matchEnd = 0, pausedAt = 0;
+    float          timeLimit = 0;
+    bool           gameEndPending = false, gameResumePending = false;
+
+    // URL jobs go from 'waiting' to the runner thread and from there to 'done', where tick() picks them up
+    mockBzfs::URLJobRunner                      urlJobRunner;
+    std::thread                                 runnerThread;
+    std::mutex                                  urlJobLock;
+    std::condition_variable                     urlJobReady;
+    std::vector<std::shared_ptr<QueuedURLJob>>  waitingURLJobs, doneURLJobs, deliveringURLJobs;
+    std::shared_ptr<QueuedURLJob>               runningURLJob;
+    size_t                                      urlJobsFinished = 0;
+    bool                                        stopRunner = false;
+
+    struct BZDBVariable
+    {
+        const char* name;
+        double      value;
+    };
+
+    const BZDBVariable BZDB_VARIABLES[] =
+    {
+        { "_explodeTime", 5.0 },
+        { "_worldSize", 800.0 }
+    };
+
+    void fire (bz_EventData &eventData)
+    {
+        eventData.eventTime = clockTime;
+
+        if (plugin && plugin->registered[eventData.eventType])
+        {
+            plugin->Event(&eventData);
+        }
+    }
+
+    Player* findPlayer (int playerID)
+    {
+        return (playerID >= 0 && playerID < MAX_SLOTS && players[playerID].inUse) ? &players[playerID] : NULL;
+    }
+
+    void runURLJobs ()
+    {
+        std::unique_lock<std::mutex> lock(urlJobLock);
+
+        while (true)
+        {
+            urlJobReady.wait(lock, []() { return stopRunner || !waitingURLJobs.empty(); });
+
+            if (stopRunner)
+            {
+                return;
+            }
+
+            runningURLJob = waitingURLJobs.front();
+            waitingURLJobs.erase(waitingURLJobs.begin());
+
+            mockBzfs::URLJob job = runningURLJob->job;
+            mockBzfs::URLJobRunner runner = urlJobRunner;
+
+            lock.unlock();
+            mockBzfs::URLResult result = runner(job);
+            lock.lock();
+
+            runningURLJob->result = result;
+            doneURLJobs.push_back(runningURLJob);
+            runningURLJob.reset();
+        }
+    }
+
+    void stopURLJobRunner ()
+    {
+        {
+            std::lock_guard<std::mutex> lock(urlJobLock);
+            stopRunner = true;
+        }
+
+        urlJobReady.notify_all();
+
+        if (runnerThread.joinable())
+        {
+            runnerThread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(urlJobLock);
+        stopRunner = false;
+        waitingURLJobs.clear();
+        doneURLJobs.clear();
+    }
+
+    void deliverURLJobs ()
+    {
+        {
+            std::lock_guard<std::mutex> lock(urlJobLock);
+
+            if (doneURLJobs.empty())
+            {
+                return;
+            }
+
+            deliveringURLJobs.swap(doneURLJobs);
+        }
+
+        for (size_t i = 0; i < deliveringURLJobs.size(); i++)
+        {
+            QueuedURLJob &queued = *deliveringURLJobs[i];
+
+            urlJobsFinished++;
+
+            if (queued.canceled || !queued.handler)
+            {
+                continue;
+            }
+
+            switch (queued.result.status)
+            {
+                case mockBzfs::URLResult::eDone:
+                    queued.handler->URLDone(queued.job.url.c_str(), queued.result.body.c_str(), (unsigned int)queued.result.body.size(), true);
+                    break;
+
+                case mockBzfs::URLResult::eError:
+                    queued.handler->URLError(queued.job.url.c_str(), queued.result.errorCode, queued.result.error.c_str());
+                    break;
+
+                case mockBzfs::URLResult::eTimeout:
+                    queued.handler->URLTimeout(queued.job.url.c_str(), queued.result.errorCode);
+                    break;
+            }
+        }
+
+        deliveringURLJobs.clear();
+    }
+
+    void endGame ()
+    {
+        countdown = eIdle;
+        countdownPaused = false;
+        gameEndPending = true;
+    }
+
+    void fillTime (bz_Time* ts, const struct tm &t)
+    {
+        ts->year            = t.tm_year + 1900;
+        ts->month           = t.tm_mon + 1;
+        ts->day             = t.tm_mday;
+        ts->hour            = t.tm_hour;
+        ts->minute          = t.tm_min;
+        ts->second          = t.tm_sec;
+        ts->dayofweek       = t.tm_wday;
+        ts->daylightSavings = (t.tm_isdst > 0);
+    }
+
+    std::string lowercase (std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+        return str;
+    }
+
+    std::string trimmed (const std::string &str)
+    {
+        size_t start = str.find_first_not_of(" \t\r\n");
+        size_t end   = str.find_last_not_of(" \t\r\n");
+
+        return (start == std::string::npos) ? "" : str.substr(start, end - start + 1);
+    }
+}
+
+//
+// The test program's side
+//
+
+namespace mockBzfs
+{
+    bool loadPlugin (const std::string &config, bz_eTeamType teamOne, bz_eTeamType teamTwo, int teamLimit)
+    {
+        if (plugin)
+        {
+            return false;
+        }
+
+        for (int i = 0; i <= eAdministrators; i++)
+        {
+            teamLimits[i] = (i == teamOne || i == teamTwo) ? teamLimit : 0;
+        }
+
+        teamLimits[eObservers] = 20;
+
+        plugin = bz_GetPlugin();
+        plugin->Init(config.c_str());
+
+        return true;
+    }
+
+    void unloadPlugin ()
+    {
+        if (!plugin)
+        {
+            return;
+        }
+
+        plugin->Cleanup();
+        stopURLJobRunner();
+
+        delete plugin;
+        plugin = NULL;
+    }
+
+    void setDebugLevel (int level)
+    {
+        debugLevel = level;
+    }
+
+    double now ()
+    {
+        return clockTime;
+    }
+
+    void advanceTime (double seconds)
+    {
+        clockTime += seconds;
+    }
+
+    void tick ()
+    {
+        if (countdown == eCountingDown && clockTime >= countdownStart)
+        {
+            countdown = eActive;
+            matchEnd = clockTime + timeLimit;
+
+            bz_GameStartEndEventData_V2 startData(bz_eGameStartEvent);
+            startData.duration = timeLimit;
+            fire(startData);
+        }
+        else if (countdown == eActive && !countdownPaused && clockTime >= matchEnd)
+        {
+            endGame();
+        }
+
+        if (gameResumePending)
+        {
+            gameResumePending = false;
+
+            bz_EventData resumeData(bz_eGameResumeEvent);
+            fire(resumeData);
+        }
+
+        if (gameEndPending)
+        {
+            gameEndPending = false;
+
+            bz_GameStartEndEventData_V2 endData(bz_eGameEndEvent);
+            endData.duration = timeLimit;
+            fire(endData);
+        }
+
+        deliverURLJobs();
+
+        bz_EventData tickData(bz_eTickEvent);
+        fire(tickData);
+    }
+
+    void setURLJobRunner (URLJobRunner runner)
+    {
+        stopURLJobRunner();
+
+        urlJobRunner = runner;
+
+        if (urlJobRunner)
+        {
+            runnerThread = std::thread(runURLJobs);
+        }
+    }
+
+    size_t pendingURLJobs ()
+    {
+        std::lock_guard<std::mutex> lock(urlJobLock);
+
+        return waitingURLJobs.size() + doneURLJobs.size() + (runningURLJob ? 1 : 0);
+    }
+
+    size_t finishedURLJobs ()
+    {
+        return urlJobsFinished;
+    }
+
+    int joinPlayer (const char* callsign, const char* bzID, bz_eTeamType team, bool referee)
+    {
+        int playerID = -1;
+
+        for (int i = 0; i < MAX_SLOTS && playerID < 0; i++)
+        {
+            if (!players[i].inUse)
+            {
+                playerID = i;
+            }
+        }
+
+        if (playerID < 0)
+        {
+            return -1;
+        }
+
+        Player &player = players[playerID];
+
+        player.inUse   = true;
+        player.referee = referee;
+        player.record  = bz_BasePlayerRecord();
+
+        player.record.playerID   = playerID;
+        player.record.callsign   = callsign;
+        player.record.bzID       = bzID;
+        player.record.team       = team;
+        player.record.ipAddress  = "127.0.0.1";
+        player.record.verified   = (bzID && bzID[0] != '\0');
+        player.record.globalUser = player.record.verified;
+        player.record.admin      = referee;
+
+        bz_GetPlayerMottoData_V2 mottoData;
+        mottoData.record = &player.record;
+        fire(mottoData);
+
+        bz_PlayerJoinPartEventData_V1 joinData;
+        joinData.eventType = bz_ePlayerJoinEvent;
+        joinData.playerID  = playerID;
+        joinData.record    = &player.record;
+        fire(joinData);
+
+        return playerID;
+    }
+
+    void partPlayer (int playerID)
+    {
+        Player *player = findPlayer(playerID);
+
+        if (!player)
+        {
+            return;
+        }
+
+        bz_PlayerJoinPartEventData_V1 partData;
+        partData.eventType = bz_ePlayerPartEvent;
+        partData.playerID  = playerID;
+        partData.record    = &player->record;
+        fire(partData);
+
+        player->inUse = false;
+    }
+
+    void changeTeam (int playerID, bz_eTeamType team)
+    {
+        Player *player = findPlayer(playerID);
+
+        if (player)
+        {
+            player->record.team = team;
+            player->record.spawned = false;
+        }
+    }
+
+    bz_eTeamType pickTeam (int playerID)
+    {
+        Player *player = findPlayer(playerID);
+
+        if (!player)
+        {
+            return eNoTeam;
+        }
+
+        bz_GetAutoTeamEventData_V1 autoTeamData;
+        autoTeamData.playerID = playerID;
+        autoTeamData.callsign = player->record.callsign;
+        autoTeamData.team     = eRogueTeam;
+        fire(autoTeamData);
+
+        return (autoTeamData.handled) ? autoTeamData.team : eNoTeam;
+    }
+
+    std::string playerMotto (const char* bzID)
+    {
+        bz_BasePlayerRecord record;
+        record.bzID       = bzID;
+        record.verified   = (bzID && bzID[0] != '\0');
+        record.globalUser = record.verified;
+
+        bz_GetPlayerMottoData_V2 mottoData;
+        mottoData.record = &record;
+        fire(mottoData);
+
+        return mottoData.motto;
+    }
+
+    void spawnPlayer (int playerID)
+    {
+        Player *player = findPlayer(playerID);
+
+        if (!player)
+        {
+            return;
+        }
+
+        player->record.spawned = true;
+
+        bz_PlayerSpawnEventData_V1 spawnData;
+        spawnData.playerID = playerID;
+        spawnData.team     = player->record.team;
+        spawnData.state.pos[0] = (float)(playerID * 10 % 400) - 200;
+        spawnData.state.pos[1] = (float)(playerID * 30 % 400) - 200;
+        fire(spawnData);
+    }
+
+    void killPlayer (int playerID, int killerID)
+    {
+        Player *player = findPlayer(playerID);
+        Player *killer = findPlayer(killerID);
+
+        if (!player)
+        {
+            return;
+        }
+
+        player->record.spawned = false;
+
+        bz_PlayerDieEventData_V1 dieData;
+        dieData.playerID   = playerID;
+        dieData.team       = player->record.team;
+        dieData.killerID   = killerID;
+        dieData.killerTeam = (killer) ? killer->record.team : eNoTeam;
+        dieData.state.pos[0] = (float)(playerID * 20 % 400) - 200;
+        dieData.state.pos[1] = (float)(killerID * 20 % 400) - 200;
+        fire(dieData);
+    }
+
+    void grabFlag (int playerID, const char* flagType)
+    {
+        bz_FlagGrabbedEventData_V1 grabData;
+        grabData.playerID = playerID;
+        grabData.flagType = flagType;
+        fire(grabData);
+    }
+
+    void dropFlag (int playerID, const char* flagType)
+    {
+        bz_FlagDroppedEventData_V1 dropData;
+        dropData.playerID = playerID;
+        dropData.flagType = flagType;
+        fire(dropData);
+    }
+
+    void captureFlag (int playerID, bz_eTeamType teamCapped)
+    {
+        Player *player = findPlayer(playerID);
+
+        if (!player)
+        {
+            return;
+        }
+
+        bz_CTFCaptureEventData_V1 captureData;
+        captureData.teamCapped    = teamCapped;
+        captureData.teamCapping   = player->record.team;
+        captureData.playerCapping = playerID;
+        fire(captureData);
+
+        bz_TeamScoreChangeEventData_V1 scoreData;
+        scoreData.team    = teamCapped;
+        scoreData.element = bz_eLosses;
+        fire(scoreData);
+    }
+
+    bool runCommand (int playerID, const char* commandLine)
+    {
+        std::string line = (commandLine[0] == '/') ? commandLine + 1 : commandLine;
+        size_t space = line.find(' ');
+        std::string command = lowercase(line.substr(0, space));
+        std::string message = (space == std::string::npos) ? "" : trimmed(line.substr(space + 1));
+
+        std::map<std::string, bz_CustomSlashCommandHandler*>::iterator it = slashCommands.find(command);
+
+        if (it == slashCommands.end())
+        {
+            return false;
+        }
+
+        bz_APIStringList params;
+        std::vector<std::string> tokens = tokenize(message, " ", 0, true);
+
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            params.push_back(tokens[i]);
+        }
+
+        return it->second->SlashCommand(playerID, command, message, &params);
+    }
+
+    bool isMatchInProgress ()
+    {
+        return countdown != eIdle;
+    }
+
+    size_t messagesSent ()
+    {
+        return textMessages;
+    }
+}
+
+//
+// The plugin's side
+//
+
+void bz_ApiString::format (const char* fmt, ...)
+{
+    va_list args, argsCopy;
+
+    va_start(args, fmt);
+    va_copy(argsCopy, args);
+
+    int length = vsnprintf(NULL, 0, fmt, args);
+    std::vector<char> buffer((length > 0) ? length + 1 : 1, '\0');
+
+    vsnprintf(&buffer[0], buffer.size(), fmt, argsCopy);
+
+    va_end(argsCopy);
+    va_end(args);
+
+    str = &buffer[0];
+}
+
+void bz_ApiString::replaceAll (const char* target, const char* with)
+{
+    size_t targetLength = strlen(target), withLength = strlen(with);
+
+    if (targetLength == 0)
+    {
+        return;
+    }
+
+    for (size_t pos = str.find(target); pos != std::string::npos; pos = str.find(target, pos + withLength))
+    {
+        str.replace(pos, targetLength, with);
+    }
+}
+
+void bz_ApiString::tolower ()
+{
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+}
+
+void bz_ApiString::toupper ()
+{
+    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+}
+
+bz_Plugin::bz_Plugin () :
+    MaxWaitTime(-1),
+    Unloadable(true)
+{
+    Flush();
+}
+
+bool bz_Plugin::Register (bz_eEventType eventType)
+{
+    if (eventType <= bz_eNullEvent || eventType >= bz_eLastEvent)
+    {
+        return false;
+    }
+
+    registered[eventType] = true;
+    return true;
+}
+
+bool bz_Plugin::Remove (bz_eEventType eventType)
+{
+    if (eventType <= bz_eNullEvent || eventType >= bz_eLastEvent || !registered[eventType])
+    {
+        return false;
+    }
+
+    registered[eventType] = false;
+    return true;
+}
+
+void bz_Plugin::Flush ()
+{
+    std::fill(registered, registered + bz_eLastEvent, false);
+}
+
+BZF_API void bz_debugMessage (int level, const char* message)
+{
+    if (level <= debugLevel)
+    {
+        printf("%s\n", message);
+    }
+}
+
+BZF_API void bz_debugMessagef (int level, const char* fmt, ...)
+{
+    if (level > debugLevel)
+    {
+        return;
+    }
+
+    char message[2048];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    bz_debugMessage(level, message);
+}
+
+BZF_API int bz_getDebugLevel ()
+{
+    return debugLevel;
+}
+
+BZF_API bool bz_sendTextMessage (int /*from*/, int /*to*/, const char* /*message*/)
+{
+    textMessages++;
+    return true;
+}
+
+BZF_API bool bz_sendTextMessagef (int from, int to, const char* fmt, ...)
+{
+    char message[2048];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    return bz_sendTextMessage(from, to, message);
+}
+
+BZF_API bool bz_sendTextMessage (int from, bz_eTeamType /*to*/, const char* message)
+{
+    return bz_sendTextMessage(from, BZ_ALLUSERS, message);
+}
+
+BZF_API bool bz_sendTextMessagef (int from, bz_eTeamType /*to*/, const char* fmt, ...)
+{
+    char message[2048];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    return bz_sendTextMessage(from, BZ_ALLUSERS, message);
+}
+
+BZF_API bz_BasePlayerRecord* bz_getPlayerByIndex (int playerID)
+{
+    Player *player = findPlayer(playerID);
+
+    return (player) ? new bz_BasePlayerRecord(player->record) : NULL;
+}
+
+BZF_API bz_BasePlayerRecord* bz_getPlayerBySlotOrCallsign (const char* name)
+{
+    if (name[0] == '#')
+    {
+        return bz_getPlayerByIndex(atoi(name + 1));
+    }
+
+    for (int i = 0; i < MAX_SLOTS; i++)
+    {
+        if (players[i].inUse && strcasecmp(players[i].record.callsign.c_str(), name) == 0)
+        {
+            return bz_getPlayerByIndex(i);
+        }
+    }
+
+    return NULL;
+}
+
+BZF_API bz_APIIntList* bz_getPlayerIndexList ()
+{
+    bz_APIIntList *list = new bz_APIIntList();
+
+    for (int i = 0; i < MAX_SLOTS; i++)
+    {
+        if (players[i].inUse)
+        {
+            list->push_back(i);
+        }
+    }
+
+    return list;
+}
+
+BZF_API bz_eTeamType bz_getPlayerTeam (int playerID)
+{
+    Player *player = findPlayer(playerID);
+
+    return (player) ? player->record.team : eNoTeam;
+}
+
+BZF_API int bz_getPlayerCount ()
+{
+    int count = 0;
+
+    for (int i = 0; i < MAX_SLOTS; i++)
+    {
+        count += (players[i].inUse) ? 1 : 0;
+    }
+
+    return count;
+}
+
+BZF_API bool bz_setPlayerSpawnAtBase (int playerID, bool /*spawnAtBase*/)
+{
+    return findPlayer(playerID) != NULL;
+}
+
+BZF_API bool bz_hasPerm (int playerID, const char* perm)
+{
+    Player *player = findPlayer(playerID);
+
+    if (!player)
+    {
+        return false;
+    }
+
+    return player->referee || (player->record.verified && strcasecmp(perm, "spawn") == 0);
+}
+
+BZF_API bool bz_grantPerm (int playerID, const char* /*perm*/)
+{
+    return findPlayer(playerID) != NULL;
+}
+
+BZF_API bool bz_registerCustomSlashCommand (const char* command, bz_CustomSlashCommandHandler* handler)
+{
+    slashCommands[lowercase(command)] = handler;
+    return true;
+}
+
+BZF_API bool bz_removeCustomSlashCommand (const char* command)
+{
+    return slashCommands.erase(lowercase(command)) > 0;
+}
+
+BZF_API bool bz_addURLJob (const char* URL, bz_BaseURLHandler* handler, const char* postData)
+{
+    std::shared_ptr<QueuedURLJob> queued = std::make_shared<QueuedURLJob>();
+
+    queued->job.url      = URL;
+    queued->job.postData = (postData) ? postData : "";
+    queued->handler      = handler;
+
+    std::lock_guard<std::mutex> lock(urlJobLock);
+
+    if (urlJobRunner)
+    {
+        waitingURLJobs.push_back(queued);
+        urlJobReady.notify_one();
+    }
+    else
+    {
+        doneURLJobs.push_back(queued);
+    }
+
+    return true;
+}
+
+BZF_API bool bz_removeURLJob (const char* URL)
+{
+    std::lock_guard<std::mutex> lock(urlJobLock);
+    bool removed = false;
+
+    for (size_t i = 0; i < waitingURLJobs.size(); i++)
+    {
+        if (waitingURLJobs[i]->job.url == URL)
+        {
+            waitingURLJobs[i]->canceled = removed = true;
+        }
+    }
+
+    for (size_t i = 0; i < doneURLJobs.size(); i++)
+    {
+        if (doneURLJobs[i]->job.url == URL)
+        {
+            doneURLJobs[i]->canceled = removed = true;
+        }
+    }
+
+    if (runningURLJob && runningURLJob->job.url == URL)
+    {
+        runningURLJob->canceled = removed = true;
+    }
+
+    return removed;
+}
+
+BZF_API const char* bz_urlEncode (const char* string)
+{
+    static std::string encoded;
+    static const char* HEX = "0123456789ABCDEF";
+
+    encoded.clear();
+
+    for (const unsigned char* c = (const unsigned char*)string; *c; c++)
+    {
+        if (isalnum(*c) || *c == '-' || *c == '_' || *c == '.' || *c == '~')
+        {
+            encoded += (char)*c;
+        }
+        else
+        {
+            encoded += '%';
+            encoded += HEX[*c >> 4];
+            encoded += HEX[*c & 15];
+        }
+    }
+
+    return encoded.c_str();
+}
+
+BZF_API double bz_getCurrentTime ()
+{
+    return clockTime;
+}
+
+BZF_API void bz_getUTCtime (bz_Time* ts)
+{
+    time_t now = time(NULL);
+    struct tm t;
+
+    gmtime_r(&now, &t);
+    fillTime(ts, t);
+}
+
+BZF_API void bz_getLocaltime (bz_Time* ts)
+{
+    time_t now = time(NULL);
+    struct tm t;
+
+    localtime_r(&now, &t);
+    fillTime(ts, t);
+}
+
+BZF_API double bz_getBZDBDouble (const char* variable)
+{
+    for (size_t i = 0; i < sizeof(BZDB_VARIABLES) / sizeof(BZDB_VARIABLES[0]); i++)
+    {
+        if (strcmp(BZDB_VARIABLES[i].name, variable) == 0)
+        {
+            return BZDB_VARIABLES[i].value;
+        }
+    }
+
+    return 0;
+}
+
+BZF_API int bz_getBZDBInt (const char* variable)
+{
+    return (int)bz_getBZDBDouble(variable);
+}
+
+BZF_API bz_ApiString bz_getBZDBString (const char* /*variable*/)
+{
+    return bz_ApiString();
+}
+
+BZF_API bool bz_startRecBuf ()
+{
+    return true;
+}
+
+BZF_API bool bz_stopRecBuf ()
+{
+    return true;
+}
+
+BZF_API bool bz_saveRecBuf (const char* /*filename*/, int /*seconds*/)
+{
+    return true;
+}
+
+BZF_API int bz_getTeamCount (bz_eTeamType team)
+{
+    int count = 0;
+
+    for (int i = 0; i < MAX_SLOTS; i++)
+    {
+        count += (players[i].inUse && players[i].record.team == team) ? 1 : 0;
+    }
+
+    return count;
+}
+
+BZF_API int bz_getTeamPlayerLimit (bz_eTeamType team)
+{
+    return (team >= 0 && team <= eAdministrators) ? teamLimits[team] : 0;
+}
+
+BZF_API bool bz_isCountDownActive ()
+{
+    return countdown == eActive;
+}
+
+BZF_API bool bz_isCountDownInProgress ()
+{
+    return countdown == eCountingDown;
+}
+
+BZF_API bool bz_isCountDownPaused ()
+{
+    return countdown == eActive && countdownPaused;
+}
+
+BZF_API void bz_startCountdown (int delay, float limit, const char* /*byWho*/)
+{
+    if (countdown != eIdle)
+    {
+        return;
+    }
+
+    countdown = eCountingDown;
+    countdownStart = clockTime + delay;
+    timeLimit = limit;
+}
+
+BZF_API void bz_pauseCountdown (const char* /*pausedBy*/)
+{
+    if (countdown == eActive && !countdownPaused)
+    {
+        countdownPaused = true;
+        pausedAt = clockTime;
+    }
+}
+
+BZF_API void bz_resumeCountdown (const char* /*resumedBy*/)
+{
+    if (countdown == eActive && countdownPaused)
+    {
+        countdownPaused = false;
+        matchEnd += clockTime - pausedAt;
+        gameResumePending = true;
+    }
+}
+
+BZF_API void bz_cancelCountdown (int /*playerID*/)
+{
+    if (countdown == eCountingDown)
+    {
+        countdown = eIdle;
+    }
+}
+
+BZF_API void bz_gameOver (int /*playerID*/, bz_eTeamType /*team*/)
+{
+    if (countdown == eActive)
+    {
+        endGame();
+    }
+}
+
+BZF_API double bz_getTimeLimit ()
+{
+    return timeLimit;
+}
+
+BZF_API bool bz_setTimeLimit (float limit)
+{
+    timeLimit = limit;
+    return true;
+}
+
+BZF_API bz_ApiString bz_getPublicAddr ()
+{
+    return bz_ApiString("localhost");
+}
+
+BZF_API int bz_getPublicPort ()
+{
+    return 5154;
+}
+
+BZF_API void bz_shutdown ()
+{
+}
+
+PluginConfig::PluginConfig (const std::string &filename) :
+    errors(0)
+{
+    std::ifstream file(filename.c_str());
+
+    if (!file)
+    {
+        errors++;
+        return;
+    }
+
+    std::string section, line;
+
+    while (std::getline(file, line))
+    {
+        line = trimmed(line);
+
+        if (line.empty() || line[0] == '#' || line[0] == ';')
+        {
+            continue;
+        }
+
+        if (line[0] == '[')
+        {
+            size_t end = line.find(']');
+
+            if (end == std::string::npos)
+            {
+                errors++;
+                continue;
+            }
+
+            section = lowercase(trimmed(line.substr(1, end - 1)));
+            continue;
+        }
+
+        size_t equals = line.find('=');
+
+        if (equals == std::string::npos)
+        {
+            errors++;
+            continue;
+        }
+
+        items[section + "/" + lowercase(trimmed(line.substr(0, equals)))] = trimmed(line.substr(equals + 1));
+    }
+}
+
+std::string PluginConfig::item (const std::string &section, const std::string &key)
+{
+    std::map<std::string, std::string>::const_iterator it = items.find(lowercase(section) + "/" + lowercase(key));
+
+    return (it != items.end()) ? it->second : "";
+}
+
+std::vector<std::string> tokenize (const std::string &in, const std::string &delims, const int maxTokens, const bool useQuotes)
+{
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+
+    while (pos < in.size())
+    {
+        pos = in.find_first_not_of(delims, pos);
+
+        if (pos == std::string::npos)
+        {
+            break;
+        }
+
+        // The last token we're allowed to split off gets whatever is left
+        if (maxTokens > 0 && (int)tokens.size() == maxTokens - 1)
+        {
+            tokens.push_back(in.substr(pos));
+            break;
+        }
+
+        if (useQuotes && in[pos] == '"')
+        {
+            size_t end = in.find('"', pos + 1);
+
+            tokens.push_back(in.substr(pos + 1, (end == std::string::npos) ? std::string::npos : end - pos - 1));
+            pos = (end == std::string::npos) ? in.size() : end + 1;
+            continue;
+        }
+
+        size_t end = in.find_first_of(delims, pos);
+
+        tokens.push_back(in.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos));
+        pos = (end == std::string::npos) ? in.size() : end;
+    }
+
+    return tokens;
+}
@@ -0,0 +1,114 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The side of the bzfs stand-in the test programs talk to. It keeps just enough of a game going for the plugin
+// to work with: player slots, two team colors, the match countdown, a clock that only moves when it's told to,
+// and the URL jobs the plugin queues. Each call below plays the events bzfs would fire for it, in the same order.
+
+#ifndef _MOCK_BZFS_H_
+#define _MOCK_BZFS_H_
+
+#include <functional>
+#include <string>
+
+#include "bzfsAPI.h"
+
+namespace mockBzfs
+{
+    // A request the plugin queued with bz_addURLJob()
+    struct URLJob
+    {
+        std::string url;
+        std::string postData;
+    };
+
+    // What became of a URL job; the handler is called with it the same way bzfs would call it
+    struct URLResult
+    {
+        enum Status
+        {
+            eDone,
+            eError,
+            eTimeout
+        };
+
+        URLResult () :
+            status(eDone),
+            errorCode(0)
+        {}
+
+        Status      status;
+        std::string body;
+        int         errorCode;
+        std::string error;
+    };
+
+    typedef std::function<URLResult (const URLJob &job)> URLJobRunner;
+
+    // Load the plugin with a configuration file on a map that uses two team colors, and unload it again
+    bool loadPlugin (const std::string &config, bz_eTeamType teamOne = eRedTeam, bz_eTeamType teamTwo = eBlueTeam, int teamLimit = 8);
+    void unloadPlugin ();
+
+    // The messages bzfs writes to its log at or below this level are printed to stdout
+    void setDebugLevel (int level);
+
+    // The clock the plugin reads through bz_getCurrentTime()
+    double now ();
+    void   advanceTime (double seconds);
+
+    // One pass of the bzfs main loop: the countdown moves along, finished URL jobs are handed back to the plugin
+    // and the tick event is fired if the plugin has registered for it
+    void tick ();
+
+    // Answers the URL jobs the plugin queues. Jobs are run one at a time on a thread of their own, the way bzfs
+    // leaves them to libcurl, and their handlers are called from tick(). Without a runner every job is answered
+    // with an empty response on the next tick
+    void   setURLJobRunner (URLJobRunner runner);
+    size_t pendingURLJobs ();
+    size_t finishedURLJobs ();
+
+    // Players come and go; a referee has every permission, anyone else who is verified may spawn
+    int  joinPlayer (const char* callsign, const char* bzID, bz_eTeamType team, bool referee = false);
+    void partPlayer (int playerID);
+    void changeTeam (int playerID, bz_eTeamType team);
+
+    // Ask the plugin which team a joining player should be put on; eNoTeam if it left it to bzfs
+    bz_eTeamType pickTeam (int playerID);
+
+    // Ask the plugin for the motto of a player with this BZID the way bzfs does when they join, without anyone joining
+    std::string playerMotto (const char* bzID);
+
+    // What players do during a match
+    void spawnPlayer (int playerID);
+    void killPlayer (int playerID, int killerID);
+    void grabFlag (int playerID, const char* flagType);
+    void dropFlag (int playerID, const char* flagType);
+    void captureFlag (int playerID, bz_eTeamType teamCapped);
+
+    // Run a slash command as a player, e.g. "/fm 10"; false if no plugin registered the command
+    bool runCommand (int playerID, const char* commandLine);
+
+    // The state of the match countdown
+    bool isMatchInProgress ();
+
+    // The number of chat messages bzfs has been asked to send
+    size_t messagesSent ();
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// A stand-in for the plugin_utils helpers League Overseer uses, implemented by mockBzfs.cpp
+
+#ifndef _MOCK_PLUGIN_UTILS_H_
+#define _MOCK_PLUGIN_UTILS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Reads an INI style configuration file; section and item names are case insensitive like they are in bzfs
+class PluginConfig
+{
+public:
+    PluginConfig (const std::string &filename);
+
+    std::string item (const std::string &section, const std::string &key);
+
+    int errors;
+
+private:
+    std::map<std::string, std::string> items;
+};
+
+std::vector<std::string> tokenize (const std::string &in, const std::string &delims, const int maxTokens, const bool useQuotes);
+
+#endif
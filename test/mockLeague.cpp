@@ -0,0 +1,465 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#include "mockLeague.h"
+
+const char* MockLeague::QUERY_NAMES[QUERY_COUNT] = { "reportMatch", "teamDump", "teamNameQuery", "unknown" };
+
+// The longest we block on a socket or in a sleep before checking if we're being stopped
+static const int POLL_INTERVAL_MS = 100;
+
+static std::string urlDecode (const std::string &str)
+{
+    std::string decoded;
+
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        if (str[i] == '+')
+        {
+            decoded += ' ';
+        }
+        else if (str[i] == '%' && i + 2 < str.size())
+        {
+            decoded += (char)strtol(str.substr(i + 1, 2).c_str(), NULL, 16);
+            i += 2;
+        }
+        else
+        {
+            decoded += str[i];
+        }
+    }
+
+    return decoded;
+}
+
+// Get the value of a variable in the body of a POST request
+static std::string formValue (const std::string &form, const std::string &name)
+{
+    size_t pos = 0;
+
+    while (pos <= form.size())
+    {
+        size_t end = form.find('&', pos);
+        std::string pair = form.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos);
+        size_t equals = pair.find('=');
+
+        if (urlDecode(pair.substr(0, equals)) == name)
+        {
+            return (equals == std::string::npos) ? "" : urlDecode(pair.substr(equals + 1));
+        }
+
+        if (end == std::string::npos)
+        {
+            break;
+        }
+
+        pos = end + 1;
+    }
+
+    return "";
+}
+
+// Get the value of a header, ignoring the case of its name
+static std::string headerValue (const std::string &headers, const char* name)
+{
+    std::string lowered = headers;
+    std::string key = std::string("\r\n") + name + ":";
+
+    for (size_t i = 0; i < lowered.size(); i++)
+    {
+        lowered[i] = tolower(lowered[i]);
+    }
+
+    size_t pos = lowered.find(key);
+
+    if (pos == std::string::npos)
+    {
+        return "";
+    }
+
+    pos += key.size();
+    size_t end = headers.find("\r\n", pos);
+
+    std::string value = headers.substr(pos, end - pos);
+    size_t start = value.find_first_not_of(" \t");
+
+    return (start == std::string::npos) ? "" : value.substr(start);
+}
+
+static bool sendAll (int fd, const std::string &data)
+{
+    size_t sent = 0;
+
+    while (sent < data.size())
+    {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (n <= 0)
+        {
+            return false;
+        }
+
+        sent += n;
+    }
+
+    return true;
+}
+
+MockLeague::MockLeague () :
+    listener(-1),
+    boundPort(0),
+    stopping(false),
+    activeConnections(0),
+    bytes(0)
+{
+    for (int i = 0; i < QUERY_COUNT; i++)
+    {
+        requests[i] = errors[i] = stalls[i] = 0;
+    }
+}
+
+MockLeague::~MockLeague ()
+{
+    stop();
+}
+
+bool MockLeague::start (const Settings &_settings)
+{
+    if (listener >= 0)
+    {
+        return false;
+    }
+
+    settings = _settings;
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (listener < 0)
+    {
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(settings.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t length = sizeof(address);
+
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0 ||
+        getsockname(listener, (sockaddr*)&address, &length) != 0)
+    {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+
+    boundPort = ntohs(address.sin_port);
+    stopping  = false;
+    random.seed(settings.seed);
+    acceptThread = std::thread(&MockLeague::acceptConnections, this);
+
+    return true;
+}
+
+void MockLeague::stop ()
+{
+    if (listener < 0)
+    {
+        return;
+    }
+
+    stopping = true;
+    acceptThread.join();
+
+    // Connections notice we're stopping within a poll interval, even the ones holding on to a stalled request
+    while (activeConnections > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    close(listener);
+    listener = -1;
+}
+
+std::string MockLeague::url () const
+{
+    std::ostringstream url;
+    url << "http://127.0.0.1:" << boundPort << "/leagueOverSeer.php";
+
+    return url.str();
+}
+
+void MockLeague::acceptConnections ()
+{
+    while (!stopping)
+    {
+        pollfd pfd = { listener, POLLIN, 0 };
+
+        if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0)
+        {
+            continue;
+        }
+
+        int fd = accept(listener, NULL, NULL);
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        // Each connection gets its own thread so a slow answer on one doesn't hold up the others
+        activeConnections++;
+        std::thread(&MockLeague::serveConnection, this, fd).detach();
+    }
+}
+
+void MockLeague::serveConnection (int fd)
+{
+    std::string buffer;
+    char chunk[4096];
+
+    while (!stopping)
+    {
+        size_t headerEnd = buffer.find("\r\n\r\n");
+
+        // Answer every complete request we have before reading more; clients may keep the connection open
+        if (headerEnd != std::string::npos)
+        {
+            std::string headers = buffer.substr(0, headerEnd + 2);
+            size_t contentLength = strtoul(headerValue(headers, "content-length").c_str(), NULL, 10);
+
+            if (buffer.size() >= headerEnd + 4 + contentLength)
+            {
+                std::string body = buffer.substr(headerEnd + 4, contentLength);
+                buffer.erase(0, headerEnd + 4 + contentLength);
+
+                if (!answer(fd, headers, body))
+                {
+                    break;
+                }
+
+                continue;
+            }
+        }
+
+        pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, POLL_INTERVAL_MS);
+
+        if (ready < 0 && errno != EINTR)
+        {
+            break;
+        }
+
+        if (ready <= 0)
+        {
+            continue;
+        }
+
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+
+        if (n <= 0)
+        {
+            break;
+        }
+
+        buffer.append(chunk, n);
+    }
+
+    close(fd);
+    activeConnections--;
+}
+
+// Answer a single request; returns false if the connection should be closed afterwards
+bool MockLeague::answer (int fd, const std::string &headers, const std::string &body)
+{
+    std::string queryName = formValue(body, "query");
+    Query query = eUnknownQuery;
+
+    for (int i = 0; i < eUnknownQuery; i++)
+    {
+        if (queryName == QUERY_NAMES[i])
+        {
+            query = (Query)i;
+        }
+    }
+
+    requests[query]++;
+
+    double roll = randomShare();
+    double delay = settings.latency + settings.jitter * randomShare();
+
+    // Take our time, but not so long that we'd hold up stopping
+    std::chrono::steady_clock::time_point answerAt = std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(delay * 1e6));
+    std::chrono::steady_clock::duration interval = std::chrono::milliseconds(POLL_INTERVAL_MS);
+
+    for (std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now(); !stopping && now < answerAt; now = std::chrono::steady_clock::now())
+    {
+        std::this_thread::sleep_for(std::min(interval, answerAt - now));
+    }
+
+    if (roll < settings.stallRate)
+    {
+        stalls[query]++;
+
+        // Never answer; wait for the client to give up on us and hang up
+        char chunk[512];
+
+        while (!stopping)
+        {
+            pollfd pfd = { fd, POLLIN, 0 };
+
+            if (poll(&pfd, 1, POLL_INTERVAL_MS) > 0 && recv(fd, chunk, sizeof(chunk), 0) <= 0)
+            {
+                break;
+            }
+        }
+
+        return false;
+    }
+
+    std::string status = "200 OK", contentType = "application/json", response;
+
+    if (roll < settings.stallRate + settings.errorRate)
+    {
+        errors[query]++;
+
+        status      = "500 Internal Server Error";
+        contentType = "text/plain";
+        response    = "The mock league was told to fail this request.\n";
+    }
+    else if (query == eUnknownQuery)
+    {
+        status      = "400 Bad Request";
+        contentType = "text/plain";
+        response    = "Unknown query.\n";
+    }
+    else
+    {
+        contentType = (query == eReportMatch) ? "text/plain" : "application/json";
+        response    = buildResponse(query, formValue(body, "teamPlayers"));
+    }
+
+    bool keepAlive = (headerValue(headers, "connection") != "close");
+
+    std::ostringstream reply;
+    reply << "HTTP/1.1 " << status << "\r\n"
+          << "Content-Type: " << contentType << "\r\n"
+          << "Content-Length: " << response.size() << "\r\n"
+          << ((keepAlive) ? "" : "Connection: close\r\n")
+          << "\r\n"
+          << response;
+
+    std::string data = reply.str();
+    bytes += data.size();
+
+    return sendAll(fd, data) && keepAlive;
+}
+
+// Pick a number in [0, 1); connections share a single generator so a run can be repeated with the same seed
+double MockLeague::randomShare ()
+{
+    std::lock_guard<std::mutex> lock(randomLock);
+
+    return std::uniform_real_distribution<double>(0, 1)(random);
+}
+
+std::string MockLeague::buildResponse (Query query, const std::string &bzID) const
+{
+    std::ostringstream response;
+
+    switch (query)
+    {
+        case eReportMatch:
+        {
+            response << "The match has been reported to the mock league.\n";
+
+            while ((size_t)response.tellp() < settings.reportSize)
+            {
+                response << "Ratings have been updated.\n";
+            }
+        }
+        break;
+
+        case eTeamDump:
+        {
+            response << "{\"teamDump\":[";
+
+            for (int team = 0; team < settings.teams; team++)
+            {
+                response << ((team > 0) ? "," : "") << "{\"team\":\"Mock Team " << team + 1 << "\",\"members\":\"";
+
+                for (int member = 0; member < settings.teamSize; member++)
+                {
+                    response << ((member > 0) ? "," : "") << team * settings.teamSize + member + 1;
+                }
+
+                response << "\"}";
+            }
+
+            response << "]}";
+        }
+        break;
+
+        case eTeamNameQuery:
+        {
+            int id = atoi(bzID.c_str());
+
+            response << "{\"bzid\":\"" << bzID << "\",\"team\":\"";
+
+            if (id >= 1 && id <= settings.teams * settings.teamSize)
+            {
+                response << "Mock Team " << (id - 1) / settings.teamSize + 1;
+            }
+
+            response << "\"}";
+        }
+        break;
+
+        default: break;
+    }
+
+    return response.str();
+}
@@ -0,0 +1,109 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// A stand-in for a league website that answers the plug-in's reportMatch, teamDump and teamNameQuery requests the
+// way the README describes them. It listens on the loopback interface and can be made slow, unreliable or chatty
+// so the plug-in can be tried against a bad day of the league website without one.
+
+#ifndef _MOCK_LEAGUE_H_
+#define _MOCK_LEAGUE_H_
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+class MockLeague
+{
+public:
+    struct Settings
+    {
+        Settings () :
+            port(0),
+            latency(0.02),
+            jitter(0.01),
+            errorRate(0),
+            stallRate(0),
+            teams(50),
+            teamSize(6),
+            reportSize(64),
+            seed(1)
+        {}
+
+        int      port;       // The port to listen on, or 0 to let the system pick one
+        double   latency;    // The amount of seconds every request takes to be answered...
+        double   jitter;     // ...plus up to this many seconds more, picked at random for each request
+        double   errorRate;  // The share of requests answered with a 500 Internal Server Error
+        double   stallRate;  // The share of requests never answered; the connection is held until the client gives up
+        int      teams;      // The number of teams in the team dump; BZIDs 1 through teams * teamSize belong to them
+        int      teamSize;
+        size_t   reportSize; // The number of bytes of text a match report is answered with
+        unsigned seed;
+    };
+
+    enum Query
+    {
+        eReportMatch = 0,
+        eTeamDump,
+        eTeamNameQuery,
+        eUnknownQuery,
+        QUERY_COUNT
+    };
+
+    static const char* QUERY_NAMES[QUERY_COUNT];
+
+    MockLeague ();
+    ~MockLeague ();
+
+    bool start (const Settings &settings);
+    void stop ();
+
+    // The URL to point LEAGUE_OVERSEER_URL at
+    std::string url () const;
+
+    // What has been asked of us so far
+    size_t received (Query query) const { return requests[query].load(); }
+    size_t failed (Query query) const { return errors[query].load(); }
+    size_t stalled (Query query) const { return stalls[query].load(); }
+    size_t bytesSent () const { return bytes.load(); }
+
+private:
+    void acceptConnections ();
+    void serveConnection (int fd);
+    bool answer (int fd, const std::string &headers, const std::string &body);
+    double randomShare ();
+    std::string buildResponse (Query query, const std::string &bzID) const;
+
+    Settings            settings;
+    int                 listener;
+    int                 boundPort;
+    std::atomic<bool>   stopping;
+    std::thread         acceptThread;
+    std::atomic<int>    activeConnections;
+    std::mt19937        random;
+    std::mutex          randomLock;
+
+    std::atomic<size_t> requests[QUERY_COUNT],
+                        errors[QUERY_COUNT],
+                        stalls[QUERY_COUNT],
+                        bytes;
+};
+
+#endif
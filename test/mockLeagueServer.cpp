@@ -0,0 +1,98 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Runs the mock league website on its own so a bzfs server can be pointed at it with LEAGUE_OVERSEER_URL, until it
+// is interrupted
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "mockLeague.h"
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void interrupt (int)
+{
+    interrupted = 1;
+}
+
+int main (int argc, char *argv[])
+{
+    MockLeague::Settings settings;
+
+    settings.port = 8080;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        std::string name = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if      (!value)                  name = "";
+        else if (name == "--port")        settings.port       = atoi(value);
+        else if (name == "--latency")     settings.latency    = atof(value);
+        else if (name == "--jitter")      settings.jitter     = atof(value);
+        else if (name == "--error-rate")  settings.errorRate  = atof(value);
+        else if (name == "--stall-rate")  settings.stallRate  = atof(value);
+        else if (name == "--teams")       settings.teams      = atoi(value);
+        else if (name == "--team-size")   settings.teamSize   = atoi(value);
+        else if (name == "--report-size") settings.reportSize = strtoul(value, NULL, 10);
+        else if (name == "--seed")        settings.seed       = strtoul(value, NULL, 10);
+        else                              name = "";
+
+        if (name.empty())
+        {
+            printf("Usage: %s [--port 8080] [--latency s] [--jitter s] [--error-rate share] [--stall-rate share]\n", argv[0]);
+            printf("       [--teams n] [--team-size n] [--report-size bytes] [--seed n]\n");
+            return 2;
+        }
+    }
+
+    MockLeague league;
+
+    if (!league.start(settings))
+    {
+        perror("The mock league could not be started");
+        return 1;
+    }
+
+    signal(SIGINT, interrupt);
+    signal(SIGTERM, interrupt);
+
+    printf("The mock league is answering at %s\n", league.url().c_str());
+    fflush(stdout);
+
+    while (!interrupted)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    league.stop();
+
+    for (int i = 0; i < MockLeague::QUERY_COUNT; i++)
+    {
+        printf("%-14s %zu received, %zu failed, %zu stalled\n", MockLeague::QUERY_NAMES[i],
+               league.received((MockLeague::Query)i), league.failed((MockLeague::Query)i), league.stalled((MockLeague::Query)i));
+    }
+
+    return 0;
+}
@@ -0,0 +1,423 @@
+/*
+League Overseer
+    Copyright (C) 2013-2016 Vladimir Jimenez & Ned Anderson
+    Copyright (C) 2017 Vladimir Jimenez
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Compares the plug-in's table of team names with the std::map<std::string, std::string> of BZIDs to team names it
+// used to keep. A team dump of simulated league members is handed to the plug-in the way the league website would
+// send it, and the same members are put in a map. It prints how much memory each takes and how long it takes to
+// get the motto of a player joining, for members and for players the league doesn't know.
+//
+// The plug-in is asked through the same event bzfs fires when a player joins, so its lookups include handing the
+// event over; the map's lookups are given the same player record and event to fill so they pay for as much.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "mockBzfs.h"
+
+// The bytes currently allocated with new, by any thread since the plug-in builds its table on its worker thread
+static std::atomic<long long> liveBytes(0);
+
+void* operator new (size_t size)
+{
+    void *p = malloc(size ? size : 1);
+
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+
+    liveBytes += malloc_usable_size(p);
+
+    return p;
+}
+
+void* operator new[] (size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete (void *p) noexcept
+{
+    if (p)
+    {
+        liveBytes -= malloc_usable_size(p);
+        free(p);
+    }
+}
+
+void operator delete[] (void *p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete (void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[] (void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+struct BenchmarkOptions
+{
+    BenchmarkOptions () :
+        members(100000),
+        teams(2000),
+        lookups(1000000),
+        missRate(0.1),
+        seed(1),
+        verbose(-1)
+    {}
+
+    int      members;   // The number of league members in the team dump
+    int      teams;     // The number of teams they're spread over
+    int      lookups;   // The number of mottos to look up
+    double   missRate;  // The share of lookups for players who aren't in the team dump
+    unsigned seed;      // Seed for everything picked at random
+    int      verbose;   // The bzfs debug level to print messages at
+};
+
+static void usage (const char* program)
+{
+    printf("Usage: %s [option value]...\n\n", program);
+    printf("  --members <n>             league members in the team dump (100000)\n");
+    printf("  --teams <n>               teams they belong to (2000)\n");
+    printf("  --lookups <n>             mottos to look up (1000000)\n");
+    printf("  --miss-rate <share>       share of lookups for players the league doesn't know (0.1)\n");
+    printf("  --seed <n>                seed for everything picked at random (1)\n");
+    printf("  --verbose <level>         print bzfs messages up to this debug level\n");
+}
+
+static bool parseOptions (int argc, char *argv[], BenchmarkOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string name = argv[i];
+
+        if (i + 1 >= argc || name.compare(0, 2, "--") != 0)
+        {
+            return false;
+        }
+
+        const char* value = argv[++i];
+
+        if      (name == "--members")   options.members  = atoi(value);
+        else if (name == "--teams")     options.teams    = atoi(value);
+        else if (name == "--lookups")   options.lookups  = atoi(value);
+        else if (name == "--miss-rate") options.missRate = atof(value);
+        else if (name == "--seed")      options.seed     = strtoul(value, NULL, 10);
+        else if (name == "--verbose")   options.verbose  = atoi(value);
+        else return false;
+    }
+
+    return options.members > 0 && options.teams > 0 && options.teams <= options.members && options.lookups > 0 &&
+           options.missRate >= 0 && options.missRate <= 1;
+}
+
+static double randomUnit (unsigned &state)
+{
+    return rand_r(&state) / ((double)RAND_MAX + 1);
+}
+
+// A team name of 6 to 30 characters, the way league teams tend to be named
+static std::string randomTeamName (int index, unsigned &state)
+{
+    static const char* WORDS[] = { "Alpha", "Blue", "Crimson", "Dark", "Elite", "Flag", "Ghost", "Hunters", "Iron", "Lasers",
+                                   "Masters", "Night", "Owls", "Phantom", "Rogue", "Shock", "Tank", "United", "Wolves", "Zone" };
+    static const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    std::string name = WORDS[rand_r(&state) % WORD_COUNT];
+    int words = rand_r(&state) % 3;
+
+    for (int i = 0; i < words; i++)
+    {
+        name += std::string(" ") + WORDS[rand_r(&state) % WORD_COUNT];
+    }
+
+    return name + " " + std::to_string(index);
+}
+
+static void writeString (std::string &json, const std::string &value)
+{
+    json += '"';
+    json += value;
+    json += '"';
+}
+
+// Let the plug-in run until it answers with a motto for a BZID, i.e. until its worker has built the table from the
+// team dump and the main thread swapped it in
+static bool waitForMotto (const std::string &bzID)
+{
+    for (int i = 0; i < 6000; i++)
+    {
+        mockBzfs::advanceTime(0.01);
+        mockBzfs::tick();
+
+        if (!mockBzfs::playerMotto(bzID.c_str()).empty())
+        {
+            return true;
+        }
+
+        usleep(10000);
+    }
+
+    return false;
+}
+
+// Let the worker finish whatever it was left with, like freeing the table that was replaced
+static void settle ()
+{
+    for (int i = 0; i < 20; i++)
+    {
+        mockBzfs::advanceTime(0.01);
+        mockBzfs::tick();
+        usleep(10000);
+    }
+}
+
+// Load the plug-in with a team dump and return the bytes it holds on to once it's done with the dump
+static long long loadWithDump (const std::string &config, const std::string &dump, const std::string &member)
+{
+    mockBzfs::setURLJobRunner([dump](const mockBzfs::URLJob &job)
+    {
+        mockBzfs::URLResult result;
+        result.body = (job.postData.find("query=teamDump") != std::string::npos) ? dump : "{}";
+
+        return result;
+    });
+
+    long long before = liveBytes;
+
+    if (!mockBzfs::loadPlugin(config))
+    {
+        return -1;
+    }
+
+    if (!member.empty() && !waitForMotto(member))
+    {
+        return -1;
+    }
+
+    settle();
+
+    return liveBytes - before;
+}
+
+// The motto the plug-in used to give a player: the team name in the map, or an empty one
+static std::string mapMotto (std::map<std::string, std::string> &teamMottos, const std::string &bzID)
+{
+    bz_BasePlayerRecord record;
+    record.bzID       = bzID.c_str();
+    record.verified   = true;
+    record.globalUser = true;
+
+    bz_GetPlayerMottoData_V2 mottoData;
+    mottoData.record = &record;
+
+    std::map<std::string, std::string>::const_iterator it = teamMottos.find(mottoData.record->bzID.c_str());
+    mottoData.motto = (it != teamMottos.end()) ? it->second : "";
+
+    return mottoData.motto;
+}
+
+static void printRow (const char* name, long long bytes, int members, double nanoseconds, int lookups)
+{
+    printf("%-24s %10.2f %10.1f %12.0f\n", name, bytes / 1048576.0, (double)bytes / members, nanoseconds / lookups);
+}
+
+int main (int argc, char *argv[])
+{
+    BenchmarkOptions options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char directory[] = "/tmp/leagueOverSeer-mottoBenchmark-XXXXXX";
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    std::string config = std::string(directory) + "/leagueOverSeer.cfg";
+    FILE *file = fopen(config.c_str(), "w");
+
+    if (!file)
+    {
+        perror("fopen");
+        return 1;
+    }
+
+    fprintf(file, "[leagueOverSeer]\n");
+    fprintf(file, "  LEAGUE_OVERSEER_URL = http://localhost/leagueOverSeer.php\n");
+    fprintf(file, "  DEBUG_LEVEL = 1\n");
+    fprintf(file, "  DISABLE_MATCH_REPORT = true\n");
+    fprintf(file, "  MATCH_HISTORY_PATH = %s/matches.dat\n", directory);
+    fclose(file);
+
+    mockBzfs::setDebugLevel(options.verbose);
+
+    unsigned state = options.seed;
+
+    // Members get BZIDs with gaps between them, like accounts that were never in a league
+    std::vector<std::string> teamNames(options.teams), bzIDs(options.members);
+    std::vector<std::vector<int>> rosters(options.teams);
+    uint32_t nextBZID = 1000;
+
+    for (int i = 0; i < options.teams; i++)
+    {
+        teamNames[i] = randomTeamName(i + 1, state);
+    }
+
+    for (int i = 0; i < options.members; i++)
+    {
+        nextBZID += 1 + rand_r(&state) % 20;
+        bzIDs[i] = std::to_string(nextBZID);
+
+        // Every team gets a member before the rest are spread at random
+        rosters[(i < options.teams) ? i : rand_r(&state) % options.teams].push_back(i);
+    }
+
+    std::string dump = "{\"teamDump\":[";
+
+    for (int i = 0; i < options.teams; i++)
+    {
+        dump += (i > 0) ? ",{\"team\":" : "{\"team\":";
+        writeString(dump, teamNames[i]);
+        dump += ",\"members\":\"";
+
+        for (size_t j = 0; j < rosters[i].size(); j++)
+        {
+            dump += (j > 0) ? "," : "";
+            dump += bzIDs[rosters[i][j]];
+        }
+
+        dump += "\"}";
+    }
+
+    dump += "]}";
+
+    // The BZIDs to look up, with players the league doesn't know mixed in
+    std::vector<std::string> queries(options.lookups);
+
+    for (int i = 0; i < options.lookups; i++)
+    {
+        if (randomUnit(state) < options.missRate)
+        {
+            queries[i] = std::to_string(nextBZID + 1 + rand_r(&state) % 100000);
+        }
+        else
+        {
+            queries[i] = bzIDs[rand_r(&state) % options.members];
+        }
+    }
+
+    // The map the plug-in used to keep, filled the way it used to fill it
+    long long before = liveBytes;
+    std::map<std::string, std::string> teamMottos;
+
+    for (int i = 0; i < options.teams; i++)
+    {
+        for (int member : rosters[i])
+        {
+            teamMottos[bzIDs[member]] = teamNames[i];
+        }
+    }
+
+    long long mapBytes = liveBytes - before;
+    size_t mapFound = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (auto &bzID : queries)
+    {
+        mapFound += !mapMotto(teamMottos, bzID).empty();
+    }
+
+    double mapTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // The plug-in without a team dump, to tell what its table costs from what the rest of it does
+    long long emptyBytes = loadWithDump(config, "{\"teamDump\":[]}", "");
+    mockBzfs::unloadPlugin();
+
+    long long tableBytes = loadWithDump(config, dump, bzIDs[0]);
+
+    if (emptyBytes < 0 || tableBytes < 0)
+    {
+        fprintf(stderr, "The plug-in could not be loaded with the team dump.\n");
+        return 1;
+    }
+
+    tableBytes -= emptyBytes;
+
+    size_t tableFound = 0, mismatches = 0;
+    start = std::chrono::steady_clock::now();
+
+    for (auto &bzID : queries)
+    {
+        tableFound += !mockBzfs::playerMotto(bzID.c_str()).empty();
+    }
+
+    double tableTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Both have to give every player the same motto for the numbers to mean anything
+    for (int i = 0; i < options.lookups; i += std::max(1, options.lookups / 10000))
+    {
+        mismatches += (mockBzfs::playerMotto(queries[i].c_str()) != mapMotto(teamMottos, queries[i]));
+    }
+
+    mockBzfs::unloadPlugin();
+
+    printf("%d members of %d teams, %d lookups of which %zu were members\n\n", options.members, options.teams,
+           options.lookups, mapFound);
+    printf("%-24s %10s %10s %12s\n", "Team names", "MiB", "B/member", "ns/lookup");
+    printRow("std::map", mapBytes, options.members, mapTime, options.lookups);
+    printRow("plug-in table", tableBytes, options.members, tableTime, options.lookups);
+
+    std::string cleanup = std::string("rm -rf ") + directory;
+
+    if (system(cleanup.c_str()) != 0)
+    {
+        fprintf(stderr, "%s could not be removed.\n", directory);
+    }
+
+    if (mismatches > 0 || tableFound != mapFound)
+    {
+        fprintf(stderr, "The plug-in and the map disagreed on %zu mottos.\n", mismatches);
+        return 1;
+    }
+
+    return 0;
+}